@@ -0,0 +1,73 @@
+#include "pch.h"
+#include "CpuAccountingComparer.h"
+#include "ProcessInfo.h"
+#include "ThreadInfo.h"
+#include <unordered_set>
+
+using namespace WinSys;
+
+namespace {
+	template<typename T>
+	std::unordered_set<const T*> MakeSet(const std::vector<std::shared_ptr<T>>& entities) {
+		std::unordered_set<const T*> set;
+		set.reserve(entities.size());
+		for (auto& p : entities)
+			set.insert(p.get());
+		return set;
+	}
+}
+
+CpuAccountingComparer::CpuAccountingComparer(uint32_t processorCount) : _byTime(processorCount), _byCycles(processorCount) {
+	_byCycles.SetCpuAccounting(CpuAccounting::Cycles);
+}
+
+void CpuAccountingComparer::Add(const void* buffer, size_t size, int64_t timestamp, bool extended, ProcessSnapshotParser::ThreadCycleQuery threadCycles) {
+	_byTime.Parse(buffer, size, timestamp, extended, true);
+	_byCycles.SetCpuAccounting(CpuAccounting::Cycles, std::move(threadCycles));
+	_byCycles.Parse(buffer, size, timestamp, extended, true);
+	if (_comparison.Samples++ == 0)
+		return;
+
+	auto& c = _comparison;
+	auto newProcesses = MakeSet(_byCycles.GetNewProcesses());
+	for (auto& pi : _byCycles.GetProcesses()) {
+		auto byTime = _byTime.GetProcessByKey(pi->Key);
+		if (byTime == nullptr || newProcesses.find(pi.get()) != newProcesses.end())
+			continue;
+
+		auto diff = (pi->CPU > byTime->CPU ? pi->CPU - byTime->CPU : byTime->CPU - pi->CPU) / 10000.0;
+		c.Processes++;
+		c.TotalProcessDifference += diff;
+		if (diff > c.MaxProcessDifference)
+			c.MaxProcessDifference = diff;
+		if (byTime->CPU == 0 && pi->CPU > 0)
+			c.ProcessesIdleByTime++;
+	}
+
+	auto newThreads = MakeSet(_byCycles.GetNewThreads());
+	for (auto& thread : _byCycles.GetThreads()) {
+		auto byTime = _byTime.GetThreadByKey(thread->Key);
+		if (byTime == nullptr || newThreads.find(thread.get()) != newThreads.end())
+			continue;
+
+		auto diff = (thread->CPU > byTime->CPU ? thread->CPU - byTime->CPU : byTime->CPU - thread->CPU) / 10000.0;
+		c.Threads++;
+		c.TotalThreadDifference += diff;
+		if (diff > c.MaxThreadDifference)
+			c.MaxThreadDifference = diff;
+		if (byTime->CPU == 0 && thread->CPU > 0)
+			c.ThreadsIdleByTime++;
+	}
+}
+
+const CpuAccountingComparison& CpuAccountingComparer::GetComparison() const {
+	return _comparison;
+}
+
+const ProcessSnapshotParser& CpuAccountingComparer::GetTimeParser() const {
+	return _byTime;
+}
+
+const ProcessSnapshotParser& CpuAccountingComparer::GetCycleParser() const {
+	return _byCycles;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "ProcessSnapshotParser.h"
+
+namespace WinSys {
+	struct CpuAccountingComparison {
+		uint32_t Samples;
+		// entity samples compared; an entity's first sample has no CPU in either mode and is skipped
+		uint64_t Processes, Threads;
+		// absolute difference between the modes, in percent (of all processors for processes, of one for threads)
+		double TotalProcessDifference, MaxProcessDifference;
+		double TotalThreadDifference, MaxThreadDifference;
+		// entity samples with no CPU by time but some by cycles (runs between clock ticks)
+		uint64_t ProcessesIdleByTime, ThreadsIdleByTime;
+
+		double GetMeanProcessDifference() const {
+			return Processes ? TotalProcessDifference / Processes : 0;
+		}
+		double GetMeanThreadDifference() const {
+			return Threads ? TotalThreadDifference / Threads : 0;
+		}
+	};
+
+	//
+	// parses the same recorded samples (a process snapshot buffer and the thread cycle times read right after it)
+	// with time and cycle based CPU accounting side by side, accumulating how far the two modes disagree.
+	// like the parser, makes no system calls
+	//
+
+	class CpuAccountingComparer final {
+	public:
+		explicit CpuAccountingComparer(uint32_t processorCount = 1);
+
+		// samples in capture order; threadCycles replays the cycle times (and their read times) recorded with the sample
+		void Add(const void* buffer, size_t size, int64_t timestamp, bool extended, ProcessSnapshotParser::ThreadCycleQuery threadCycles);
+
+		[[nodiscard]] const CpuAccountingComparison& GetComparison() const;
+		[[nodiscard]] const ProcessSnapshotParser& GetTimeParser() const;
+		[[nodiscard]] const ProcessSnapshotParser& GetCycleParser() const;
+
+	private:
+		ProcessSnapshotParser _byTime, _byCycles;
+		CpuAccountingComparison _comparison{};
+	};
+}
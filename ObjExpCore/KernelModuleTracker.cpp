@@ -1,54 +1,116 @@
 #include "pch.h"
 #include "KernelModuleTracker.h"
+#include "Profiler.h"
 
 using namespace WinSys;
 
+static std::shared_ptr<KernelModuleInfo> CreateModule(const RTL_PROCESS_MODULE_INFORMATION_EX& info) {
+    static const std::string root("\\SystemRoot\\");
+    // the Windows directory does not change while running
+    static const std::string winDir = []() {
+        CHAR dir[MAX_PATH];
+        auto len = ::GetWindowsDirectoryA(dir, _countof(dir));
+        return std::string(dir, len < _countof(dir) ? len : 0);
+    }();
+
+    auto m = std::make_shared<KernelModuleInfo>();
+    m->Flags = info.BaseInfo.Flags;
+    m->FullPath = (const char*)info.BaseInfo.FullPathName;
+    if (m->FullPath.find(root) == 0)
+        m->FullPath = winDir + m->FullPath.substr(root.size() - 1);
+    m->MappedBase = info.BaseInfo.MappedBase;
+    m->ImageBase = info.BaseInfo.ImageBase;
+    m->ImageSize = info.BaseInfo.ImageSize;
+    m->InitOrderIndex = info.BaseInfo.InitOrderIndex;
+    m->LoadOrderIndex = info.BaseInfo.LoadOrderIndex;
+    m->LoadCount = info.BaseInfo.LoadCount;
+    m->hSection = info.BaseInfo.Section;
+    m->DefaultBase = info.DefaultBase;
+    m->ImageChecksum = info.ImageChecksum;
+    m->TimeDateStamp = info.TimeDateStamp;
+    m->Name = std::string((PCSTR)(info.BaseInfo.FullPathName + info.BaseInfo.OffsetToFileName));
+    return m;
+}
+
 uint32_t KernelModuleTracker::EnumModules() {
-    DWORD size = 1 << 18;
-    wil::unique_virtualalloc_ptr<> buffer(::VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE));
+    PROFILE_SCOPE("Enumeration", "EnumKernelModules");
+    if (_bufferSize == 0)
+        _bufferSize = 1 << 18;
 
-    if (!NT_SUCCESS(::NtQuerySystemInformation(SystemModuleInformationEx, buffer.get(), size, nullptr)))
-        return 0;
+    for (;;) {
+        if (!_buffer)
+            _buffer.reset(::VirtualAlloc(nullptr, _bufferSize, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE));
+        if (!_buffer)
+            return 0;
 
-    if (_modules.empty()) {
-        _modules.reserve(256);
+        ULONG len = 0;
+        auto status = ::NtQuerySystemInformation(SystemModuleInformationEx, _buffer.get(), _bufferSize, &len);
+        if (NT_SUCCESS(status))
+            break;
+        if (status != STATUS_INFO_LENGTH_MISMATCH)
+            return 0;
+
+        _buffer.reset();
+        _bufferSize = len > _bufferSize ? len + len / 8 : _bufferSize << 1;
     }
 
-    auto p = (RTL_PROCESS_MODULE_INFORMATION_EX*)buffer.get();
-    CHAR winDir[MAX_PATH];
-    ::GetWindowsDirectoryA(winDir, _countof(winDir));
-    static const std::string root("\\SystemRoot\\");
+    bool first = _modules.empty();
+    if (first) {
+        _modules.reserve(256);
+        _moduleMap.reserve(256);
+    }
+    _modules.clear();
+    _newModules.clear();
+    _unloadedModules.clear();
+    auto generation = ++_generation;
 
-    for(;;) {
+    auto p = (RTL_PROCESS_MODULE_INFORMATION_EX*)_buffer.get();
+    for (;;) {
         if (p->BaseInfo.ImageBase == 0)
             break;
-        auto m = std::make_shared<KernelModuleInfo>();
-        m->Flags = p->BaseInfo.Flags;
-        m->FullPath = (const char*)p->BaseInfo.FullPathName;
-        if (m->FullPath.find(root) == 0)
-            m->FullPath = winDir + m->FullPath.substr(root.size() - 1);
-        m->MappedBase = p->BaseInfo.MappedBase;
-        m->ImageBase = p->BaseInfo.ImageBase;
-        m->ImageSize = p->BaseInfo.ImageSize;
-        m->InitOrderIndex = p->BaseInfo.InitOrderIndex;
-        m->LoadOrderIndex = p->BaseInfo.LoadOrderIndex;
-        m->LoadCount = p->BaseInfo.LoadCount;
-        m->hSection = p->BaseInfo.Section;
-        m->DefaultBase = p->DefaultBase;
-        m->ImageChecksum = p->ImageChecksum;
-        m->TimeDateStamp = p->TimeDateStamp;
-        m->Name = std::string((PCSTR)(p->BaseInfo.FullPathName + p->BaseInfo.OffsetToFileName));
-
-        _modules.push_back(std::move(m));
+
+        KernelModuleKey key{ (size_t)p->BaseInfo.ImageBase, p->TimeDateStamp };
+        auto& tracked = _moduleMap[key];
+        tracked.Generation = generation;
+        if (tracked.Module == nullptr) {
+            // paths are only built for modules not seen before
+            tracked.Module = CreateModule(*p);
+            if (!first)
+                _newModules.push_back(tracked.Module);
+        }
+        else {
+            // may change as other modules load and unload
+            tracked.Module->LoadOrderIndex = p->BaseInfo.LoadOrderIndex;
+            tracked.Module->LoadCount = p->BaseInfo.LoadCount;
+        }
+        _modules.push_back(tracked.Module);
 
         if (p->NextOffset == 0)
             break;
         p = (RTL_PROCESS_MODULE_INFORMATION_EX*)((BYTE*)p + p->NextOffset);
     }
 
+    for (auto it = _moduleMap.begin(); it != _moduleMap.end(); ) {
+        if (it->second.Generation != generation) {
+            _unloadedModules.push_back(std::move(it->second.Module));
+            it = _moduleMap.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+
     return uint32_t(_modules.size());
 }
 
 const std::vector<std::shared_ptr<KernelModuleInfo>>& KernelModuleTracker::GetModules() const {
     return _modules;
-}
\ No newline at end of file
+}
+
+const std::vector<std::shared_ptr<KernelModuleInfo>>& KernelModuleTracker::GetNewModules() const {
+    return _newModules;
+}
+
+const std::vector<std::shared_ptr<KernelModuleInfo>>& KernelModuleTracker::GetUnloadedModules() const {
+    return _unloadedModules;
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include "Keys.h"
 
 namespace WinSys {
 	struct KernelModuleInfo {
@@ -28,7 +29,16 @@ namespace WinSys {
 		const std::vector<std::shared_ptr<KernelModuleInfo>>& GetUnloadedModules() const;
 
 	private:
+		struct TrackedModule {
+			std::shared_ptr<KernelModuleInfo> Module;
+			uint32_t Generation;
+		};
+
 		std::vector<std::shared_ptr<KernelModuleInfo>> _modules, _newModules, _unloadedModules;
-		const std::unordered_map<void*, std::shared_ptr<KernelModuleInfo>> _moduleMap;
+		std::unordered_map<KernelModuleKey, TrackedModule> _moduleMap;
+		uint32_t _generation{ 0 };
+		// kept between calls; its size is the hint for the next query
+		wil::unique_virtualalloc_ptr<> _buffer;
+		ULONG _bufferSize{ 0 };
 	};
 }
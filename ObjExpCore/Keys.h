@@ -26,6 +26,25 @@ namespace WinSys {
 		}
 	};
 
+	struct KernelModuleKey {
+		size_t ImageBase;
+		uint32_t TimeDateStamp;
+
+		bool operator==(const KernelModuleKey& other) const {
+			return other.ImageBase == ImageBase && other.TimeDateStamp == TimeDateStamp;
+		}
+	};
+
+	struct ModuleKey {
+		size_t Base;
+		// MEM_IMAGE or MEM_MAPPED
+		uint32_t Section;
+
+		bool operator==(const ModuleKey& other) const {
+			return other.Base == Base && other.Section == Section;
+		}
+	};
+
 }
 
 template<>
@@ -41,3 +60,18 @@ struct std::hash<WinSys::HandleKey> {
 		return key.Handle ^ key.ProcessId ^ key.Object;
 	}
 };
+
+template<>
+struct std::hash<WinSys::ModuleKey> {
+	size_t operator()(const WinSys::ModuleKey& key) const {
+		// allocations are 64 KB aligned
+		return (key.Base >> 16) ^ key.Section;
+	}
+};
+
+template<>
+struct std::hash<WinSys::KernelModuleKey> {
+	size_t operator()(const WinSys::KernelModuleKey& key) const {
+		return (key.ImageBase >> 12) ^ key.TimeDateStamp;
+	}
+};
@@ -0,0 +1,240 @@
+#pragma once
+
+#include <stdint.h>
+#include <float.h>
+
+namespace WinSys {
+	enum class ProcessHistoryMetric : uint32_t {
+		CPU,				// percent of all processors
+		WorkingSet,			// bytes
+		PrivateBytes,
+		Handles,
+		IoRate,				// read + write + other bytes/sec
+		COUNT
+	};
+
+	enum class ThreadHistoryMetric : uint32_t {
+		CPU,				// percent of one processor
+		ContextSwitchRate,
+		COUNT
+	};
+
+	struct MetricRange {
+		float Min, Max, Avg;
+	};
+
+	//
+	// fixed size history of a few metrics of one entity, one value per sample.
+	// level 0 keeps the last RawSize samples; each point of level n + 1 is the min/max/avg of Factor points of level n,
+	// so the history covers RawSize samples at full resolution and Level2Size * Factor * Factor samples in all.
+	// all storage is inline, so the size is fixed (under 4 KB for the process metrics)
+	//
+
+	template<typename Metric>
+	class MetricHistory {
+	public:
+		static constexpr uint32_t MetricCount = static_cast<uint32_t>(Metric::COUNT);
+		static constexpr uint32_t Levels = 3;
+		static constexpr uint32_t Factor = 8;
+		static constexpr uint32_t RawSize = 64;
+		static constexpr uint32_t Level1Size = 24;
+		static constexpr uint32_t Level2Size = 16;
+
+		MetricHistory() {
+			for (auto& level : _pending)
+				for (auto& total : level)
+					total = Empty;
+		}
+
+		// values are indexed by metric
+		void Add(const float* values) {
+			_samples++;
+			auto head = _raw.Push();
+			for (uint32_t m = 0; m < MetricCount; m++) {
+				auto value = values[m];
+				_raw.Items[m][head] = value;
+				Accumulate(_pending[0][m], MetricRange{ value, value, value });
+			}
+			if (++_pendingCount[0] < Factor)
+				return;
+
+			head = _level1.Push();
+			for (uint32_t m = 0; m < MetricCount; m++) {
+				auto point = Complete(_pending[0][m]);
+				_level1.Items[m][head] = point;
+				Accumulate(_pending[1][m], point);
+			}
+			_pendingCount[0] = 0;
+			if (++_pendingCount[1] < Factor)
+				return;
+
+			head = _level2.Push();
+			for (uint32_t m = 0; m < MetricCount; m++)
+				_level2.Items[m][head] = Complete(_pending[1][m]);
+			_pendingCount[1] = 0;
+		}
+
+		void Clear() {
+			*this = MetricHistory();
+		}
+
+		[[nodiscard]] uint32_t GetCount(uint32_t level = 0) const {
+			switch (level) {
+				case 0: return _raw.Count;
+				case 1: return _level1.Count;
+				case 2: return _level2.Count;
+			}
+			return 0;
+		}
+
+		[[nodiscard]] static constexpr uint32_t GetCapacity(uint32_t level) {
+			return level == 0 ? RawSize : (level == 1 ? Level1Size : (level == 2 ? Level2Size : 0));
+		}
+
+		// number of samples behind each point of the level
+		[[nodiscard]] static constexpr uint32_t GetSpan(uint32_t level) {
+			return level == 0 ? 1 : (level == 1 ? Factor : Factor * Factor);
+		}
+
+		// total samples added, including those no longer held
+		[[nodiscard]] uint64_t GetSamples() const {
+			return _samples;
+		}
+
+		[[nodiscard]] float GetLast(Metric metric) const {
+			return _raw.Count ? _raw.Items[static_cast<uint32_t>(metric)][_raw.Head] : 0;
+		}
+
+		// copies up to count of the newest points of the level, oldest first. level 0 points have Min == Max == Avg.
+		// returns the number of points copied
+		uint32_t Get(Metric metric, uint32_t level, MetricRange* points, uint32_t count) const {
+			auto m = static_cast<uint32_t>(metric);
+			switch (level) {
+				case 0: {
+					auto n = count < _raw.Count ? count : _raw.Count;
+					for (uint32_t i = 0; i < n; i++) {
+						auto value = _raw.Items[m][_raw.Index(n - 1 - i)];
+						points[i] = MetricRange{ value, value, value };
+					}
+					return n;
+				}
+				case 1: return _level1.Copy(m, points, count);
+				case 2: return _level2.Copy(m, points, count);
+			}
+			return 0;
+		}
+
+		//
+		// fills width points covering the last samples samples (e.g. for a sparkline), oldest first,
+		// from the finest level holding that many. source points are merged, or repeated if there are fewer than width.
+		// returns the number of points filled: width, or 0 if there is no history
+		//
+		uint32_t GetDownsampled(Metric metric, uint32_t samples, MetricRange* points, uint32_t width) const {
+			if (width == 0 || samples == 0)
+				return 0;
+
+			uint32_t level = 0;
+			while (level < Levels - 1 && GetCapacity(level) * GetSpan(level) < samples)
+				level++;
+
+			MetricRange source[RawSize];
+			auto available = GetCount(level);
+			auto wanted = (samples + GetSpan(level) - 1) / GetSpan(level);
+			auto count = Get(metric, level, source, wanted < available ? wanted : available);
+			if (count == 0)
+				return 0;
+
+			// spread the source points over the width, merging or repeating as needed
+			uint32_t filled = 0;
+			for (uint32_t i = 0; i < width; i++) {
+				auto first = (uint64_t)i * count / width;
+				auto last = (uint64_t)(i + 1) * count / width;
+				if (last == first)
+					last = first + 1;
+				auto point = Empty;
+				for (auto j = first; j < last; j++) {
+					auto& p = source[j];
+					if (p.Min < point.Min)
+						point.Min = p.Min;
+					if (p.Max > point.Max)
+						point.Max = p.Max;
+					point.Avg += p.Avg;
+				}
+				point.Avg /= last - first;
+				points[filled++] = point;
+			}
+			return filled;
+		}
+
+		// min/max/avg over all the points of a level
+		[[nodiscard]] MetricRange GetSummary(Metric metric, uint32_t level = 0) const {
+			MetricRange points[RawSize];
+			auto count = Get(metric, level, points, RawSize);
+			if (count == 0)
+				return MetricRange{ 0, 0, 0 };
+
+			auto summary = Empty;
+			for (uint32_t i = 0; i < count; i++)
+				Accumulate(summary, points[i]);
+			summary.Avg /= count;
+			return summary;
+		}
+
+	private:
+		static constexpr MetricRange Empty{ FLT_MAX, -FLT_MAX, 0 };
+
+		template<typename T, uint32_t N>
+		struct Ring {
+			T Items[MetricCount][N];
+			uint16_t Head{ N - 1 };
+			uint16_t Count{ 0 };
+
+			uint32_t Push() {
+				Head = (Head + 1) % N;
+				if (Count < N)
+					Count++;
+				return Head;
+			}
+
+			// age 0 is the newest
+			uint32_t Index(uint32_t age) const {
+				return (Head + N - age) % N;
+			}
+
+			uint32_t Copy(uint32_t m, MetricRange* points, uint32_t count) const {
+				auto n = count < Count ? count : Count;
+				for (uint32_t i = 0; i < n; i++)
+					points[i] = Items[m][Index(n - 1 - i)];
+				return n;
+			}
+		};
+
+		static void Accumulate(MetricRange& total, const MetricRange& point) {
+			if (point.Min < total.Min)
+				total.Min = point.Min;
+			if (point.Max > total.Max)
+				total.Max = point.Max;
+			total.Avg += point.Avg;
+		}
+
+		// turns an accumulated sum of Factor points to their average and resets it
+		static MetricRange Complete(MetricRange& total) {
+			auto point = MetricRange{ total.Min, total.Max, total.Avg / Factor };
+			total = Empty;
+			return point;
+		}
+
+		Ring<float, RawSize> _raw;
+		Ring<MetricRange, Level1Size> _level1;
+		Ring<MetricRange, Level2Size> _level2;
+		// points accumulated for the next point of levels 1 and 2
+		MetricRange _pending[Levels - 1][MetricCount];
+		uint32_t _pendingCount[Levels - 1]{};
+		uint64_t _samples{ 0 };
+	};
+
+	using ProcessHistory = MetricHistory<ProcessHistoryMetric>;
+	using ThreadHistory = MetricHistory<ThreadHistoryMetric>;
+
+	static_assert(sizeof(ProcessHistory) < 4096);
+}
@@ -5,6 +5,14 @@
 #include "ServiceInfo.h"
 #include "DeviceManager.h"
 #include "ProcessManager.h"
+#include "ProcessSnapshotParser.h"
+#include "ProcessSnapshot.h"
+#include "SnapshotSlot.h"
+#include "SamplingScheduler.h"
+#include "PoolAllocator.h"
+#include "Profiler.h"
+#include "TrigramIndex.h"
+#include "TextMatcher.h"
 #include "ProcessInfo.h"
 #include "Processes.h"
 #include "ThreadInfo.h"
@@ -1,2 +1,172 @@
 #include "pch.h"
 #include "PerfCounter.h"
+
+using namespace WinSys;
+
+PerfCounter::PerfCounter(uint32_t depth) : _depth(depth < 2 ? 2 : depth) {
+	_values.resize(MetricCount * _depth);
+	_timestamps.resize(_depth);
+	// the first Begin moves to row 0
+	_row = _depth - 1;
+}
+
+int64_t PerfCounter::Now() {
+	static const auto frequency = []() {
+		LARGE_INTEGER freq;
+		::QueryPerformanceFrequency(&freq);
+		return freq.QuadPart;
+	}();
+
+	LARGE_INTEGER ticks;
+	::QueryPerformanceCounter(&ticks);
+	// split to avoid overflow for long uptimes
+	return ticks.QuadPart / frequency * 10000000 + ticks.QuadPart % frequency * 10000000 / frequency;
+}
+
+PerfCounter::Slot PerfCounter::AddEntity() {
+	Slot slot;
+	if (!_free.empty()) {
+		slot = _free.back();
+		_free.pop_back();
+	}
+	else {
+		slot = static_cast<Slot>(_samples.size());
+		Grow();
+	}
+	_used[slot] = 1;
+	_samples[slot] = 0;
+	return slot;
+}
+
+void PerfCounter::RemoveEntity(Slot slot) {
+	if (slot >= _samples.size() || !_used[slot])
+		return;
+
+	_used[slot] = 0;
+	_samples[slot] = 0;
+	_present[slot] = 0;
+	for (size_t m = 0; m < MetricCount; m++) {
+		_deltas[m][slot] = 0;
+		_rates[m][slot] = 0;
+	}
+	_free.push_back(slot);
+}
+
+void PerfCounter::Begin(int64_t timestamp) {
+	_row = (_row + 1) % _depth;
+	_timestamps[_row] = timestamp;
+	std::fill(_present.begin(), _present.end(), uint8_t(0));
+	_sampling = true;
+}
+
+void PerfCounter::Set(Slot slot, PerfMetric metric, uint64_t value) {
+	if (!_sampling || slot >= _samples.size())
+		return;
+
+	Values(metric, _row)[slot] = value;
+	_present[slot] = 1;
+}
+
+void PerfCounter::Commit() {
+	if (!_sampling)
+		return;
+
+	_sampling = false;
+	auto count = _samples.size();
+	auto interval = _committed ? _timestamps[_row] - _timestamps[Row(1)] : 0;
+	auto scale = interval > 0 ? 10000000.0 / interval : 0.0;
+
+	auto samples = _samples.data();
+	auto present = _present.data();
+	auto valid = _valid.data();
+	for (size_t i = 0; i < count; i++)
+		valid[i] = present[i] & (samples[i] > 0);
+
+	//
+	// branch free loops over contiguous arrays, so the compiler can vectorize them
+	//
+	auto prevRow = Row(1);
+	for (size_t m = 0; m < MetricCount; m++) {
+		auto metric = static_cast<PerfMetric>(m);
+		auto current = Values(metric, _row).data();
+		auto previous = Values(metric, prevRow).data();
+		auto deltas = _deltas[m].data();
+		auto rates = _rates[m].data();
+		for (size_t i = 0; i < count; i++) {
+			// counters going back (e.g. an id reused by a new entity) produce no delta
+			auto delta = valid[i] && current[i] >= previous[i] ? current[i] - previous[i] : 0;
+			deltas[i] = delta;
+			rates[i] = delta * scale;
+		}
+	}
+
+	for (size_t i = 0; i < count; i++)
+		samples[i] = present[i] ? (samples[i] < _depth ? samples[i] + 1 : _depth) : 0;
+	if (_committed < _depth)
+		_committed++;
+}
+
+uint64_t PerfCounter::GetDelta(Slot slot, PerfMetric metric, uint32_t span) const {
+	if (span == 0 || span >= _depth || slot >= _samples.size() || _samples[slot] <= span)
+		return 0;
+
+	auto current = Values(metric, _row)[slot];
+	auto previous = Values(metric, Row(span))[slot];
+	return current >= previous ? current - previous : 0;
+}
+
+double PerfCounter::GetRate(Slot slot, PerfMetric metric, uint32_t span) const {
+	auto interval = GetInterval(span);
+	return interval > 0 ? GetDelta(slot, metric, span) * 10000000.0 / interval : 0;
+}
+
+uint64_t PerfCounter::GetValue(Slot slot, PerfMetric metric) const {
+	return slot < _samples.size() && _samples[slot] > 0 ? Values(metric, _row)[slot] : 0;
+}
+
+int64_t PerfCounter::GetInterval(uint32_t span) const {
+	if (span == 0 || span >= _depth || _committed <= span)
+		return 0;
+	return _timestamps[_row] - _timestamps[Row(span)];
+}
+
+int64_t PerfCounter::GetTimestamp() const {
+	return _committed ? _timestamps[_row] : 0;
+}
+
+const uint64_t* PerfCounter::GetDeltas(PerfMetric metric) const {
+	return _deltas[static_cast<size_t>(metric)].data();
+}
+
+const double* PerfCounter::GetRates(PerfMetric metric) const {
+	return _rates[static_cast<size_t>(metric)].data();
+}
+
+uint32_t PerfCounter::GetSampleCount(Slot slot) const {
+	return slot < _samples.size() ? _samples[slot] : 0;
+}
+
+size_t PerfCounter::GetSlotCount() const {
+	return _samples.size();
+}
+
+size_t PerfCounter::GetEntityCount() const {
+	return _samples.size() - _free.size();
+}
+
+uint32_t PerfCounter::GetDepth() const {
+	return _depth;
+}
+
+void PerfCounter::Grow() {
+	for (auto& values : _values)
+		values.push_back(0);
+	for (size_t m = 0; m < MetricCount; m++) {
+		_deltas[m].push_back(0);
+		_rates[m].push_back(0);
+	}
+	_samples.push_back(0);
+	_present.push_back(0);
+	_valid.push_back(0);
+	_used.push_back(0);
+}
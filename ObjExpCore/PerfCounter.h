@@ -1,9 +1,100 @@
 #pragma once
 
+#include <vector>
+
 namespace WinSys {
+	enum class PerfMetric : uint32_t {
+		CpuTime,			// 100 nsec units
+		CycleTime,
+		ReadOperations,
+		WriteOperations,
+		OtherOperations,
+		ReadBytes,
+		WriteBytes,
+		OtherBytes,
+		PageFaults,
+		ContextSwitches,
+		COUNT
+	};
+
+	//
+	// delta and rate engine for the cumulative counters of many entities (e.g. all processes).
+	// each metric keeps its last few samples in contiguous per slot arrays (structure of arrays),
+	// so deltas and rates are computed for all entities in one tight loop per metric.
+	// a sample is Begin(timestamp), Set() for every live entity, then Commit().
+	// entities not set in a sample start over (no delta) on their next one
+	//
+
 	class PerfCounter final {
 	public:
+		using Slot = uint32_t;
+		static constexpr Slot InvalidSlot = 0xffffffff;
+
+		// depth is the number of samples kept per entity (at least 2)
+		explicit PerfCounter(uint32_t depth = 4);
+
+		// monotonic time in 100 nsec units, based on the performance counter
+		[[nodiscard]] static int64_t Now();
+
+		// slots of removed entities are reused
+		Slot AddEntity();
+		void RemoveEntity(Slot slot);
 
+		// timestamp is in 100 nsec units and must be greater than the previous one
+		void Begin(int64_t timestamp);
+		void Set(Slot slot, PerfMetric metric, uint64_t value);
+		void Commit();
+
+		// the change over the last span samples; 0 if the entity has fewer samples or the counter went back
+		[[nodiscard]] uint64_t GetDelta(Slot slot, PerfMetric metric, uint32_t span = 1) const;
+		// change per second over the last span samples
+		[[nodiscard]] double GetRate(Slot slot, PerfMetric metric, uint32_t span = 1) const;
+		[[nodiscard]] uint64_t GetValue(Slot slot, PerfMetric metric) const;
+		// time between the last sample and the one span samples before it, in 100 nsec units
+		[[nodiscard]] int64_t GetInterval(uint32_t span = 1) const;
+		[[nodiscard]] int64_t GetTimestamp() const;
+
+		// last sample deltas and rates of all slots, indexed by slot (GetSlotCount entries)
+		[[nodiscard]] const uint64_t* GetDeltas(PerfMetric metric) const;
+		[[nodiscard]] const double* GetRates(PerfMetric metric) const;
+
+		[[nodiscard]] uint32_t GetSampleCount(Slot slot) const;
+		[[nodiscard]] size_t GetSlotCount() const;
+		[[nodiscard]] size_t GetEntityCount() const;
+		[[nodiscard]] uint32_t GetDepth() const;
+
+	private:
+		static constexpr size_t MetricCount = static_cast<size_t>(PerfMetric::COUNT);
+
+		std::vector<uint64_t>& Values(PerfMetric metric, uint32_t row) {
+			return _values[static_cast<size_t>(metric) * _depth + row];
+		}
+		const std::vector<uint64_t>& Values(PerfMetric metric, uint32_t row) const {
+			return _values[static_cast<size_t>(metric) * _depth + row];
+		}
+		uint32_t Row(uint32_t span) const {
+			return (_row + _depth - span) % _depth;
+		}
+		void Grow();
+
+	private:
+		uint32_t _depth;
+		// ring index of the current sample
+		uint32_t _row{ 0 };
+		bool _sampling{ false };
+		// raw values, one array per metric per ring row
+		std::vector<std::vector<uint64_t>> _values;
+		std::vector<uint64_t> _deltas[MetricCount];
+		std::vector<double> _rates[MetricCount];
+		std::vector<int64_t> _timestamps;
+		// consecutive samples per slot, up to the depth
+		std::vector<uint32_t> _samples;
+		// set by Set for the pending sample
+		std::vector<uint8_t> _present;
+		// present with a previous sample, i.e. has a delta in the pending sample
+		std::vector<uint8_t> _valid;
+		std::vector<uint8_t> _used;
+		std::vector<Slot> _free;
+		uint32_t _committed{ 0 };
 	};
 }
-
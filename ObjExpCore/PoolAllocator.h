@@ -0,0 +1,127 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <cstddef>
+
+namespace WinSys {
+	struct BlockPoolStats {
+		size_t BlockSize;
+		size_t Chunks;
+		size_t LiveBlocks;
+		size_t PeakBlocks;
+		// total blocks handed out, vs. Chunks actual heap allocations
+		uint64_t Allocations;
+	};
+
+	//
+	// fixed size blocks carved out of large chunks and recycled through a free list, one pool per tag type.
+	// the block size is set by the first allocation. chunks are never returned to the heap,
+	// so memory stays at the peak usage
+	//
+
+	template<typename Tag>
+	class BlockPool {
+	public:
+		static BlockPool& Get() {
+			// never destroyed, as pooled objects may be released by other statics' destructors at exit
+			static auto pool = new BlockPool;
+			return *pool;
+		}
+
+		void* Allocate(size_t size) {
+			auto lock = _lock.lock_exclusive();
+			if (_blockSize == 0)
+				_blockSize = (size + Align - 1) / Align * Align;
+			if (size > _blockSize)
+				return ::operator new(size);
+
+			if (_free == nullptr)
+				Grow();
+
+			auto block = _free;
+			_free = block->Next;
+			_allocations++;
+			if (++_live > _peak)
+				_peak = _live;
+			return block;
+		}
+
+		void Free(void* p, size_t size) {
+			if (size > _blockSize) {
+				::operator delete(p);
+				return;
+			}
+			auto lock = _lock.lock_exclusive();
+			auto block = static_cast<FreeBlock*>(p);
+			block->Next = _free;
+			_free = block;
+			_live--;
+		}
+
+		BlockPoolStats GetStats() const {
+			auto lock = _lock.lock_shared();
+			return BlockPoolStats{ _blockSize, _chunks.size(), _live, _peak, _allocations };
+		}
+
+	private:
+		BlockPool() = default;
+		BlockPool(const BlockPool&) = delete;
+		BlockPool& operator=(const BlockPool&) = delete;
+
+		struct FreeBlock {
+			FreeBlock* Next;
+		};
+
+		static constexpr size_t Align = alignof(std::max_align_t);
+		static constexpr size_t BlocksPerChunk = 1024;
+
+		void Grow() {
+			// lock held
+			auto chunk = std::make_unique<unsigned char[]>(_blockSize * BlocksPerChunk);
+			for (size_t i = BlocksPerChunk; i > 0; i--) {
+				auto block = reinterpret_cast<FreeBlock*>(chunk.get() + (i - 1) * _blockSize);
+				block->Next = _free;
+				_free = block;
+			}
+			_chunks.push_back(std::move(chunk));
+		}
+
+		mutable wil::srwlock _lock;
+		std::vector<std::unique_ptr<unsigned char[]>> _chunks;
+		FreeBlock* _free{ nullptr };
+		size_t _blockSize{ 0 };
+		size_t _live{ 0 }, _peak{ 0 };
+		uint64_t _allocations{ 0 };
+	};
+
+	//
+	// allocator for std::allocate_shared<T>: the object and its control block share one pooled block
+	//
+
+	template<typename T, typename Tag = T>
+	struct PoolAllocator {
+		using value_type = T;
+
+		PoolAllocator() = default;
+		template<typename U>
+		PoolAllocator(const PoolAllocator<U, Tag>&) {}
+
+		T* allocate(size_t n) {
+			return static_cast<T*>(BlockPool<Tag>::Get().Allocate(n * sizeof(T)));
+		}
+
+		void deallocate(T* p, size_t n) {
+			BlockPool<Tag>::Get().Free(p, n * sizeof(T));
+		}
+
+		template<typename U>
+		bool operator==(const PoolAllocator<U, Tag>&) const {
+			return true;
+		}
+		template<typename U>
+		bool operator!=(const PoolAllocator<U, Tag>&) const {
+			return false;
+		}
+	};
+}
@@ -1,7 +1,8 @@
 #include "pch.h"
 #include "ProcessHandlesTracker.h"
-#include <unordered_set>
+#include "Profiler.h"
 #include <assert.h>
+#include <algorithm>
 
 using namespace WinSys;
 
@@ -9,13 +10,6 @@ bool HandleEntryInfo::operator==(const HandleEntryInfo& other) const {
 	return HandleValue == other.HandleValue;
 }
 
-template<>
-struct std::hash<HandleEntryInfo> {
-	size_t operator()(const HandleEntryInfo& key) const {
-		return (size_t)key.HandleValue ^ ((int32_t)key.ObjectTypeIndex << 16);
-	}
-};
-
 struct ProcessHandlesTracker::Impl {
 	Impl(uint32_t pid);
 	Impl(HANDLE hProcess);
@@ -33,9 +27,15 @@ struct ProcessHandlesTracker::Impl {
 	}
 
 private:
+	PROCESS_HANDLE_SNAPSHOT_INFORMATION* QueryHandles();
+
 	wil::unique_handle _hProcess;
 	std::vector<HandleEntryInfo> _closedHandles, _newHandles;
-	std::unordered_set<HandleEntryInfo> _handles;
+	// sorted by handle value; _current is the next snapshot, swapped with _handles after the merge
+	std::vector<HandleEntryInfo> _handles, _current;
+	// kept between calls; its size is the hint for the next query
+	std::unique_ptr<BYTE[]> _buffer;
+	ULONG _bufferSize{ 0 };
 };
 
 ProcessHandlesTracker::Impl::Impl(uint32_t pid) : 
@@ -49,6 +49,25 @@ ProcessHandlesTracker::Impl::Impl(HANDLE hProcess) : _hProcess(hProcess) {
 	}
 }
 
+PROCESS_HANDLE_SNAPSHOT_INFORMATION* ProcessHandlesTracker::Impl::QueryHandles() {
+	if (_bufferSize == 0)
+		_bufferSize = 1 << 16;
+
+	for (;;) {
+		if (!_buffer)
+			_buffer = std::make_unique<BYTE[]>(_bufferSize);
+		ULONG len = 0;
+		auto status = ::NtQueryInformationProcess(_hProcess.get(), ProcessHandleInformation, _buffer.get(), _bufferSize, &len);
+		if (status == STATUS_SUCCESS)
+			return reinterpret_cast<PROCESS_HANDLE_SNAPSHOT_INFORMATION*>(_buffer.get());
+		if (status != STATUS_BUFFER_TOO_SMALL && status != STATUS_INFO_LENGTH_MISMATCH)
+			return nullptr;
+
+		_buffer.reset();
+		_bufferSize = len > _bufferSize ? len + len / 8 : _bufferSize << 1;
+	}
+}
+
 uint32_t ProcessHandlesTracker::Impl::EnumHandles(bool clearHostory) {
 	if (!_hProcess)
 		return 0;
@@ -57,68 +76,70 @@ uint32_t ProcessHandlesTracker::Impl::EnumHandles(bool clearHostory) {
 	assert(rc != WAIT_FAILED);
 
 	if (rc == WAIT_OBJECT_0) {
-		_closedHandles.clear();
-		_closedHandles.insert(_closedHandles.begin(), _handles.begin(), _handles.end());
+		_closedHandles = std::move(_handles);
 		_newHandles.clear();
 		_handles.clear();
 		return 0;
 	}
-	auto size = 1 << 22;
-	ULONG len;
-	std::unique_ptr<BYTE[]> buffer;
-	for(;;) {
-		buffer = std::make_unique<BYTE[]>(size);
-		auto status = ::NtQueryInformationProcess(_hProcess.get(), ProcessHandleInformation, buffer.get(), size, &len);
-		if (status == STATUS_SUCCESS)
-			break;
-		if (STATUS_BUFFER_TOO_SMALL == status) {
-			size = len + (1 << 12);
-			continue;
-		}
+
+	auto info = QueryHandles();
+	if (info == nullptr)
 		return 0;
-	}
 
-	auto info = reinterpret_cast<PROCESS_HANDLE_SNAPSHOT_INFORMATION*>(buffer.get());
 	if (clearHostory)
 		_handles.clear();
 
 	_newHandles.clear();
 	_closedHandles.clear();
-	if (_handles.empty()) {
-		_newHandles.reserve(1024);
-		_closedHandles.reserve(32);
+
+	auto count = info->NumberOfHandles;
+	_current.clear();
+	_current.reserve(count);
+	for (ULONG i = 0; i < count; i++) {
+		const auto& entry = info->Handles[i];
+		_current.push_back({ entry.HandleValue, (uint16_t)entry.ObjectTypeIndex });
 	}
+	// the snapshot is normally in handle table order already
+	auto less = [](const auto& h1, const auto& h2) { return h1.HandleValue < h2.HandleValue; };
+	if (!std::is_sorted(_current.begin(), _current.end(), less))
+		std::sort(_current.begin(), _current.end(), less);
 
 	if (_handles.empty()) {
-		_handles.reserve(info->NumberOfHandles);
-		for (ULONG i = 0; i < info->NumberOfHandles; i++) {
-			const auto& entry = info->Handles[i];
-			HandleEntryInfo key = { entry.HandleValue, (uint16_t)entry.ObjectTypeIndex };
-			_handles.insert(key);
-		}
+		_handles.swap(_current);
+		return static_cast<uint32_t>(_handles.size());
 	}
-	else {
-		auto oldHandles = _handles;
-		for (ULONG i = 0; i < info->NumberOfHandles; i++) {
-			const auto& entry = info->Handles[i];
-			HandleEntryInfo key = { entry.HandleValue, (uint16_t)entry.ObjectTypeIndex };
-			if (_handles.find(key) == _handles.end()) {
-				// new handle
-				_newHandles.push_back(key);
-				_handles.insert(key);
-			}
-			else {
-				// existing handle
-				oldHandles.erase(key);
-			}
+
+	DiffHandles(_handles, _current, _newHandles, _closedHandles);
+	_handles.swap(_current);
+
+	return static_cast<uint32_t>(_handles.size());
+}
+
+void ProcessHandlesTracker::DiffHandles(const std::vector<HandleEntryInfo>& oldHandles, const std::vector<HandleEntryInfo>& newHandles,
+	std::vector<HandleEntryInfo>& opened, std::vector<HandleEntryInfo>& closed) {
+	size_t i = 0, j = 0;
+	auto oldCount = oldHandles.size(), newCount = newHandles.size();
+	while (i < oldCount && j < newCount) {
+		auto& h1 = oldHandles[i];
+		auto& h2 = newHandles[j];
+		if (h1.HandleValue < h2.HandleValue) {
+			closed.push_back(h1);
+			i++;
 		}
-		for (auto& hi : oldHandles) {
-			_closedHandles.push_back(hi);
-			_handles.erase(hi);
+		else if (h2.HandleValue < h1.HandleValue) {
+			opened.push_back(h2);
+			j++;
+		}
+		else {
+			if (h1.ObjectTypeIndex != h2.ObjectTypeIndex) {
+				closed.push_back(h1);
+				opened.push_back(h2);
+			}
+			i++, j++;
 		}
 	}
-
-	return static_cast<uint32_t>(_handles.size());
+	closed.insert(closed.end(), oldHandles.begin() + i, oldHandles.end());
+	opened.insert(opened.end(), newHandles.begin() + j, newHandles.end());
 }
 
 ProcessHandlesTracker::ProcessHandlesTracker(uint32_t pid) : _impl(new Impl(pid)) {
@@ -134,6 +155,7 @@ bool WinSys::ProcessHandlesTracker::IsValid() const {
 }
 
 uint32_t ProcessHandlesTracker::EnumHandles(bool clearHistory) {
+	PROFILE_SCOPE("Enumeration", "EnumProcessHandles");
 	return _impl->EnumHandles(clearHistory);
 }
 
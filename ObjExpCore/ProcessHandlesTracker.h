@@ -20,6 +20,11 @@ namespace WinSys {
 		const std::vector<HandleEntryInfo>& GetNewHandles() const;
 		const std::vector<HandleEntryInfo>& GetClosedHandles() const;
 
+		// appends the differences between two snapshots, both sorted by handle value: handles only in the old one
+		// were closed, only in the new one were opened; a handle value reused for another type is both
+		static void DiffHandles(const std::vector<HandleEntryInfo>& oldHandles, const std::vector<HandleEntryInfo>& newHandles,
+			std::vector<HandleEntryInfo>& opened, std::vector<HandleEntryInfo>& closed);
+
 	private:
 		struct Impl;
 		std::unique_ptr<Impl> _impl;
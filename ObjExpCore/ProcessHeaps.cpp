@@ -1,9 +1,13 @@
 #include "pch.h"
 #include "ProcessHeaps.h"
 #include <TlHelp32.h>
+#include <algorithm>
 
 using namespace WinSys;
 
+ProcessHeaps::ProcessHeaps(uint32_t pid) : _pid(pid) {
+}
+
 std::vector<ProcessHeap> ProcessHeaps::EnumHeaps() {
 	std::vector<ProcessHeap> heaps;
 	_hSnapshot.reset(::CreateToolhelp32Snapshot(TH32CS_SNAPHEAPLIST, _pid));
@@ -30,25 +34,114 @@ std::vector<ProcessHeap> ProcessHeaps::EnumHeaps() {
 
 std::vector<ProcessHeapEntry> WinSys::ProcessHeaps::EnumHeapEntries(const ProcessHeap& heap) {
 	std::vector<ProcessHeapEntry> entries;
-	if (!_hSnapshot)
-		return entries;
+	entries.reserve(256);
+	WalkHeapBlocks(heap, [&](auto& entry) { entries.push_back(entry); }, nullptr);
+	return entries;
+}
 
-	::HEAPENTRY32 he;
-	he.dwSize = sizeof(he);
+bool ProcessHeaps::WalkHeap(const ProcessHeap& heap, HeapAggregator& aggregator, const HeapWalkProgress& progress) {
+	return WalkHeapBlocks(heap, [&](auto& entry) { aggregator.Add(entry); }, progress);
+}
 
-	auto id = reinterpret_cast<ULONG_PTR>(heap.Address);
-	if (!::Heap32First(&he, _pid, id))
-		return entries;
+bool ProcessHeaps::WalkHeapBlocks(const ProcessHeap& heap, const std::function<void(const ProcessHeapEntry&)>& onBlock, const HeapWalkProgress& progress) {
+	// Heap32Next queries all heap entries of the process again on every call, which is quadratic;
+	// query them once and walk the result
+	using unique_debug_buffer = wil::unique_any<PRTL_DEBUG_INFORMATION, decltype(&::RtlDestroyQueryDebugBuffer), ::RtlDestroyQueryDebugBuffer>;
+	unique_debug_buffer buffer(::RtlCreateQueryDebugBuffer(0, FALSE));
+	if (!buffer)
+		return false;
 
-	entries.reserve(256);
-	do {
-		ProcessHeapEntry entry;
-		entry.Address = reinterpret_cast<void*>(he.dwAddress);
-		entry.BlockSize = he.dwBlockSize;
-		entry.Flag = (ProcessHeapEntryFlags)he.dwFlags;
-		entries.push_back(entry);
+	if (!NT_SUCCESS(::RtlQueryProcessDebugInformation(ULongToHandle(_pid), RTL_QUERY_PROCESS_HEAP_SUMMARY | RTL_QUERY_PROCESS_HEAP_ENTRIES, buffer.get())))
+		return false;
 
-	} while (::Heap32Next(&he));
+	auto heaps = buffer.get()->Heaps;
+	if (heaps == nullptr)
+		return false;
 
-	return entries;
+	const RTL_HEAP_INFORMATION* info = nullptr;
+	for (ULONG i = 0; i < heaps->NumberOfHeaps; i++) {
+		if (heaps->Heaps[i].BaseAddress == heap.Address) {
+			info = &heaps->Heaps[i];
+			break;
+		}
+	}
+	if (info == nullptr || info->Entries == nullptr)
+		return false;
+
+	const size_t ProgressInterval = 1 << 14;
+	auto count = info->NumberOfEntries;
+	auto address = static_cast<BYTE*>(heap.Address);
+	for (ULONG i = 0; i < count; i++) {
+		if (progress && i % ProgressInterval == 0 && !progress(i, count))
+			return false;
+
+		auto& entry = info->Entries[i];
+		if (entry.Flags & RTL_HEAP_SEGMENT) {
+			// blocks follow the segment's first block back to back
+			address = static_cast<BYTE*>(entry.u.s2.FirstBlock);
+			continue;
+		}
+		if ((entry.Flags & RTL_HEAP_UNCOMMITTED_RANGE) == 0) {
+			ProcessHeapEntry block;
+			block.Address = address;
+			block.BlockSize = entry.Size;
+			block.Flag = (entry.Flags & RTL_HEAP_BUSY) ? ProcessHeapEntryFlags::Fixed : ProcessHeapEntryFlags::Free;
+			onBlock(block);
+		}
+		address += entry.Size;
+	}
+	if (progress)
+		progress(count, count);
+
+	return true;
+}
+
+HeapAggregator::HeapAggregator(size_t topCount) : _topCount(topCount) {
+	_largest.reserve(topCount);
+	Reset();
+}
+
+void HeapAggregator::Reset() {
+	_summary = HeapSummary{};
+	_largest.clear();
+}
+
+void HeapAggregator::Add(const ProcessHeapEntry& block) {
+	auto size = block.BlockSize;
+	if (block.Flag == ProcessHeapEntryFlags::Free) {
+		_summary.FreeBlocks++;
+		_summary.FreeBytes += size;
+		return;
+	}
+
+	_summary.BusyBlocks++;
+	_summary.BusyBytes += size;
+	int bucket = 0;
+	for (auto n = size; n > 1; n >>= 1)
+		bucket++;
+	_summary.Histogram[bucket]++;
+
+	if (_topCount == 0)
+		return;
+
+	auto greater = [](auto& b1, auto& b2) { return b1.BlockSize > b2.BlockSize; };
+	if (_largest.size() < _topCount) {
+		_largest.push_back(block);
+		std::push_heap(_largest.begin(), _largest.end(), greater);
+	}
+	else if (size > _largest.front().BlockSize) {
+		std::pop_heap(_largest.begin(), _largest.end(), greater);
+		_largest.back() = block;
+		std::push_heap(_largest.begin(), _largest.end(), greater);
+	}
+}
+
+const HeapSummary& HeapAggregator::GetSummary() const {
+	return _summary;
+}
+
+std::vector<ProcessHeapEntry> HeapAggregator::GetLargestBlocks() const {
+	auto blocks = _largest;
+	std::sort(blocks.begin(), blocks.end(), [](auto& b1, auto& b2) { return b1.BlockSize > b2.BlockSize; });
+	return blocks;
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <functional>
+
 namespace WinSys {
 	struct ProcessHeap {
 		void* Address;
@@ -18,6 +20,43 @@ namespace WinSys {
 		ProcessHeapEntryFlags Flag;
 	};
 
+	struct HeapSummary {
+		static constexpr int HistogramBuckets = sizeof(size_t) * 8;
+
+		size_t BusyBlocks;
+		size_t FreeBlocks;
+		uint64_t BusyBytes;
+		uint64_t FreeBytes;
+		// Histogram[i] counts the busy blocks of size [2^i, 2^(i+1))
+		size_t Histogram[HistogramBuckets];
+	};
+
+	//
+	// folds a stream of heap blocks into totals, a size histogram and the largest busy blocks,
+	// in memory independent of the number of blocks
+	//
+
+	class HeapAggregator {
+	public:
+		explicit HeapAggregator(size_t topCount = 16);
+
+		void Add(const ProcessHeapEntry& block);
+		void Reset();
+
+		const HeapSummary& GetSummary() const;
+		// largest first
+		std::vector<ProcessHeapEntry> GetLargestBlocks() const;
+
+	private:
+		HeapSummary _summary;
+		size_t _topCount;
+		// min-heap by size, so the smallest of the largest is replaced first
+		std::vector<ProcessHeapEntry> _largest;
+	};
+
+	// called with the blocks walked so far and the total; returning false cancels the walk
+	using HeapWalkProgress = std::function<bool(size_t walked, size_t total)>;
+
 	class ProcessHeaps {
 	public:
 		ProcessHeaps(uint32_t pid);
@@ -25,9 +64,14 @@ namespace WinSys {
 		std::vector<ProcessHeap> EnumHeaps();
 		std::vector<ProcessHeapEntry> EnumHeapEntries(const ProcessHeap& heap);
 
+		// streams the blocks of the heap into the aggregator without storing them.
+		// returns false on failure or if cancelled
+		bool WalkHeap(const ProcessHeap& heap, HeapAggregator& aggregator, const HeapWalkProgress& progress = nullptr);
+
 	private:
+		bool WalkHeapBlocks(const ProcessHeap& heap, const std::function<void(const ProcessHeapEntry&)>& onBlock, const HeapWalkProgress& progress);
+
 		uint32_t _pid;
 		wil::unique_handle _hSnapshot;
 	};
 }
-
@@ -4,12 +4,13 @@
 #include <vector>
 #include <memory>
 #include "Keys.h"
+#include "PerfCounter.h"
 
 namespace WinSys {
 	struct ThreadInfo;
 
 	struct ProcessInfo {
-		friend class ProcessManager;
+		friend class ProcessSnapshotParser;
 
 		ProcessInfo();
 
@@ -18,6 +19,8 @@ namespace WinSys {
 		const std::wstring& GetNativeImagePath() const { return _nativeImagePath; }
 		const std::vector<std::shared_ptr<ThreadInfo>>& GetThreads() const;
 		const std::wstring& GetUserName() const;
+		// slot in the parser's process counters
+		PerfCounter::Slot GetCounterSlot() const { return _counterSlot; }
 
 		int BasePriority;
 		uint32_t Id;
@@ -65,5 +68,7 @@ namespace WinSys {
 		std::wstring _packageFullName;
 		mutable std::wstring _userName;
 		std::vector<std::shared_ptr<ThreadInfo>> _threads;
+		uint32_t _generation{ 0 };
+		PerfCounter::Slot _counterSlot{ PerfCounter::InvalidSlot };
 	};
 }
\ No newline at end of file
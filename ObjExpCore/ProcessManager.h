@@ -3,10 +3,14 @@
 #include <memory>
 #include <vector>
 #include "Keys.h"
+#include "PerfCounter.h"
+#include "MetricHistory.h"
+#include "ProcessSnapshotParser.h"
 
 namespace WinSys {
 	struct ProcessInfo;
 	struct ThreadInfo;
+	class ProcessSnapshot;
 
 	class ProcessManager {
 	public:
@@ -17,6 +21,13 @@ namespace WinSys {
 
 		size_t EnumProcesses();
 		size_t EnumProcessesAndThreads(uint32_t pid = 0);
+		// parses a snapshot captured elsewhere (e.g. on a sampling thread)
+		// returns false if the snapshot is not newer than the last one parsed
+		bool Update(const ProcessSnapshot& snapshot, bool includeThreads = false, uint32_t pid = 0);
+
+		// the cycle mode opens the threads being enumerated to query their cycle times
+		void SetCpuAccounting(CpuAccounting mode);
+		[[nodiscard]] CpuAccounting GetCpuAccounting() const;
 
 		[[nodiscard]] std::vector<std::shared_ptr<ProcessInfo>>& GetProcesses();
 		[[nodiscard]] const std::vector<std::shared_ptr<ProcessInfo>>& GetProcesses() const;
@@ -35,6 +46,11 @@ namespace WinSys {
 		[[nodiscard]] const std::vector<std::shared_ptr<ThreadInfo>>& GetTerminatedThreads() const;
 		[[nodiscard]] const std::vector<std::shared_ptr<ThreadInfo>>& GetNewThreads() const;
 
+		[[nodiscard]] const ProcessHistory* GetProcessHistory(const ProcessOrThreadKey& key) const;
+		[[nodiscard]] const ThreadHistory* GetThreadHistory(const ProcessOrThreadKey& key) const;
+		[[nodiscard]] const PerfCounter& GetProcessCounters() const;
+		[[nodiscard]] const PerfCounter& GetThreadCounters() const;
+
 		[[nodiscard]] size_t GetThreadCount() const;
 		[[nodiscard]] size_t GetProcessCount() const;
 		[[nodiscard]] std::wstring GetProcessNameById(uint32_t pid) const;
@@ -4,14 +4,72 @@
 #include <Psapi.h>
 #include <ImageHlp.h>
 #include "Helpers.h"
+#include "Keys.h"
+#include "Profiler.h"
+#include <atomic>
 
 #pragma comment(lib, "imagehlp")
 
 using namespace WinSys;
 
+namespace {
+	// only what the enumeration already has, so a hit costs no query. an image file can't be written while mapped;
+	// one renamed away and replaced by a file of the same size is still served the old headers
+	struct ImageKey {
+		std::wstring NtPath;
+		uint32_t Size;
+		DWORD Type;
+
+		bool operator==(const ImageKey& other) const {
+			return other.Size == Size && other.Type == Type && other.NtPath == NtPath;
+		}
+	};
+
+	struct ImageKeyHash {
+		size_t operator()(const ImageKey& key) const {
+			return std::hash<std::wstring>()(key.NtPath) ^ key.Size ^ key.Type;
+		}
+	};
+
+	struct ImageMetadata {
+		std::wstring Path;
+		std::wstring Name;
+		// as read from the header of the mapping at MappedAt; other mappings of the image may differ (see GetImageBase)
+		void* ImageBase{ nullptr };
+		void* MappedAt{ nullptr };
+		DllCharacteristics Characteristics{ DllCharacteristics::None };
+	};
+
+	// the same images (ntdll, kernel32...) are mapped in most processes; their headers are parsed once.
+	// when full, the least recently used image is dropped
+	struct ImageCache {
+		static const size_t MaxImages = 2048;
+
+		struct Entry {
+			std::shared_ptr<const ImageMetadata> Image;
+			// updated under the shared lock
+			std::atomic<uint64_t> LastUse{ 0 };
+		};
+
+		wil::srwlock Lock;
+		std::unordered_map<ImageKey, Entry, ImageKeyHash> Images;
+		std::atomic<uint64_t> Hits{ 0 }, Misses{ 0 }, Clock{ 0 };
+	};
+
+	ImageCache& GetImageCache() {
+		static ImageCache cache;
+		return cache;
+	}
+}
+
 struct ProcessModuleTracker::Impl {
 	std::vector<std::shared_ptr<ModuleInfo>> _modules, _newModules, _unloadedModules;
-	std::unordered_map<std::wstring, std::shared_ptr<ModuleInfo>> _moduleMap;
+	struct TrackedModule {
+		std::shared_ptr<ModuleInfo> Module;
+		uint32_t Generation;
+	};
+	std::unordered_map<ModuleKey, TrackedModule> _moduleMap;
+	uint32_t _generation{ 0 };
 	DWORD _pid;
 	wil::unique_handle _handle;
 	BOOL _isWow64;
@@ -47,36 +105,108 @@ struct ProcessModuleTracker::Impl {
 		return mi;
 	}
 
-	std::shared_ptr<ModuleInfo> FillModule(const MEMORY_BASIC_INFORMATION& mbi) {
+	bool ReadHeader(const MEMORY_BASIC_INFORMATION& mbi, void*& imageBase, DllCharacteristics& characteristics) const {
+		BYTE buffer[1 << 12];
+		if (!::ReadProcessMemory(_handle.get(), mbi.BaseAddress, buffer, sizeof(buffer), nullptr))
+			return false;
+		auto nt = ::ImageNtHeader(buffer);
+		if (!nt)
+			return false;
+
+		auto machine = nt->FileHeader.Machine;
+		if (machine == IMAGE_FILE_MACHINE_ARM || machine == IMAGE_FILE_MACHINE_I386) {
+			auto oh = (IMAGE_OPTIONAL_HEADER32*)&nt->OptionalHeader;
+			imageBase = UlongToPtr(oh->ImageBase);
+			characteristics = (DllCharacteristics)oh->DllCharacteristics;
+		}
+		else {
+			imageBase = (PVOID)nt->OptionalHeader.ImageBase;
+			characteristics = (DllCharacteristics)nt->OptionalHeader.DllCharacteristics;
+		}
+		return true;
+	}
+
+	// the image base in the header of this mapping, which is not shared by the mappings of an image:
+	// a header that is rewritten when the image is relocated holds the address of its own mapping
+	void* GetImageBase(const ImageMetadata& image, const MEMORY_BASIC_INFORMATION& mbi) const {
+		// the same mapping address, or a header that kept a base other than where it was mapped (not rewritten)
+		if (image.MappedAt == mbi.AllocationBase || image.ImageBase != image.MappedAt)
+			return image.ImageBase;
+
+		// mapped at its base elsewhere: this mapping's header may hold either address
+		void* imageBase = nullptr;
+		DllCharacteristics characteristics;
+		ReadHeader(mbi, imageBase, characteristics);
+		return imageBase;
+	}
+
+	std::shared_ptr<const ImageMetadata> GetImageMetadata(PCWSTR ntPath, const MEMORY_BASIC_INFORMATION& mbi, uint32_t size) {
+		auto& cache = GetImageCache();
+		ImageKey key{ ntPath, size, mbi.Type };
+		{
+			auto lock = cache.Lock.lock_shared();
+			if (auto it = cache.Images.find(key); it != cache.Images.end()) {
+				cache.Hits++;
+				it->second.LastUse = ++cache.Clock;
+				return it->second.Image;
+			}
+		}
+
+		auto image = std::make_shared<ImageMetadata>();
+		image->Path = Helpers::GetDosNameFromNtName(ntPath);
+		image->Name = ::wcsrchr(ntPath, L'\\') + 1;
+		image->MappedAt = mbi.AllocationBase;
+		ReadHeader(mbi, image->ImageBase, image->Characteristics);
+
+		auto lock = cache.Lock.lock_exclusive();
+		cache.Misses++;
+		// another tracker may have parsed the same image meanwhile
+		auto [it, inserted] = cache.Images.try_emplace(std::move(key));
+		if (inserted) {
+			it->second.Image = std::move(image);
+			if (cache.Images.size() > ImageCache::MaxImages) {
+				// a miss is already slow; a scan for the oldest entry is cheap in comparison
+				auto oldest = cache.Images.end();
+				for (auto i = cache.Images.begin(); i != cache.Images.end(); ++i)
+					if (i != it && (oldest == cache.Images.end() || i->second.LastUse < oldest->second.LastUse))
+						oldest = i;
+				cache.Images.erase(oldest);
+			}
+		}
+		it->second.LastUse = ++cache.Clock;
+		return it->second.Image;
+	}
+
+	std::shared_ptr<ModuleInfo> FillModule(const MEMORY_BASIC_INFORMATION& mbi, uint32_t size) {
 		auto mi = std::make_shared<ModuleInfo>();
-		mi->ModuleSize = 0;
-		WCHAR name[MAX_PATH];
+		mi->ModuleSize = size;
 		mi->ImageBase = 0;
+		mi->Characteristics = DllCharacteristics::None;
+		WCHAR name[MAX_PATH];
 		if (::GetMappedFileName(_handle.get(), mbi.AllocationBase, name, _countof(name))) {
-			mi->Path = Helpers::GetDosNameFromNtName(name);
-			mi->Name = ::wcsrchr(name, L'\\') + 1;
-			BYTE buffer[1 << 12];
-			if (::ReadProcessMemory(_handle.get(), mbi.BaseAddress, buffer, sizeof(buffer), nullptr)) {
-				auto nt = ::ImageNtHeader(buffer);
-				if (nt) {
-					auto machine = nt->FileHeader.Machine;
-					if (machine == IMAGE_FILE_MACHINE_ARM || machine == IMAGE_FILE_MACHINE_I386) {
-						auto oh = (IMAGE_OPTIONAL_HEADER32*)&nt->OptionalHeader;
-						mi->ImageBase = UlongToPtr(oh->ImageBase);
-						mi->Characteristics = (DllCharacteristics)oh->DllCharacteristics;
-					}
-					else {
-						mi->ImageBase = (PVOID)nt->OptionalHeader.ImageBase;
-						mi->Characteristics = (DllCharacteristics)nt->OptionalHeader.DllCharacteristics;
-					}
-				}
-			}
+			auto image = GetImageMetadata(name, mbi, size);
+			mi->Path = image->Path;
+			mi->Name = image->Name;
+			mi->ImageBase = GetImageBase(*image, mbi);
+			mi->Characteristics = image->Characteristics;
 		}
 		mi->Base = mbi.AllocationBase;
 		mi->Type = mbi.Type == MEM_MAPPED ? MapType::Data : MapType::Image;
 		return mi;
 	}
 
+	void RemoveUnloaded(uint32_t generation) {
+		for (auto it = _moduleMap.begin(); it != _moduleMap.end(); ) {
+			if (it->second.Generation != generation) {
+				_unloadedModules.push_back(std::move(it->second.Module));
+				it = _moduleMap.erase(it);
+			}
+			else {
+				++it;
+			}
+		}
+	}
+
 	uint32_t EnumModules() {
 		return _handle ? EnumModulesWithVirtualQuery() : EnumModulesWithToolHelp();
 	}
@@ -93,44 +223,46 @@ struct ProcessModuleTracker::Impl {
 			_newModules.clear();
 			_unloadedModules.clear();
 		}
+		_modules.clear();
+		auto generation = ++_generation;
 
-		auto existing = _moduleMap;
+		// a module is a run of committed, non private regions starting at its allocation base
+		MEMORY_BASIC_INFORMATION mbi, start{};
+		uint32_t size = 0;
+		auto add = [&]() {
+			ModuleKey key{ (size_t)start.AllocationBase, start.Type };
+			auto& tracked = _moduleMap[key];
+			tracked.Generation = generation;
+			// same base and size: assume the same mapping, no need to query it again
+			if (tracked.Module == nullptr || tracked.Module->ModuleSize != size) {
+				if (tracked.Module)
+					_unloadedModules.push_back(std::move(tracked.Module));
+				tracked.Module = FillModule(start, size);
+				if (!first)
+					_newModules.push_back(tracked.Module);
+			}
+			_modules.push_back(tracked.Module);
+		};
 
-		MEMORY_BASIC_INFORMATION mbi;
 		const BYTE* address = nullptr;
-		ModuleInfo* pmi = nullptr;
 		while (::VirtualQueryEx(_handle.get(), address, &mbi, sizeof(mbi)) > 0) {
 			if (mbi.State == MEM_COMMIT && mbi.Type != MEM_PRIVATE) {
 				if (mbi.AllocationBase == mbi.BaseAddress) {
-					auto mi = FillModule(mbi);
-					pmi = mi.get();
-					auto key = mi->Name + L"#" + std::to_wstring((size_t)mi->Base);
-					if (first) {
-						_moduleMap.insert({ key, mi });
-						_modules.push_back(std::move(mi));
-					}
-					else {
-						auto it = _moduleMap.find(key);
-						if (it == _moduleMap.end()) {
-							// new module
-							_modules.push_back(mi);
-							_newModules.push_back(mi);
-							_moduleMap.insert({ key, mi });
-						}
-						else {
-							existing.erase(key);
-						}
-					}
+					if (size)
+						add();
+					start = mbi;
+					size = 0;
 				}
-				pmi->ModuleSize += (ULONG)mbi.RegionSize;
+				// regions of other allocations (after a gap in the run) aren't part of the module
+				if ((size && mbi.AllocationBase == start.AllocationBase) || mbi.AllocationBase == mbi.BaseAddress)
+					size += (uint32_t)mbi.RegionSize;
 			}
 			address += mbi.RegionSize;
 		}
+		if (size)
+			add();
 
-		for (auto& [key, mi] : existing) {
-			_moduleMap.erase(key);
-			_unloadedModules.push_back(mi);
-		}
+		RemoveUnloaded(generation);
 
 		return static_cast<uint32_t>(_modules.size());
 	}
@@ -151,33 +283,29 @@ struct ProcessModuleTracker::Impl {
 			_unloadedModules.clear();
 		}
 
+		_modules.clear();
+		auto generation = ++_generation;
+
 		MODULEENTRY32 me;
 		me.dwSize = sizeof(me);
-		::Module32First(hSnapshot.get(), &me);
+		if (!::Module32First(hSnapshot.get(), &me))
+			return 0;
 
-		auto existing = _moduleMap;
 		do {
-			if (first) {
-				auto mi = FillModule(me);
-				_moduleMap.insert({ mi->Path, mi });
-				_modules.push_back(std::move(mi));
-			}
-			else {
-				auto it = _moduleMap.find(me.szExePath);
-				if (it == _moduleMap.end()) {
-					// new module
-					auto mi = FillModule(me);
-					_modules.push_back(mi);
-					_newModules.push_back(mi);
-				}
-				else {
-					existing.erase(me.szExePath);
-				}
+			ModuleKey key{ (size_t)me.hModule, MEM_IMAGE };
+			auto& tracked = _moduleMap[key];
+			tracked.Generation = generation;
+			if (tracked.Module == nullptr || tracked.Module->ModuleSize != me.modBaseSize) {
+				if (tracked.Module)
+					_unloadedModules.push_back(std::move(tracked.Module));
+				tracked.Module = FillModule(me);
+				if (!first)
+					_newModules.push_back(tracked.Module);
 			}
+			_modules.push_back(tracked.Module);
 		} while (::Module32Next(hSnapshot.get(), &me));
 
-		for (auto& [key, mi] : existing)
-			_unloadedModules.push_back(mi);
+		RemoveUnloaded(generation);
 
 		return static_cast<uint32_t>(_modules.size());
 	}
@@ -192,6 +320,7 @@ WinSys::ProcessModuleTracker::ProcessModuleTracker(HANDLE hProcess) : _impl(new
 }
 
 uint32_t WinSys::ProcessModuleTracker::EnumModules() {
+	PROFILE_SCOPE("Enumeration", "EnumModules");
 	return _impl->EnumModules();
 }
 
@@ -210,3 +339,9 @@ const std::vector<std::shared_ptr<ModuleInfo>>& WinSys::ProcessModuleTracker::Ge
 bool ProcessModuleTracker::IsRunning() const {
 	return ::WaitForSingleObject(_impl->_handle.get(), 0) == WAIT_TIMEOUT;
 }
+
+ImageCacheStats ProcessModuleTracker::GetImageCacheStats() {
+	auto& cache = GetImageCache();
+	auto lock = cache.Lock.lock_shared();
+	return ImageCacheStats{ cache.Images.size(), cache.Hits, cache.Misses };
+}
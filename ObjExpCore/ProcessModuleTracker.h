@@ -35,6 +35,11 @@ namespace WinSys {
 		MapType Type;
 	};
 
+	struct ImageCacheStats {
+		size_t Images;
+		uint64_t Hits, Misses;
+	};
+
 	class ProcessModuleTracker final {
 	public:
 		explicit ProcessModuleTracker(DWORD pid);
@@ -48,6 +53,9 @@ namespace WinSys {
 		const std::vector<std::shared_ptr<ModuleInfo>>& GetUnloadedModules() const;
 		bool IsRunning() const;
 
+		// parsed image headers are shared by all trackers, keyed by mapped file path, mapping size and type
+		static ImageCacheStats GetImageCacheStats();
+
 	private:
 		struct Impl;
 		std::unique_ptr<Impl> _impl;
@@ -0,0 +1,113 @@
+#include "pch.h"
+#include "ProcessSnapshot.h"
+#include "Processes.h"
+#include "PerfCounter.h"
+#include "Profiler.h"
+#include "ProcessSnapshotLayout.h"
+#include <VersionHelpers.h>
+
+using namespace WinSys;
+
+// the parser reads the snapshot through the portable records, which must match the native ones
+static_assert(sizeof(SnapshotThread) == sizeof(SYSTEM_THREAD_INFORMATION));
+static_assert(offsetof(SnapshotThread, UniqueThread) == offsetof(SYSTEM_THREAD_INFORMATION, ClientId.UniqueThread));
+static_assert(offsetof(SnapshotThread, WaitReason) == offsetof(SYSTEM_THREAD_INFORMATION, WaitReason));
+static_assert(sizeof(SnapshotExtendedThread) == sizeof(SYSTEM_EXTENDED_THREAD_INFORMATION));
+static_assert(offsetof(SnapshotExtendedThread, TebBase) == offsetof(SYSTEM_EXTENDED_THREAD_INFORMATION, TebBase));
+static_assert(offsetof(SnapshotProcess, ImageName.Buffer) == offsetof(SYSTEM_PROCESS_INFORMATION, ImageName.Buffer));
+static_assert(offsetof(SnapshotProcess, UniqueProcessId) == offsetof(SYSTEM_PROCESS_INFORMATION, UniqueProcessId));
+static_assert(offsetof(SnapshotProcess, PeakVirtualSize) == offsetof(SYSTEM_PROCESS_INFORMATION, PeakVirtualSize));
+static_assert(offsetof(SnapshotProcess, PrivatePageCount) == offsetof(SYSTEM_PROCESS_INFORMATION, PrivatePageCount));
+static_assert(offsetof(SnapshotProcess, Threads) == offsetof(SYSTEM_PROCESS_INFORMATION, Threads));
+static_assert(offsetof(SnapshotProcessExtension, UserSidOffset) == offsetof(SYSTEM_PROCESS_INFORMATION_EXTENSION, UserSidOffset));
+static_assert(offsetof(SnapshotProcessExtension, AppIdOffset) == offsetof(SYSTEM_PROCESS_INFORMATION_EXTENSION, AppIdOffset));
+static_assert(offsetof(SnapshotProcessExtension, JobObjectId) == offsetof(SYSTEM_PROCESS_INFORMATION_EXTENSION, JobObjectId));
+static_assert(sizeof(SnapshotProcessExtension) == sizeof(SYSTEM_PROCESS_INFORMATION_EXTENSION));
+
+struct ProcessSnapshot::Impl {
+	wil::unique_virtualalloc_ptr<BYTE> _buffer;
+	ULONG _bufferSize{ 1 << 22 };
+	ULONG _size{ 0 };
+	int64_t _timestamp{ 0 };
+	bool _extended{ false };
+	ProcessSnapshotSummary _summary{};
+
+	bool Capture();
+	void Summarize();
+};
+
+bool ProcessSnapshot::Impl::Capture() {
+	static const bool isElevated = Process::OpenById(::GetCurrentProcessId())->IsElevated();
+	_extended = isElevated && IsWindows8OrGreater();
+	auto infoClass = _extended ? SystemFullProcessInformation : SystemExtendedProcessInformation;
+
+	for (;;) {
+		if (!_buffer) {
+			_buffer.reset((BYTE*)::VirtualAlloc(nullptr, _bufferSize, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE));
+			if (!_buffer)
+				return false;
+		}
+
+		// get timing info as close as possible to the API call
+
+		_timestamp = PerfCounter::Now();
+		ULONG len = 0;
+		auto status = NtQuerySystemInformation(infoClass, _buffer.get(), _bufferSize, &len);
+		if (status == STATUS_INFO_LENGTH_MISMATCH || status == STATUS_BUFFER_TOO_SMALL) {
+			// grow the buffer with some headroom, as processes and threads may be created before the next call
+			_buffer.reset();
+			auto size = (len + (1 << 16)) & ~0xffffUL;
+			_bufferSize = size > _bufferSize * 2 ? size : _bufferSize * 2;
+			continue;
+		}
+		_size = NT_SUCCESS(status) ? (len ? len : _bufferSize) : 0;
+		if (!NT_SUCCESS(status))
+			return false;
+
+		Summarize();
+		return true;
+	}
+}
+
+void ProcessSnapshot::Impl::Summarize() {
+	_summary = ProcessSnapshotSummary{};
+	auto p = reinterpret_cast<const SYSTEM_PROCESS_INFORMATION*>(_buffer.get());
+	for (;;) {
+		_summary.Processes++;
+		_summary.Threads += p->NumberOfThreads;
+		_summary.Handles += p->HandleCount;
+		if (p->UniqueProcessId)
+			_summary.BusyTime += p->KernelTime.QuadPart + p->UserTime.QuadPart;
+		if (p->NextEntryOffset == 0 || p->NextEntryOffset >= _size - ((const BYTE*)p - _buffer.get()))
+			break;
+		p = reinterpret_cast<const SYSTEM_PROCESS_INFORMATION*>((const BYTE*)p + p->NextEntryOffset);
+	}
+}
+
+ProcessSnapshot::ProcessSnapshot() : _impl(std::make_unique<Impl>()) {}
+ProcessSnapshot::~ProcessSnapshot() = default;
+
+bool ProcessSnapshot::Capture() {
+	PROFILE_SCOPE("Enumeration", "ProcessSnapshot::Capture");
+	return _impl->Capture();
+}
+
+const void* ProcessSnapshot::GetBuffer() const {
+	return _impl->_buffer.get();
+}
+
+size_t ProcessSnapshot::GetSize() const {
+	return _impl->_size;
+}
+
+int64_t ProcessSnapshot::GetTimestamp() const {
+	return _impl->_timestamp;
+}
+
+bool ProcessSnapshot::IsExtended() const {
+	return _impl->_extended;
+}
+
+const ProcessSnapshotSummary& ProcessSnapshot::GetSummary() const {
+	return _impl->_summary;
+}
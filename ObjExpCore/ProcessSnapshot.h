@@ -0,0 +1,42 @@
+#pragma once
+
+#include <memory>
+
+namespace WinSys {
+	struct ProcessSnapshotSummary {
+		uint32_t Processes;
+		uint32_t Threads;
+		uint32_t Handles;
+		// kernel + user time of all processes but the idle process, in 100 nsec units
+		int64_t BusyTime;
+	};
+
+	//
+	// raw system process/thread snapshot (SYSTEM_PROCESS_INFORMATION chain).
+	// captured once, it can be handed to any number of ProcessManager instances
+	//
+
+	class ProcessSnapshot {
+	public:
+		ProcessSnapshot();
+		~ProcessSnapshot();
+		ProcessSnapshot(const ProcessSnapshot&) = delete;
+		ProcessSnapshot& operator=(const ProcessSnapshot&) = delete;
+
+		// refills the snapshot, reusing (and growing if needed) the existing buffer
+		bool Capture();
+
+		[[nodiscard]] const void* GetBuffer() const;
+		[[nodiscard]] size_t GetSize() const;
+		// capture time in 100 nsec units
+		[[nodiscard]] int64_t GetTimestamp() const;
+		// true for the SystemFullProcessInformation layout
+		[[nodiscard]] bool IsExtended() const;
+		// totals computed on capture, for cheap comparisons between snapshots
+		[[nodiscard]] const ProcessSnapshotSummary& GetSummary() const;
+
+	private:
+		struct Impl;
+		std::unique_ptr<Impl> _impl;
+	};
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace WinSys {
+	//
+	// the records of a raw process snapshot, in fixed width types only, so the parser doesn't depend on the native headers.
+	// they mirror SYSTEM_PROCESS_INFORMATION, SYSTEM_EXTENDED_THREAD_INFORMATION and SYSTEM_PROCESS_INFORMATION_EXTENSION
+	// for the pointer size of the build (ProcessSnapshot.cpp checks them against phnt).
+	// pointers are addresses in the capturing process; strings are UTF-16
+	//
+
+	struct SnapshotString {
+		uint16_t Length;			// bytes
+		uint16_t MaximumLength;
+		uintptr_t Buffer;
+	};
+
+	struct SnapshotThread {
+		int64_t KernelTime;
+		int64_t UserTime;
+		int64_t CreateTime;
+		uint32_t WaitTime;
+		uintptr_t StartAddress;
+		uintptr_t UniqueProcess;
+		uintptr_t UniqueThread;
+		int32_t Priority;
+		int32_t BasePriority;
+		uint32_t ContextSwitches;
+		uint32_t ThreadState;
+		uint32_t WaitReason;
+	};
+
+	struct SnapshotExtendedThread {
+		SnapshotThread ThreadInfo;
+		uintptr_t StackBase;
+		uintptr_t StackLimit;
+		uintptr_t Win32StartAddress;
+		uintptr_t TebBase;
+		uintptr_t Reserved[3];
+	};
+
+	struct SnapshotProcess {
+		uint32_t NextEntryOffset;
+		uint32_t NumberOfThreads;
+		int64_t WorkingSetPrivateSize;
+		uint32_t HardFaultCount;
+		uint32_t NumberOfThreadsHighWatermark;
+		uint64_t CycleTime;
+		int64_t CreateTime;
+		int64_t UserTime;
+		int64_t KernelTime;
+		SnapshotString ImageName;
+		int32_t BasePriority;
+		uintptr_t UniqueProcessId;
+		uintptr_t InheritedFromUniqueProcessId;
+		uint32_t HandleCount;
+		uint32_t SessionId;
+		uintptr_t UniqueProcessKey;
+		size_t PeakVirtualSize;
+		size_t VirtualSize;
+		uint32_t PageFaultCount;
+		size_t PeakWorkingSetSize;
+		size_t WorkingSetSize;
+		size_t QuotaPeakPagedPoolUsage;
+		size_t QuotaPagedPoolUsage;
+		size_t QuotaPeakNonPagedPoolUsage;
+		size_t QuotaNonPagedPoolUsage;
+		size_t PagefileUsage;
+		size_t PeakPagefileUsage;
+		size_t PrivatePageCount;
+		int64_t ReadOperationCount;
+		int64_t WriteOperationCount;
+		int64_t OtherOperationCount;
+		int64_t ReadTransferCount;
+		int64_t WriteTransferCount;
+		int64_t OtherTransferCount;
+		// NumberOfThreads records, followed by a SnapshotProcessExtension in the full layout
+		SnapshotExtendedThread Threads[1];
+	};
+
+	// follows the threads of each process in the full (SystemFullProcessInformation) layout
+	struct SnapshotProcessExtension {
+		uint64_t DiskCounters[5];
+		uint64_t ContextSwitches;
+		uint32_t Flags;
+		// from the start of the process record
+		uint32_t UserSidOffset;
+		// from the start of the extension
+		uint32_t PackageFullNameOffset;
+		uint64_t EnergyValues[34];
+		uint32_t AppIdOffset;
+		size_t SharedCommitCharge;
+		uint32_t JobObjectId;
+		uint32_t SpareUlong;
+		uint64_t ProcessSequenceNumber;
+	};
+
+	constexpr size_t SnapshotThreadsOffset = offsetof(SnapshotProcess, Threads);
+}
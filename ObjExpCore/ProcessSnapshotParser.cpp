@@ -0,0 +1,561 @@
+#include "pch.h"
+#include "ProcessSnapshotParser.h"
+#include "ProcessInfo.h"
+#include "ThreadInfo.h"
+#include "MetricHistory.h"
+#include "ProcessSnapshotLayout.h"
+
+using namespace WinSys;
+
+struct ProcessSnapshotParser::Impl {
+	using ProcessMap = std::unordered_map<ProcessOrThreadKey, std::shared_ptr<ProcessInfo>>;
+	using ThreadMap = std::unordered_map<ProcessOrThreadKey, std::shared_ptr<ThreadInfo>>;
+
+	// processes
+
+	std::unordered_map<uint32_t, std::shared_ptr<ProcessInfo>> _processesById;
+	std::vector<std::shared_ptr<ProcessInfo>> _processes;
+	std::vector<std::shared_ptr<ProcessInfo>> _terminatedProcesses;
+	std::vector<std::shared_ptr<ProcessInfo>> _newProcesses;
+	ProcessMap _processesByKey;
+
+	// threads
+
+	std::vector<std::shared_ptr<ThreadInfo>> _threads;
+	std::vector<std::shared_ptr<ThreadInfo>> _newThreads;
+	std::vector<std::shared_ptr<ThreadInfo>> _terminatedThreads;
+	std::unordered_map<uint32_t, std::shared_ptr<ThreadInfo>> _threadsById;
+	ThreadMap _threadsByKey;
+
+	PerfCounter _processCounters;
+	PerfCounter _threadCounters;
+	// kept until the terminated entity is reported
+	std::unordered_map<ProcessOrThreadKey, ProcessHistory> _processHistory;
+	std::unordered_map<ProcessOrThreadKey, ThreadHistory> _threadHistory;
+
+	uint32_t _totalProcessors;
+	uint32_t _generation{ 0 };
+	CpuAccounting _cpuAccounting{ CpuAccounting::Time };
+	ThreadCycleQuery _threadCycles;
+	// sum of the cycle times of all processes in the buffer, ignoring the pid filter
+	uint64_t _systemCycles{ 0 }, _prevSystemCycles{ 0 };
+
+	// bounds of the buffer being parsed
+	const uint8_t* _begin{ nullptr };
+	const uint8_t* _end{ nullptr };
+
+	explicit Impl(uint32_t processorCount) : _totalProcessors(processorCount ? processorCount : 1) {}
+
+	size_t Parse(const void* buffer, size_t size, int64_t timestamp, bool extended, bool includeThreads, uint32_t pid);
+	std::shared_ptr<ProcessInfo> BuildProcessInfo(const SnapshotProcess* info, bool includeThreads,
+		std::shared_ptr<ProcessInfo> pi, bool extended);
+	void SetCounters(const ProcessInfo* pi, const SnapshotProcess* info);
+	void UpdateCpu(bool includeThreads);
+	uint64_t GetSystemCyclesDelta() const;
+	void AddHistory(bool includeThreads);
+
+	bool IsInBuffer(const void* p, uint64_t size) const {
+		auto b = static_cast<const uint8_t*>(p);
+		return b >= _begin && b <= _end && size <= static_cast<uint64_t>(_end - b);
+	}
+
+	std::shared_ptr<ProcessInfo> GetProcessById(uint32_t pid) const {
+		auto it = _processesById.find(pid);
+		return it == _processesById.end() ? nullptr : it->second;
+	}
+
+	std::shared_ptr<ProcessInfo> GetProcessByKey(const ProcessOrThreadKey& key) const {
+		auto it = _processesByKey.find(key);
+		return it == _processesByKey.end() ? nullptr : it->second;
+	}
+
+	std::shared_ptr<ThreadInfo> GetThreadByKey(const ProcessOrThreadKey& key) const {
+		auto it = _threadsByKey.find(key);
+		return it == _threadsByKey.end() ? nullptr : it->second;
+	}
+
+	std::vector<std::pair<std::shared_ptr<ProcessInfo>, int>> BuildProcessTree() const {
+		std::vector<std::pair<std::shared_ptr<ProcessInfo>, int>> tree;
+		tree.reserve(_processes.size());
+
+		auto map = _processesById;
+		for (auto& p : _processes) {
+			auto it = _processesById.find(p->ParentId);
+			if (p->ParentId == 0 || it == _processesById.end() || (it != _processesById.end() && it->second->CreateTime > p->CreateTime)) {
+				// root
+				tree.push_back(std::make_pair(p, 0));
+				map.erase(p->Id);
+				if (p->Id == 0)
+					continue;
+				auto children = FindChildren(map, p.get(), 1);
+				for (auto& child : children)
+					tree.push_back(std::make_pair(_processesById.at(child.first), child.second));
+			}
+		}
+		return tree;
+	}
+
+	std::vector<std::pair<uint32_t, int>> FindChildren(decltype(_processesById)& map, ProcessInfo* parent, int indent) const {
+		std::vector<std::pair<uint32_t, int>> children;
+		for (auto& p : _processes) {
+			if (p->ParentId == parent->Id && p->CreateTime > parent->CreateTime) {
+				children.push_back(std::make_pair(p->Id, indent));
+				map.erase(p->Id);
+				auto children2 = FindChildren(map, p.get(), indent + 1);
+				children.insert(children.end(), children2.begin(), children2.end());
+			}
+		}
+		return children;
+	}
+};
+
+size_t ProcessSnapshotParser::Impl::Parse(const void* buffer, size_t size, int64_t timestamp, bool extended, bool includeThreads, uint32_t pid) {
+	if (buffer == nullptr || size < SnapshotThreadsOffset)
+		return 0;
+
+	_begin = static_cast<const uint8_t*>(buffer);
+	_end = _begin + size;
+
+	//
+	// existing objects are updated in place and stamped with the current generation;
+	// anything left with an older generation after the pass has terminated
+	//
+	++_generation;
+
+	_processes.clear();
+	_newProcesses.clear();
+	_processCounters.Begin(timestamp);
+	if (includeThreads) {
+		_threads.clear();
+		_newThreads.clear();
+		_threadCounters.Begin(timestamp);
+	}
+
+	_prevSystemCycles = _systemCycles;
+	_systemCycles = 0;
+
+	auto p = static_cast<const SnapshotProcess*>(buffer);
+	for (;;) {
+		// stop at the first malformed entry
+		if (!IsInBuffer(p, SnapshotThreadsOffset) ||
+			!IsInBuffer(p->Threads, (uint64_t)p->NumberOfThreads * sizeof(SnapshotExtendedThread)))
+			break;
+
+		_systemCycles += p->CycleTime;
+		if (pid == 0 || pid == static_cast<uint32_t>(p->UniqueProcessId)) {
+			ProcessOrThreadKey key = { p->CreateTime, static_cast<uint32_t>(p->UniqueProcessId) };
+			std::shared_ptr<ProcessInfo> pi;
+			if (auto it = _processesByKey.find(key); it == _processesByKey.end()) {
+				// new process
+				pi = BuildProcessInfo(p, includeThreads, nullptr, extended);
+				_newProcesses.push_back(pi);
+				_processesByKey.insert({ key, pi });
+			}
+			else {
+				pi = it->second;
+				BuildProcessInfo(p, includeThreads, pi, extended);
+			}
+			SetCounters(pi.get(), p);
+			pi->_generation = _generation;
+			_processesById[pi->Id] = pi;
+			_processes.push_back(std::move(pi));
+		}
+		if (p->NextEntryOffset == 0)
+			break;
+		p = reinterpret_cast<const SnapshotProcess*>((const uint8_t*)p + p->NextEntryOffset);
+	}
+
+	_processCounters.Commit();
+	if (includeThreads)
+		_threadCounters.Commit();
+	UpdateCpu(includeThreads);
+	AddHistory(includeThreads);
+
+	//
+	// processes not seen in this pass are terminated ones
+	//
+	for (auto& pi : _terminatedProcesses)
+		_processHistory.erase(pi->Key);
+	_terminatedProcesses.clear();
+	if (_processesByKey.size() > _processes.size()) {
+		for (auto it = _processesByKey.begin(); it != _processesByKey.end(); ) {
+			if (it->second->_generation == _generation) {
+				++it;
+				continue;
+			}
+			// the id may already belong to a new process
+			if (auto id = _processesById.find(it->first.Id); id != _processesById.end() && id->second == it->second)
+				_processesById.erase(id);
+			_processCounters.RemoveEntity(it->second->_counterSlot);
+			_terminatedProcesses.push_back(std::move(it->second));
+			it = _processesByKey.erase(it);
+		}
+	}
+
+	if (includeThreads) {
+		for (auto& thread : _terminatedThreads)
+			_threadHistory.erase(thread->Key);
+		_terminatedThreads.clear();
+		if (_threadsByKey.size() > _threads.size()) {
+			for (auto it = _threadsByKey.begin(); it != _threadsByKey.end(); ) {
+				if (it->second->_generation == _generation) {
+					++it;
+					continue;
+				}
+				if (auto id = _threadsById.find(it->first.Id); id != _threadsById.end() && id->second == it->second)
+					_threadsById.erase(id);
+				_threadCounters.RemoveEntity(it->second->_counterSlot);
+				_terminatedThreads.push_back(std::move(it->second));
+				it = _threadsByKey.erase(it);
+			}
+		}
+	}
+
+	_begin = _end = nullptr;
+
+	return _processes.size();
+}
+
+std::shared_ptr<ProcessInfo> ProcessSnapshotParser::Impl::BuildProcessInfo(
+	const SnapshotProcess* info, bool includeThreads, std::shared_ptr<ProcessInfo> pi, bool extended) {
+	if (pi == nullptr) {
+		pi = std::make_shared<ProcessInfo>();
+		pi->_counterSlot = _processCounters.AddEntity();
+		pi->Id = static_cast<uint32_t>(info->UniqueProcessId);
+		pi->SessionId = info->SessionId;
+		pi->CreateTime = info->CreateTime;
+		pi->Key.Created = pi->CreateTime;
+		pi->Key.Id = pi->Id;
+		pi->ParentId = static_cast<uint32_t>(info->InheritedFromUniqueProcessId);
+		pi->ClearThreads();
+		std::wstring name;
+		if (info->UniqueProcessId == 0)
+			name = L"(Idle)";
+		else if (auto image = reinterpret_cast<const wchar_t*>(info->ImageName.Buffer); IsInBuffer(image, info->ImageName.Length))
+			name.assign(image, info->ImageName.Length / sizeof(wchar_t));
+
+		auto ext = (const SnapshotProcessExtension*)((const uint8_t*)info +
+			SnapshotThreadsOffset + sizeof(SnapshotExtendedThread) * info->NumberOfThreads);
+		if (extended && info->UniqueProcessId && IsInBuffer(ext, sizeof(*ext))) {
+			pi->JobObjectId = ext->JobObjectId;
+			auto index = name.rfind(L'\\');
+			auto sid = (const uint8_t*)info + ext->UserSidOffset;
+			if (IsInBuffer(sid, sizeof(pi->UserSid)))
+				::memcpy(pi->UserSid, sid, sizeof(pi->UserSid));
+			pi->_processName = index == std::wstring::npos ? name : name.substr(index + 1);
+			pi->_nativeImagePath = name;
+			if (ext->PackageFullNameOffset > 0) {
+				auto package = (const wchar_t*)((const uint8_t*)ext + ext->PackageFullNameOffset);
+				if (IsInBuffer(package, sizeof(wchar_t)))
+					pi->_packageFullName.assign(package, ::wcsnlen(package, (_end - (const uint8_t*)package) / sizeof(wchar_t)));
+			}
+		}
+		else {
+			pi->_processName = name;
+			pi->JobObjectId = 0;
+		}
+	}
+
+	pi->ThreadCount = info->NumberOfThreads;
+	pi->BasePriority = info->BasePriority;
+	pi->UserTime = info->UserTime;
+	pi->KernelTime = info->KernelTime;
+	pi->HandleCount = info->HandleCount;
+	pi->PageFaultCount = info->PageFaultCount;
+	pi->PeakThreads = info->NumberOfThreadsHighWatermark;
+	pi->PeakVirtualSize = info->PeakVirtualSize;
+	pi->VirtualSize = info->VirtualSize;
+	pi->WorkingSetSize = info->WorkingSetSize;
+	pi->PeakWorkingSetSize = info->PeakWorkingSetSize;
+	pi->PagefileUsage = info->PagefileUsage;
+	pi->OtherOperationCount = info->OtherOperationCount;
+	pi->ReadOperationCount = info->ReadOperationCount;
+	pi->WriteOperationCount = info->WriteOperationCount;
+	pi->HardFaultCount = info->HardFaultCount;
+	pi->OtherTransferCount = info->OtherTransferCount;
+	pi->ReadTransferCount = info->ReadTransferCount;
+	pi->WriteTransferCount = info->WriteTransferCount;
+	pi->PeakPagefileUsage = info->PeakPagefileUsage;
+	pi->CycleTime = info->CycleTime;
+	pi->NonPagedPoolUsage = info->QuotaNonPagedPoolUsage;
+	pi->PagedPoolUsage = info->QuotaPagedPoolUsage;
+	pi->PeakNonPagedPoolUsage = info->QuotaPeakNonPagedPoolUsage;
+	pi->PeakPagedPoolUsage = info->QuotaPeakPagedPoolUsage;
+	pi->PrivatePageCount = info->PrivatePageCount;
+
+	if (includeThreads && pi->Id > 0) {
+		pi->ClearThreads();
+		auto threadCount = info->NumberOfThreads;
+		for (uint32_t i = 0; i < threadCount; i++) {
+			auto tinfo = info->Threads + i;
+			const auto& baseInfo = tinfo->ThreadInfo;
+			ProcessOrThreadKey key = { baseInfo.CreateTime, static_cast<uint32_t>(baseInfo.UniqueThread) };
+			std::shared_ptr<ThreadInfo> thread;
+			bool newobject = true;
+			if (auto it = _threadsByKey.find(key); it != _threadsByKey.end()) {
+				thread = it->second;
+				newobject = false;
+			}
+			if (newobject) {
+				thread = std::make_shared<ThreadInfo>();
+				thread->_counterSlot = _threadCounters.AddEntity();
+				thread->_processName = pi->GetImageName();
+				thread->Id = static_cast<uint32_t>(baseInfo.UniqueThread);
+				thread->ProcessId = static_cast<uint32_t>(baseInfo.UniqueProcess);
+				thread->CreateTime = baseInfo.CreateTime;
+				thread->StartAddress = reinterpret_cast<void*>(baseInfo.StartAddress);
+				thread->StackBase = reinterpret_cast<void*>(tinfo->StackBase);
+				thread->StackLimit = reinterpret_cast<void*>(tinfo->StackLimit);
+				thread->Win32StartAddress = reinterpret_cast<void*>(tinfo->Win32StartAddress);
+				thread->TebBase = reinterpret_cast<void*>(tinfo->TebBase);
+				thread->Key = key;
+			}
+			thread->KernelTime = baseInfo.KernelTime;
+			thread->UserTime = baseInfo.UserTime;
+			thread->Priority = baseInfo.Priority;
+			thread->BasePriority = baseInfo.BasePriority;
+			thread->ThreadState = (ThreadState)baseInfo.ThreadState;
+			thread->WaitReason = (WaitReason)baseInfo.WaitReason;
+			thread->WaitTime = baseInfo.WaitTime;
+			thread->ContextSwitches = baseInfo.ContextSwitches;
+			thread->_generation = _generation;
+			_threadCounters.Set(thread->_counterSlot, PerfMetric::CpuTime, thread->KernelTime + thread->UserTime);
+			_threadCounters.Set(thread->_counterSlot, PerfMetric::ContextSwitches, thread->ContextSwitches);
+			uint64_t cycles = 0;
+			int64_t cycleTimestamp = 0;
+			if (_cpuAccounting != CpuAccounting::Cycles || !_threadCycles || !_threadCycles(*thread, cycles, cycleTimestamp)) {
+				cycles = 0;
+				cycleTimestamp = 0;
+			}
+			// CycleTime is still the previous read's
+			thread->_cycleInterval = cycles && thread->CycleTime && cycleTimestamp > thread->_cycleTimestamp ? cycleTimestamp - thread->_cycleTimestamp : 0;
+			thread->_cycleTimestamp = cycleTimestamp;
+			thread->CycleTime = cycles;
+			_threadCounters.Set(thread->_counterSlot, PerfMetric::CycleTime, cycles);
+
+			pi->AddThread(thread);
+
+			if (newobject) {
+				// new thread
+				_newThreads.push_back(thread);
+				_threadsByKey.insert({ key, thread });
+			}
+			_threadsById[thread->Id] = thread;
+			_threads.push_back(std::move(thread));
+		}
+	}
+	return pi;
+}
+
+void ProcessSnapshotParser::Impl::SetCounters(const ProcessInfo* pi, const SnapshotProcess* info) {
+	// the process has no context switch count of its own
+	uint64_t contextSwitches = 0;
+	auto threads = info->Threads;
+	for (uint32_t i = 0; i < info->NumberOfThreads; i++)
+		contextSwitches += threads[i].ThreadInfo.ContextSwitches;
+
+	auto slot = pi->_counterSlot;
+	auto& counters = _processCounters;
+	counters.Set(slot, PerfMetric::CpuTime, pi->KernelTime + pi->UserTime);
+	counters.Set(slot, PerfMetric::CycleTime, pi->CycleTime);
+	counters.Set(slot, PerfMetric::ReadOperations, pi->ReadOperationCount);
+	counters.Set(slot, PerfMetric::WriteOperations, pi->WriteOperationCount);
+	counters.Set(slot, PerfMetric::OtherOperations, pi->OtherOperationCount);
+	counters.Set(slot, PerfMetric::ReadBytes, pi->ReadTransferCount);
+	counters.Set(slot, PerfMetric::WriteBytes, pi->WriteTransferCount);
+	counters.Set(slot, PerfMetric::OtherBytes, pi->OtherTransferCount);
+	counters.Set(slot, PerfMetric::PageFaults, pi->PageFaultCount);
+	counters.Set(slot, PerfMetric::ContextSwitches, contextSwitches);
+}
+
+uint64_t ProcessSnapshotParser::Impl::GetSystemCyclesDelta() const {
+	//
+	// the cycles of processes that terminated since the last pass are gone from the total,
+	// so it's never taken to be less than the sum of the deltas of the surviving processes
+	//
+	auto deltas = _processCounters.GetDeltas(PerfMetric::CycleTime);
+	uint64_t tracked = 0;
+	for (auto& pi : _processes)
+		tracked += deltas[pi->_counterSlot];
+
+	auto total = _prevSystemCycles && _systemCycles > _prevSystemCycles ? _systemCycles - _prevSystemCycles : 0;
+	return total > tracked ? total : tracked;
+}
+
+void ProcessSnapshotParser::Impl::UpdateCpu(bool includeThreads) {
+	// CPU is in 1/10000 percent units, relative to all processors for processes and to one processor for threads
+	uint64_t systemCycles = 0;
+	if (_cpuAccounting == CpuAccounting::Cycles && _processCounters.GetInterval() > 0)
+		systemCycles = GetSystemCyclesDelta();
+
+	if (systemCycles > 0) {
+		auto deltas = _processCounters.GetDeltas(PerfMetric::CycleTime);
+		for (auto& pi : _processes)
+			pi->CPU = (int32_t)(deltas[pi->_counterSlot] * 1000000.0 / systemCycles);
+	}
+	else if (auto interval = _processCounters.GetInterval(); interval > 0) {
+		auto deltas = _processCounters.GetDeltas(PerfMetric::CpuTime);
+		for (auto& pi : _processes)
+			pi->CPU = (int32_t)(deltas[pi->_counterSlot] * 1000000 / interval / _totalProcessors);
+	}
+	else {
+		for (auto& pi : _processes)
+			pi->CPU = 0;
+	}
+
+	if (!includeThreads)
+		return;
+
+	if (auto interval = _threadCounters.GetInterval(); interval > 0) {
+		auto deltas = _threadCounters.GetDeltas(PerfMetric::CpuTime);
+		auto cycleDeltas = _threadCounters.GetDeltas(PerfMetric::CycleTime);
+		// cycles of one processor per 100 nsec, over the snapshot interval
+		auto processInterval = _processCounters.GetInterval();
+		auto cycleRate = systemCycles > 0 && processInterval > 0 ? systemCycles / (double)processInterval / _totalProcessors : 0;
+		for (auto& thread : _threads) {
+			auto slot = thread->_counterSlot;
+			// thread cycles are read after the snapshot, so they're compared to the time between the thread's own reads
+			if (cycleRate > 0 && thread->_cycleInterval > 0)
+				thread->CPU = (int32_t)(cycleDeltas[slot] * 1000000.0 / (cycleRate * thread->_cycleInterval));
+			else
+				thread->CPU = (int32_t)(deltas[slot] * 1000000 / interval);
+		}
+	}
+	else {
+		for (auto& thread : _threads)
+			thread->CPU = 0;
+	}
+}
+
+void ProcessSnapshotParser::Impl::AddHistory(bool includeThreads) {
+	float values[ProcessHistory::MetricCount];
+	auto readRates = _processCounters.GetRates(PerfMetric::ReadBytes);
+	auto writeRates = _processCounters.GetRates(PerfMetric::WriteBytes);
+	auto otherRates = _processCounters.GetRates(PerfMetric::OtherBytes);
+	for (auto& pi : _processes) {
+		auto slot = pi->_counterSlot;
+		values[(int)ProcessHistoryMetric::CPU] = pi->CPU / 10000.0f;
+		values[(int)ProcessHistoryMetric::WorkingSet] = (float)pi->WorkingSetSize;
+		values[(int)ProcessHistoryMetric::PrivateBytes] = (float)pi->PrivatePageCount;
+		values[(int)ProcessHistoryMetric::Handles] = (float)pi->HandleCount;
+		values[(int)ProcessHistoryMetric::IoRate] = (float)(readRates[slot] + writeRates[slot] + otherRates[slot]);
+		_processHistory[pi->Key].Add(values);
+	}
+
+	if (!includeThreads)
+		return;
+
+	float threadValues[ThreadHistory::MetricCount];
+	auto switchRates = _threadCounters.GetRates(PerfMetric::ContextSwitches);
+	for (auto& thread : _threads) {
+		threadValues[(int)ThreadHistoryMetric::CPU] = thread->CPU / 10000.0f;
+		threadValues[(int)ThreadHistoryMetric::ContextSwitchRate] = (float)switchRates[thread->_counterSlot];
+		_threadHistory[thread->Key].Add(threadValues);
+	}
+}
+
+ProcessSnapshotParser::ProcessSnapshotParser(uint32_t processorCount) : _impl(std::make_unique<Impl>(processorCount)) {}
+ProcessSnapshotParser::~ProcessSnapshotParser() = default;
+
+size_t ProcessSnapshotParser::Parse(const void* buffer, size_t size, int64_t timestamp, bool extended, bool includeThreads, uint32_t pid) {
+	return _impl->Parse(buffer, size, timestamp, extended, includeThreads, pid);
+}
+
+void ProcessSnapshotParser::SetProcessorCount(uint32_t count) {
+	_impl->_totalProcessors = count ? count : 1;
+}
+
+uint32_t ProcessSnapshotParser::GetProcessorCount() const {
+	return _impl->_totalProcessors;
+}
+
+void ProcessSnapshotParser::SetCpuAccounting(CpuAccounting mode, ThreadCycleQuery threadCycles) {
+	_impl->_cpuAccounting = mode;
+	_impl->_threadCycles = std::move(threadCycles);
+}
+
+CpuAccounting ProcessSnapshotParser::GetCpuAccounting() const {
+	return _impl->_cpuAccounting;
+}
+
+std::vector<std::shared_ptr<ProcessInfo>>& ProcessSnapshotParser::GetProcesses() {
+	return _impl->_processes;
+}
+
+const std::vector<std::shared_ptr<ProcessInfo>>& ProcessSnapshotParser::GetProcesses() const {
+	return _impl->_processes;
+}
+
+std::vector<std::shared_ptr<ThreadInfo>>& ProcessSnapshotParser::GetThreads() {
+	return _impl->_threads;
+}
+
+const std::vector<std::shared_ptr<ThreadInfo>>& ProcessSnapshotParser::GetThreads() const {
+	return _impl->_threads;
+}
+
+std::shared_ptr<ProcessInfo> ProcessSnapshotParser::GetProcessInfo(int index) const {
+	return _impl->_processes[index];
+}
+
+std::shared_ptr<ProcessInfo> ProcessSnapshotParser::GetProcessById(uint32_t pid) const {
+	return _impl->GetProcessById(pid);
+}
+
+std::shared_ptr<ProcessInfo> ProcessSnapshotParser::GetProcessByKey(const ProcessOrThreadKey& key) const {
+	return _impl->GetProcessByKey(key);
+}
+
+const std::vector<std::shared_ptr<ProcessInfo>>& ProcessSnapshotParser::GetTerminatedProcesses() const {
+	return _impl->_terminatedProcesses;
+}
+
+const std::vector<std::shared_ptr<ProcessInfo>>& ProcessSnapshotParser::GetNewProcesses() const {
+	return _impl->_newProcesses;
+}
+
+std::shared_ptr<ThreadInfo> ProcessSnapshotParser::GetThreadInfo(int index) const {
+	return _impl->_threads[index];
+}
+
+std::shared_ptr<ThreadInfo> ProcessSnapshotParser::GetThreadByKey(const ProcessOrThreadKey& key) const {
+	return _impl->GetThreadByKey(key);
+}
+
+const std::vector<std::shared_ptr<ThreadInfo>>& ProcessSnapshotParser::GetTerminatedThreads() const {
+	return _impl->_terminatedThreads;
+}
+
+const std::vector<std::shared_ptr<ThreadInfo>>& ProcessSnapshotParser::GetNewThreads() const {
+	return _impl->_newThreads;
+}
+
+const ProcessHistory* ProcessSnapshotParser::GetProcessHistory(const ProcessOrThreadKey& key) const {
+	auto it = _impl->_processHistory.find(key);
+	return it == _impl->_processHistory.end() ? nullptr : &it->second;
+}
+
+const ThreadHistory* ProcessSnapshotParser::GetThreadHistory(const ProcessOrThreadKey& key) const {
+	auto it = _impl->_threadHistory.find(key);
+	return it == _impl->_threadHistory.end() ? nullptr : &it->second;
+}
+
+const PerfCounter& ProcessSnapshotParser::GetProcessCounters() const {
+	return _impl->_processCounters;
+}
+
+const PerfCounter& ProcessSnapshotParser::GetThreadCounters() const {
+	return _impl->_threadCounters;
+}
+
+size_t ProcessSnapshotParser::GetThreadCount() const {
+	return _impl->_threads.size();
+}
+
+size_t ProcessSnapshotParser::GetProcessCount() const {
+	return _impl->_processes.size();
+}
+
+std::vector<std::pair<std::shared_ptr<ProcessInfo>, int>> ProcessSnapshotParser::BuildProcessTree() const {
+	return _impl->BuildProcessTree();
+}
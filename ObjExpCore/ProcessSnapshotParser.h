@@ -0,0 +1,85 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <functional>
+#include "Keys.h"
+#include "PerfCounter.h"
+#include "MetricHistory.h"
+
+namespace WinSys {
+	struct ProcessInfo;
+	struct ThreadInfo;
+
+	enum class CpuAccounting {
+		// kernel + user time deltas, which only advance on clock ticks, so short bursts may show as 0
+		Time,
+		// cycle time deltas, relative to the cycles of all processes (including the idle process)
+		Cycles
+	};
+
+	//
+	// parses and diffs raw process snapshots (the SYSTEM_PROCESS_INFORMATION chain returned
+	// for SystemExtendedProcessInformation / SystemFullProcessInformation).
+	// makes no system calls, so it can be driven from a live query or a recorded buffer.
+	// the records are read through the fixed width definitions of ProcessSnapshotLayout.h
+	//
+
+	class ProcessSnapshotParser {
+	public:
+		explicit ProcessSnapshotParser(uint32_t processorCount = 1);
+		~ProcessSnapshotParser();
+		ProcessSnapshotParser(const ProcessSnapshotParser&) = delete;
+		ProcessSnapshotParser& operator=(const ProcessSnapshotParser&) = delete;
+
+		// timestamp is in 100 nsec units and must be monotonic across calls
+		// extended is true for the SystemFullProcessInformation layout
+		size_t Parse(const void* buffer, size_t size, int64_t timestamp, bool extended, bool includeThreads, uint32_t pid = 0);
+
+		void SetProcessorCount(uint32_t count);
+		[[nodiscard]] uint32_t GetProcessorCount() const;
+
+		// the snapshot has no thread cycle times, so the cycle mode uses the query (if set) for threads;
+		// threads it fails for fall back to time based CPU. timestamp is the PerfCounter time the cycles were read;
+		// as the reads follow the snapshot, a thread's cycles are normalized by the interval between its own reads
+		using ThreadCycleQuery = std::function<bool(const ThreadInfo& thread, uint64_t& cycles, int64_t& timestamp)>;
+		void SetCpuAccounting(CpuAccounting mode, ThreadCycleQuery threadCycles = nullptr);
+		[[nodiscard]] CpuAccounting GetCpuAccounting() const;
+
+		[[nodiscard]] std::vector<std::shared_ptr<ProcessInfo>>& GetProcesses();
+		[[nodiscard]] const std::vector<std::shared_ptr<ProcessInfo>>& GetProcesses() const;
+
+		[[nodiscard]] std::vector<std::shared_ptr<ThreadInfo>>& GetThreads();
+		[[nodiscard]] const std::vector<std::shared_ptr<ThreadInfo>>& GetThreads() const;
+
+		[[nodiscard]] std::shared_ptr<ProcessInfo> GetProcessInfo(int index) const;
+		[[nodiscard]] std::shared_ptr<ProcessInfo> GetProcessById(uint32_t pid) const;
+		[[nodiscard]] std::shared_ptr<ProcessInfo> GetProcessByKey(const ProcessOrThreadKey& key) const;
+		[[nodiscard]] const std::vector<std::shared_ptr<ProcessInfo>>& GetTerminatedProcesses() const;
+		[[nodiscard]] const std::vector<std::shared_ptr<ProcessInfo>>& GetNewProcesses() const;
+
+		[[nodiscard]] std::shared_ptr<ThreadInfo> GetThreadInfo(int index) const;
+		[[nodiscard]] std::shared_ptr<ThreadInfo> GetThreadByKey(const ProcessOrThreadKey& key) const;
+		[[nodiscard]] const std::vector<std::shared_ptr<ThreadInfo>>& GetTerminatedThreads() const;
+		[[nodiscard]] const std::vector<std::shared_ptr<ThreadInfo>>& GetNewThreads() const;
+
+		// one sample per Parse call (threads only when included); the history of a terminated entity
+		// is available while it is in the terminated list. the pointers are valid until the next Parse
+		[[nodiscard]] const ProcessHistory* GetProcessHistory(const ProcessOrThreadKey& key) const;
+		[[nodiscard]] const ThreadHistory* GetThreadHistory(const ProcessOrThreadKey& key) const;
+
+		// counters of the live processes and threads, indexed by their counter slot
+		[[nodiscard]] const PerfCounter& GetProcessCounters() const;
+		[[nodiscard]] const PerfCounter& GetThreadCounters() const;
+
+		[[nodiscard]] size_t GetThreadCount() const;
+		[[nodiscard]] size_t GetProcessCount() const;
+
+		// builds the tree from the last parsed snapshot
+		std::vector<std::pair<std::shared_ptr<ProcessInfo>, int>> BuildProcessTree() const;
+
+	private:
+		struct Impl;
+		std::unique_ptr<Impl> _impl;
+	};
+}
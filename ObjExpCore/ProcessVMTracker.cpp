@@ -1,7 +1,8 @@
 #include "pch.h"
 #include "ProcessVMTracker.h"
-#include <unordered_map>
 #include "Helpers.h"
+#include "PoolAllocator.h"
+#include "Profiler.h"
 
 using namespace WinSys;
 
@@ -17,12 +18,7 @@ struct ProcessVMTracker::Impl {
 	}
 
 	bool IsValid() const {
-		return _hProcess != nullptr;
-	}
-
-	~Impl() {
-		if (_hProcess)
-			::CloseHandle(_hProcess);
+		return _hProcess.is_valid();
 	}
 
 	const std::vector<std::shared_ptr<MemoryRegionItem>>& GetRegions() const {
@@ -36,11 +32,14 @@ struct ProcessVMTracker::Impl {
 	}
 
 	size_t EnumRegions();
+	size_t Update(const std::vector<MEMORY_BASIC_INFORMATION>& regions);
 
 private:
-	HANDLE _hProcess;
-	std::vector<std::shared_ptr<MemoryRegionItem>> _items, _newItems, _deletedItems;
-	std::unordered_map<MemoryRegionItem, std::shared_ptr<MemoryRegionItem>> _set;
+	wil::unique_handle _hProcess;
+	// sorted by address; _current is the next list, swapped with _items after the merge
+	std::vector<std::shared_ptr<MemoryRegionItem>> _items, _current, _newItems, _deletedItems;
+	// raw query results, kept between calls
+	std::vector<MEMORY_BASIC_INFORMATION> _regions;
 };
 
 ProcessVMTracker::ProcessVMTracker(HANDLE hProcess) : _impl(new Impl(hProcess)) {
@@ -68,47 +67,65 @@ const std::vector<std::shared_ptr<MemoryRegionItem>>& ProcessVMTracker::GetOldRe
 }
 
 size_t ProcessVMTracker::EnumRegions() {
+	PROFILE_SCOPE("Enumeration", "EnumRegions");
 	return _impl->EnumRegions();
 }
 
+size_t ProcessVMTracker::Update(const std::vector<MEMORY_BASIC_INFORMATION>& regions) {
+	return _impl->Update(regions);
+}
+
 size_t ProcessVMTracker::Impl::EnumRegions() {
 	if (!IsValid())
 		return 0;
 
-	auto count = _items.size();
-	_items.clear();
-	_items.reserve(count == 0 ? 1024 : count + 32);
+	// there is no bulk query for the regions of another process; collect them first so the
+	// diff runs over a plain array
+	_regions.clear();
+	_regions.reserve(_items.empty() ? 1024 : _items.size() + 32);
+	MEMORY_BASIC_INFORMATION mbi;
+	const BYTE* address = nullptr;
+	while (::VirtualQueryEx(_hProcess.get(), address, &mbi, sizeof(mbi))) {
+		_regions.push_back(mbi);
+		address += mbi.RegionSize;
+	}
+	return Update(_regions);
+}
+
+size_t ProcessVMTracker::Impl::Update(const std::vector<MEMORY_BASIC_INFORMATION>& regions) {
 	_newItems.clear();
-	_newItems.reserve(count == 0 ? 1024 : 32);
 	_deletedItems.clear();
-	_deletedItems.reserve(16);
 
-	const BYTE* address = nullptr;
-	auto oldItems = _set;
-	for (;;) {
-		auto mi = std::make_shared<MemoryRegionItem>();
-		if (0 == ::VirtualQueryEx(_hProcess, address, mi.get(), sizeof(MEMORY_BASIC_INFORMATION)))
-			break;
-
-		if (count == 0) {
-			_set.insert({ *mi, mi });
-		}
-		else {
-			if (_set.find(*mi) == _set.end()) {
-				// new item
-				_newItems.push_back(mi);
-				_set.insert({ *mi, mi });
+	bool first = _items.empty();
+	_current.clear();
+	_current.reserve(regions.size());
+
+	// both lists are in ascending address order; items with the same address, protection and state are kept
+	size_t i = 0, count = _items.size();
+	for (auto& region : regions) {
+		while (i < count && _items[i]->BaseAddress < region.BaseAddress)
+			_deletedItems.push_back(std::move(_items[i++]));
+
+		if (i < count && _items[i]->BaseAddress == region.BaseAddress) {
+			auto& item = _items[i++];
+			if (item->Protect == region.Protect && item->State == region.State) {
+				// the size may have changed
+				static_cast<MEMORY_BASIC_INFORMATION&>(*item) = region;
+				_current.push_back(std::move(item));
+				continue;
 			}
-			else {
-				oldItems.erase(*mi);
-			}
-
-			for (auto& [key, mi] : oldItems)
-				_deletedItems.push_back(mi);
+			_deletedItems.push_back(std::move(item));
 		}
-		_items.push_back(mi);
-		address += mi->RegionSize;
+
+		auto item = std::allocate_shared<MemoryRegionItem>(PoolAllocator<MemoryRegionItem>());
+		static_cast<MEMORY_BASIC_INFORMATION&>(*item) = region;
+		if (!first)
+			_newItems.push_back(item);
+		_current.push_back(std::move(item));
 	}
+	while (i < count)
+		_deletedItems.push_back(std::move(_items[i++]));
 
+	_items.swap(_current);
 	return _items.size();
 }
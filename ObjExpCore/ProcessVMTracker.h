@@ -18,6 +18,8 @@ namespace WinSys {
 		const std::vector<std::shared_ptr<MemoryRegionItem>>& GetNewRegions() const;
 		const std::vector<std::shared_ptr<MemoryRegionItem>>& GetOldRegions() const;
 		size_t EnumRegions();
+		// diffs against regions in ascending address order, as EnumRegions queries them (e.g. a recorded list)
+		size_t Update(const std::vector<MEMORY_BASIC_INFORMATION>& regions);
 
 	private:
 		struct Impl;
@@ -0,0 +1,251 @@
+#include "pch.h"
+#include "Profiler.h"
+#include "PerfCounter.h"
+#include <stdio.h>
+
+using namespace WinSys;
+
+namespace {
+	// 4 buckets per power of 2 of the duration (100 nsec units), so percentiles are within 25%
+	const uint32_t BucketCount = 4 * 40;
+
+	uint32_t Bucket(uint64_t duration) {
+		if (duration < 4)
+			return static_cast<uint32_t>(duration);
+		unsigned long msb;
+		::_BitScanReverse64(&msb, duration);
+		auto index = msb * 4 + static_cast<uint32_t>((duration >> (msb - 2)) & 3);
+		return index < BucketCount ? index : BucketCount - 1;
+	}
+
+	uint64_t BucketLimit(uint32_t index) {
+		if (index < 4)
+			return index;
+		auto msb = index / 4;
+		return ((4ULL + index % 4 + 1) << (msb - 2)) - 1;
+	}
+
+	void AppendEscaped(std::string& json, const std::string& text) {
+		for (auto ch : text) {
+			if (ch == '"' || ch == '\\')
+				json += '\\';
+			json += ch;
+		}
+	}
+}
+
+struct Profiler::Impl {
+	struct SiteData {
+		std::atomic<uint64_t> Calls{ 0 }, TotalTime{ 0 }, MaxTime{ 0 }, Allocations{ 0 };
+		std::atomic<uint64_t> Buckets[BucketCount]{};
+
+		void Reset() {
+			Calls = TotalTime = MaxTime = Allocations = 0;
+			for (auto& b : Buckets)
+				b = 0;
+		}
+	};
+
+	struct TraceEvent {
+		Site Index;
+		DWORD ThreadId;
+		int64_t Start, Duration;
+	};
+
+	// sites are never removed, so Record can index them without a lock
+	SiteData _sites[MaxSites];
+	std::vector<std::pair<std::string, std::string>> _names;
+	mutable wil::srwlock _namesLock;
+
+	std::vector<TraceEvent> _trace;
+	size_t _traceNext{ 0 };
+	mutable wil::srwlock _traceLock;
+
+	int64_t _enabledTime{ 0 }, _enabledSince{ 0 };
+	mutable wil::srwlock _timeLock;
+};
+
+Profiler& Profiler::Get() {
+	static Profiler profiler;
+	return profiler;
+}
+
+Profiler::Profiler() : _impl(std::make_unique<Impl>()) {}
+Profiler::~Profiler() = default;
+
+Profiler::Site Profiler::Register(const char* category, const char* name) {
+	auto lock = _impl->_namesLock.lock_exclusive();
+	auto& names = _impl->_names;
+	for (size_t i = 0; i < names.size(); i++)
+		if (names[i].first == category && names[i].second == name)
+			return static_cast<Site>(i);
+
+	if (names.size() >= MaxSites)
+		return InvalidSite;
+	names.emplace_back(category, name);
+	return static_cast<Site>(names.size() - 1);
+}
+
+void Profiler::Enable(bool enable) {
+	auto lock = _impl->_timeLock.lock_exclusive();
+	if (_enabled == enable)
+		return;
+
+	auto now = PerfCounter::Now();
+	if (enable)
+		_impl->_enabledSince = now;
+	else
+		_impl->_enabledTime += now - _impl->_enabledSince;
+	_enabled = enable;
+}
+
+void Profiler::EnableTrace(bool enable) {
+	if (enable) {
+		auto lock = _impl->_traceLock.lock_exclusive();
+		_impl->_trace.reserve(MaxTraceEvents);
+	}
+	_tracing = enable;
+}
+
+void Profiler::Record(Site site, int64_t start, int64_t duration, uint64_t allocations) {
+	if (site >= MaxSites)
+		return;
+
+	auto& data = _impl->_sites[site];
+	data.Calls++;
+	data.TotalTime += duration;
+	data.Allocations += allocations;
+	data.Buckets[Bucket(duration)]++;
+	auto peak = data.MaxTime.load();
+	while (static_cast<uint64_t>(duration) > peak && !data.MaxTime.compare_exchange_weak(peak, duration))
+		;
+
+	if (!IsTracing())
+		return;
+
+	Impl::TraceEvent event{ site, ::GetCurrentThreadId(), start, duration };
+	auto lock = _impl->_traceLock.lock_exclusive();
+	auto& trace = _impl->_trace;
+	if (trace.size() < MaxTraceEvents)
+		trace.push_back(event);
+	else
+		trace[_impl->_traceNext] = event;
+	_impl->_traceNext = (_impl->_traceNext + 1) % MaxTraceEvents;
+}
+
+void Profiler::Reset() {
+	for (auto& site : _impl->_sites)
+		site.Reset();
+
+	{
+		auto lock = _impl->_traceLock.lock_exclusive();
+		_impl->_trace.clear();
+		_impl->_traceNext = 0;
+	}
+
+	auto lock = _impl->_timeLock.lock_exclusive();
+	_impl->_enabledTime = 0;
+	_impl->_enabledSince = PerfCounter::Now();
+}
+
+int64_t Profiler::GetEnabledTime() const {
+	auto lock = _impl->_timeLock.lock_shared();
+	return _impl->_enabledTime + (IsEnabled() ? PerfCounter::Now() - _impl->_enabledSince : 0);
+}
+
+std::vector<ProfileSiteStats> Profiler::GetStats() const {
+	std::vector<ProfileSiteStats> stats;
+	auto lock = _impl->_namesLock.lock_shared();
+	auto& names = _impl->_names;
+	stats.reserve(names.size());
+	for (size_t i = 0; i < names.size(); i++) {
+		auto& data = _impl->_sites[i];
+		ProfileSiteStats s;
+		s.Category = names[i].first;
+		s.Name = names[i].second;
+		s.Calls = data.Calls;
+		s.TotalTime = data.TotalTime;
+		s.MaxTime = data.MaxTime;
+		s.Allocations = data.Allocations;
+		s.P50 = s.P99 = 0;
+
+		uint64_t counts[BucketCount], total = 0;
+		for (uint32_t b = 0; b < BucketCount; b++)
+			total += counts[b] = data.Buckets[b];
+		uint64_t sum = 0;
+		for (uint32_t b = 0; b < BucketCount && total; b++) {
+			sum += counts[b];
+			if (s.P50 == 0 && sum * 2 >= total)
+				s.P50 = BucketLimit(b);
+			if (sum * 100 >= total * 99) {
+				s.P99 = BucketLimit(b);
+				break;
+			}
+		}
+		stats.push_back(std::move(s));
+	}
+	return stats;
+}
+
+size_t Profiler::GetTraceEventCount() const {
+	auto lock = _impl->_traceLock.lock_shared();
+	return _impl->_trace.size();
+}
+
+bool Profiler::ExportTrace(const wchar_t* path) const {
+	std::vector<Impl::TraceEvent> events;
+	{
+		// oldest first
+		auto lock = _impl->_traceLock.lock_shared();
+		auto& trace = _impl->_trace;
+		auto first = trace.size() < MaxTraceEvents ? 0 : _impl->_traceNext;
+		events.reserve(trace.size());
+		events.insert(events.end(), trace.begin() + first, trace.end());
+		events.insert(events.end(), trace.begin(), trace.begin() + first);
+	}
+	std::vector<std::pair<std::string, std::string>> names;
+	{
+		auto lock = _impl->_namesLock.lock_shared();
+		names = _impl->_names;
+	}
+
+	// complete ("X") events, times in microseconds
+	std::string json = "{\"traceEvents\":[\n";
+	auto pid = ::GetCurrentProcessId();
+	char buffer[128];
+	bool first = true;
+	for (auto& e : events) {
+		if (!first)
+			json += ",\n";
+		first = false;
+		json += "{\"name\":\"";
+		AppendEscaped(json, names[e.Index].second);
+		json += "\",\"cat\":\"";
+		AppendEscaped(json, names[e.Index].first);
+		sprintf_s(buffer, "\",\"ph\":\"X\",\"ts\":%lld.%d,\"dur\":%lld.%d,\"pid\":%u,\"tid\":%u}",
+			e.Start / 10, static_cast<int>(e.Start % 10), e.Duration / 10, static_cast<int>(e.Duration % 10), pid, e.ThreadId);
+		json += buffer;
+	}
+	json += "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+	wil::unique_hfile hFile(::CreateFileW(path, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, 0, nullptr));
+	if (!hFile)
+		return false;
+
+	DWORD written;
+	return ::WriteFile(hFile.get(), json.data(), static_cast<DWORD>(json.size()), &written, nullptr) && written == json.size();
+}
+
+ProfileScope::ProfileScope(Profiler::Site site) : _site(Profiler::Get().IsEnabled() ? site : Profiler::InvalidSite) {
+	if (_site == Profiler::InvalidSite)
+		return;
+	_allocations = Profiler::GetThreadAllocations();
+	_start = PerfCounter::Now();
+}
+
+ProfileScope::~ProfileScope() {
+	if (_site == Profiler::InvalidSite)
+		return;
+	auto duration = PerfCounter::Now() - _start;
+	Profiler::Get().Record(_site, _start, duration, Profiler::GetThreadAllocations() - _allocations);
+}
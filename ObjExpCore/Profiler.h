@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+#include <string.h>
+#include <memory>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+namespace WinSys {
+	struct ProfileSiteStats {
+		std::string Category;
+		std::string Name;
+		uint64_t Calls;
+		// times are in 100 nsec units
+		uint64_t TotalTime;
+		uint64_t MaxTime;
+		// approximate (histogram bucket upper bound)
+		uint64_t P50, P99;
+		uint64_t Allocations;
+	};
+
+	//
+	// self instrumentation: scoped timers around enumerations and view work.
+	// each site keeps a call count, total/max time, a latency histogram (for percentiles) and the allocations
+	// made on the calling thread while in scope. optionally records every call as a trace event,
+	// exportable as Chrome trace JSON (chrome://tracing, Perfetto).
+	// disabled by default; a disabled scope costs one flag check
+	//
+
+	class Profiler final {
+	public:
+		using Site = uint32_t;
+		static constexpr Site InvalidSite = 0xffffffff;
+		static constexpr uint32_t MaxSites = 256;
+		static constexpr uint32_t MaxTraceEvents = 1 << 16;
+
+		static Profiler& Get();
+
+		// the same category and name always return the same site
+		Site Register(const char* category, const char* name);
+
+		void Enable(bool enable);
+		[[nodiscard]] bool IsEnabled() const {
+			return _enabled.load(std::memory_order_relaxed);
+		}
+		// keeps the last MaxTraceEvents calls; only while enabled
+		void EnableTrace(bool enable);
+		[[nodiscard]] bool IsTracing() const {
+			return _tracing.load(std::memory_order_relaxed);
+		}
+
+		void Record(Site site, int64_t start, int64_t duration, uint64_t allocations);
+		void Reset();
+		// time spent enabled since the last reset (100 nsec units), for call rates
+		[[nodiscard]] int64_t GetEnabledTime() const;
+
+		[[nodiscard]] std::vector<ProfileSiteStats> GetStats() const;
+		[[nodiscard]] size_t GetTraceEventCount() const;
+		bool ExportTrace(const wchar_t* path) const;
+
+		// called by the allocation hook of the hosting module, if any
+		static void CountAllocation() {
+			_threadAllocations++;
+		}
+		[[nodiscard]] static uint64_t GetThreadAllocations() {
+			return _threadAllocations;
+		}
+
+	private:
+		Profiler();
+		~Profiler();
+		Profiler(const Profiler&) = delete;
+		Profiler& operator=(const Profiler&) = delete;
+
+		struct Impl;
+		std::unique_ptr<Impl> _impl;
+		std::atomic<bool> _enabled{ false }, _tracing{ false };
+		inline static thread_local uint64_t _threadAllocations;
+	};
+
+	class ProfileScope final {
+	public:
+		explicit ProfileScope(Profiler::Site site);
+		~ProfileScope();
+		ProfileScope(const ProfileScope&) = delete;
+		ProfileScope& operator=(const ProfileScope&) = delete;
+
+	private:
+		Profiler::Site _site;
+		int64_t _start;
+		uint64_t _allocations;
+	};
+
+	// the type name without the class/struct prefix, for naming sites per type (e.g. per view)
+	template<typename T>
+	const char* GetProfileTypeName() {
+		static const std::string name = [] {
+			std::string name = typeid(T).name();
+			for (auto prefix : { "class ", "struct " })
+				if (name.compare(0, strlen(prefix), prefix) == 0)
+					return name.substr(strlen(prefix));
+			return name;
+		}();
+		return name.c_str();
+	}
+}
+
+#define PROFILE_CONCAT2(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT2(a, b)
+// times the rest of the enclosing scope. category and name are registered once per call site
+#define PROFILE_SCOPE(category, name) \
+	static const auto PROFILE_CONCAT(_profileSite, __LINE__) = WinSys::Profiler::Get().Register(category, name); \
+	WinSys::ProfileScope PROFILE_CONCAT(_profileScope, __LINE__)(PROFILE_CONCAT(_profileSite, __LINE__))
@@ -0,0 +1,284 @@
+#include "pch.h"
+#include "SamplingScheduler.h"
+#include "PerfCounter.h"
+#include <atomic>
+
+using namespace WinSys;
+
+namespace {
+	// unchanged samples before backing off
+	const uint32_t QuietSamples = 3;
+	// fast samples after a spike
+	const uint32_t BoostSamples = 5;
+	const uint32_t MinBoostInterval = 250;
+}
+
+struct SamplingScheduler::Impl {
+	struct Provider {
+		Impl* Owner;
+		AdaptiveSampler Sample;
+		PTP_TIMER Timer{ nullptr };
+		std::atomic<uint32_t> Interval;
+		std::atomic<uint32_t> Current;
+		std::atomic<uint32_t> MaxInterval;
+		std::atomic<bool> Paused;
+		std::atomic<bool> Removed{ false };
+		// a sample is running; arming is left to it (Rearm, RearmDelay) so samples never overlap
+		std::atomic<bool> Running{ false };
+		std::atomic<bool> Rearm{ false };
+		std::atomic<uint32_t> RearmDelay{ 0 };
+		// sampling thread only
+		uint32_t Quiet{ 0 };
+		uint32_t Boost{ 0 };
+
+		std::atomic<uint64_t> Samples{ 0 }, CpuTime{ 0 }, Cycles{ 0 }, WallTime{ 0 };
+	};
+
+	~Impl() {
+		for (auto& [id, p] : _providers)
+			Stop(p.get());
+	}
+
+	uint32_t AddProvider(AdaptiveSampler sampler, uint32_t interval, uint32_t maxInterval, bool paused) {
+		auto p = std::make_unique<Provider>();
+		p->Owner = this;
+		p->Sample = std::move(sampler);
+		p->Interval = p->Current = interval;
+		p->MaxInterval = maxInterval < interval ? interval : maxInterval;
+		p->Paused = paused;
+		p->Timer = ::CreateThreadpoolTimer(OnTimer, p.get(), nullptr);
+		if (!p->Timer)
+			return 0;
+
+		auto raw = p.get();
+		uint32_t id;
+		{
+			auto lock = _lock.lock_exclusive();
+			id = _nextId++;
+			_providers.insert({ id, std::move(p) });
+		}
+		if (!paused)
+			Schedule(raw, 0);
+		return id;
+	}
+
+	bool RemoveProvider(uint32_t id) {
+		std::unique_ptr<Provider> p;
+		{
+			auto lock = _lock.lock_exclusive();
+			auto it = _providers.find(id);
+			if (it == _providers.end())
+				return false;
+			p = std::move(it->second);
+			_providers.erase(it);
+		}
+		Stop(p.get());
+		return true;
+	}
+
+	// runs f on the provider with the lock held, so it can't be removed meanwhile
+	template<typename F>
+	bool WithProvider(uint32_t id, F&& f) const {
+		auto lock = _lock.lock_shared();
+		auto it = _providers.find(id);
+		if (it == _providers.end())
+			return false;
+		return f(it->second.get());
+	}
+
+	void Suspend(bool suspend) {
+		if (_suspended.exchange(suspend) == suspend || suspend)
+			return;
+
+		auto lock = _lock.lock_shared();
+		for (auto& [id, p] : _providers)
+			if (!p->Paused)
+				Schedule(p.get(), 0);
+	}
+
+	// arms the timer, or has a running sample do it when done
+	static void Schedule(Provider* p, uint32_t delay) {
+		p->RearmDelay = delay;
+		p->Rearm = true;
+		// the running sample may have completed before seeing the request
+		if (!p->Running)
+			TakeRearm(p);
+	}
+
+	static void TakeRearm(Provider* p) {
+		if (p->Rearm.exchange(false) && !p->Paused && !p->Removed)
+			Arm(p, p->RearmDelay);
+	}
+
+	static void Arm(Provider* p, uint32_t delay) {
+		if (p->Owner->_suspended)
+			return;
+
+		// negative due time is relative, in 100 nsec units
+		LARGE_INTEGER due;
+		due.QuadPart = delay ? -10000LL * delay : -1;
+		FILETIME ft;
+		ft.dwLowDateTime = due.LowPart;
+		ft.dwHighDateTime = due.HighPart;
+		::SetThreadpoolTimer(p->Timer, &ft, 0, 0);
+	}
+
+	static void Stop(Provider* p) {
+		p->Removed = true;
+		// twice, as a running sample may have re-armed the timer before noticing the removal
+		for (int i = 0; i < 2; i++) {
+			::SetThreadpoolTimer(p->Timer, nullptr, 0, 0);
+			::WaitForThreadpoolTimerCallbacks(p->Timer, TRUE);
+		}
+		::CloseThreadpoolTimer(p->Timer);
+	}
+
+	static uint32_t NextInterval(Provider* p, SampleActivity activity) {
+		auto interval = p->Interval.load();
+		if (activity == SampleActivity::Spike) {
+			p->Boost = BoostSamples;
+			p->Quiet = 0;
+		}
+		else {
+			if (p->Boost > 0)
+				p->Boost--;
+			p->Quiet = activity == SampleActivity::Unchanged ? p->Quiet + 1 : 0;
+		}
+
+		if (p->Boost > 0) {
+			auto fast = interval / 4 < MinBoostInterval ? MinBoostInterval : interval / 4;
+			return fast > interval ? interval : fast;
+		}
+		if (p->Quiet >= QuietSamples) {
+			auto current = p->Current.load();
+			auto next = (current < interval ? interval : current) * 2;
+			auto limit = p->MaxInterval.load();
+			return next > limit ? limit : next;
+		}
+		return interval;
+	}
+
+	static void CALLBACK OnTimer(PTP_CALLBACK_INSTANCE, PVOID context, PTP_TIMER) {
+		auto p = static_cast<Provider*>(context);
+		if (p->Paused || p->Removed || p->Owner->_suspended)
+			return;
+
+		// re-armed while the previous sample was still running; that one samples again when done
+		if (p->Running.exchange(true)) {
+			Schedule(p, 0);
+			return;
+		}
+
+		auto thread = ::GetCurrentThread();
+		FILETIME dummy, kernel0, user0, kernel1, user1;
+		ULONG64 cycles0 = 0, cycles1 = 0;
+		::GetThreadTimes(thread, &dummy, &dummy, &kernel0, &user0);
+		::QueryThreadCycleTime(thread, &cycles0);
+		auto start = PerfCounter::Now();
+
+		auto activity = p->Sample();
+
+		p->WallTime += PerfCounter::Now() - start;
+		::QueryThreadCycleTime(thread, &cycles1);
+		::GetThreadTimes(thread, &dummy, &dummy, &kernel1, &user1);
+		p->Cycles += cycles1 - cycles0;
+		p->CpuTime += *(int64_t*)&kernel1 - *(int64_t*)&kernel0 + *(int64_t*)&user1 - *(int64_t*)&user0;
+		p->Samples++;
+
+		p->Current = NextInterval(p, activity);
+		p->Running = false;
+
+		// one shot timer re-armed after each sample, so samples never overlap.
+		// a request made while sampling (resume, sample now, new interval) takes precedence
+		if (p->Rearm.exchange(false)) {
+			if (!p->Paused && !p->Removed)
+				Arm(p, p->RearmDelay);
+		}
+		else if (!p->Paused && !p->Removed)
+			Arm(p, p->Current);
+	}
+
+	mutable wil::srwlock _lock;
+	std::unordered_map<uint32_t, std::unique_ptr<Provider>> _providers;
+	uint32_t _nextId{ 1 };
+	std::atomic<bool> _suspended{ false };
+};
+
+SamplingScheduler::SamplingScheduler() : _impl(std::make_unique<Impl>()) {}
+SamplingScheduler::~SamplingScheduler() = default;
+
+uint32_t SamplingScheduler::AddProvider(Sampler sampler, uint32_t interval, bool paused) {
+	return _impl->AddProvider([sampler = std::move(sampler)]() {
+		sampler();
+		return SampleActivity::Changed;
+		}, interval, interval, paused);
+}
+
+uint32_t SamplingScheduler::AddAdaptiveProvider(AdaptiveSampler sampler, uint32_t interval, uint32_t maxInterval, bool paused) {
+	return _impl->AddProvider(std::move(sampler), interval, maxInterval, paused);
+}
+
+bool SamplingScheduler::RemoveProvider(uint32_t id) {
+	return _impl->RemoveProvider(id);
+}
+
+bool SamplingScheduler::SetInterval(uint32_t id, uint32_t interval) {
+	return _impl->WithProvider(id, [=](auto p) {
+		p->Interval = p->Current = interval;
+		if (p->MaxInterval.load() < interval)
+			p->MaxInterval = interval;
+		if (!p->Paused)
+			Impl::Schedule(p, interval);
+		return true;
+		});
+}
+
+bool SamplingScheduler::Pause(uint32_t id, bool pause) {
+	return _impl->WithProvider(id, [=](auto p) {
+		if (p->Paused.exchange(pause) == pause)
+			return true;
+
+		// a running sample doesn't re-arm once paused
+		if (pause)
+			::SetThreadpoolTimer(p->Timer, nullptr, 0, 0);
+		else
+			Impl::Schedule(p, 0);
+		return true;
+		});
+}
+
+bool SamplingScheduler::SampleNow(uint32_t id) {
+	return _impl->WithProvider(id, [](auto p) {
+		if (p->Paused)
+			return false;
+
+		Impl::Schedule(p, 0);
+		return true;
+		});
+}
+
+void SamplingScheduler::Suspend(bool suspend) {
+	_impl->Suspend(suspend);
+}
+
+bool SamplingScheduler::IsSuspended() const {
+	return _impl->_suspended;
+}
+
+bool SamplingScheduler::GetStats(uint32_t id, SamplerStats& stats) const {
+	return _impl->WithProvider(id, [&](auto p) {
+		stats.Samples = p->Samples;
+		stats.CpuTime = p->CpuTime;
+		stats.Cycles = p->Cycles;
+		stats.WallTime = p->WallTime;
+		stats.Interval = p->Interval;
+		stats.CurrentInterval = p->Current;
+		stats.Paused = p->Paused;
+		return true;
+		});
+}
+
+size_t SamplingScheduler::GetProviderCount() const {
+	auto lock = _impl->_lock.lock_shared();
+	return _impl->_providers.size();
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <memory>
+#include <functional>
+
+namespace WinSys {
+	// what an adaptive sampler saw compared to its previous sample
+	enum class SampleActivity {
+		Unchanged,
+		Changed,
+		Spike
+	};
+
+	struct SamplerStats {
+		uint64_t Samples;
+		// CPU time of the sampling thread spent in the sampler, in 100 nsec units
+		uint64_t CpuTime;
+		uint64_t Cycles;
+		// wall time spent in the sampler, in 100 nsec units
+		uint64_t WallTime;
+		uint32_t Interval;
+		// the interval actually used for the next sample
+		uint32_t CurrentInterval;
+		bool Paused;
+	};
+
+	//
+	// runs sampling callbacks on thread pool threads, each at its own interval.
+	// a callback is never run concurrently with itself; the interval is counted from the end of the previous sample.
+	// adaptive providers back off (doubling the interval up to a maximum) after a few unchanged samples,
+	// and sample faster for a while after a spike. Suspend stops all providers (e.g. when no UI is visible)
+	//
+
+	class SamplingScheduler {
+	public:
+		using Sampler = std::function<void()>;
+		using AdaptiveSampler = std::function<SampleActivity()>;
+
+		SamplingScheduler();
+		~SamplingScheduler();
+		SamplingScheduler(const SamplingScheduler&) = delete;
+		SamplingScheduler& operator=(const SamplingScheduler&) = delete;
+
+		// returns a provider id, 0 on failure. the first sample is taken right away unless paused
+		uint32_t AddProvider(Sampler sampler, uint32_t interval, bool paused = false);
+		// maxInterval is the longest back off interval
+		uint32_t AddAdaptiveProvider(AdaptiveSampler sampler, uint32_t interval, uint32_t maxInterval, bool paused = false);
+		// waits for a running sample to complete. must not be called from a sampler
+		bool RemoveProvider(uint32_t id);
+
+		bool SetInterval(uint32_t id, uint32_t interval);
+		bool Pause(uint32_t id, bool pause);
+		bool SampleNow(uint32_t id);
+
+		// providers keep their own paused state while suspended. resuming samples the active ones right away
+		void Suspend(bool suspend);
+		[[nodiscard]] bool IsSuspended() const;
+
+		bool GetStats(uint32_t id, SamplerStats& stats) const;
+		[[nodiscard]] size_t GetProviderCount() const;
+
+	private:
+		struct Impl;
+		std::unique_ptr<Impl> _impl;
+	};
+}
@@ -2,11 +2,13 @@
 #include "ServiceManager.h"
 #include "Service.h"
 #include "Token.h"
+#include "Profiler.h"
 //#include "subprocesstag.h"
 
 using namespace WinSys;
 
 std::vector<ServiceInfo> ServiceManager::EnumServices(ServiceEnumType enumType, ServiceEnumState enumState) {
+	PROFILE_SCOPE("Enumeration", "EnumServices");
 	std::vector<ServiceInfo> services;
 	wil::unique_schandle hScm(::OpenSCManager(nullptr, nullptr, SC_MANAGER_ENUMERATE_SERVICE));
 	if (!hScm)
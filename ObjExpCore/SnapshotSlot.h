@@ -0,0 +1,42 @@
+#pragma once
+
+#include <memory>
+#include <atomic>
+
+namespace WinSys {
+	//
+	// hands immutable snapshots from a single writer (typically a sampling thread) to any number of readers.
+	// readers never block the writer; a snapshot stays alive for as long as a reader holds on to it
+	//
+
+	template<typename T>
+	class SnapshotSlot {
+	public:
+		void Publish(std::shared_ptr<const T> snapshot) {
+			std::atomic_store_explicit(&_snapshot, std::move(snapshot), std::memory_order_release);
+			_version.fetch_add(1, std::memory_order_release);
+		}
+
+		[[nodiscard]] std::shared_ptr<const T> Acquire() const {
+			return std::atomic_load_explicit(&_snapshot, std::memory_order_acquire);
+		}
+
+		// incremented with every published snapshot
+		[[nodiscard]] uint32_t GetVersion() const {
+			return _version.load(std::memory_order_acquire);
+		}
+
+		// returns the latest snapshot if published after the given version (and updates it), nullptr otherwise
+		[[nodiscard]] std::shared_ptr<const T> AcquireIfNewer(uint32_t& version) const {
+			auto current = GetVersion();
+			if (current == version)
+				return nullptr;
+			version = current;
+			return Acquire();
+		}
+
+	private:
+		std::shared_ptr<const T> _snapshot;
+		std::atomic<uint32_t> _version{ 0 };
+	};
+}
@@ -0,0 +1,147 @@
+#include "pch.h"
+#include "TextMatcher.h"
+#include <wctype.h>
+
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#include <immintrin.h>
+#define TEXT_MATCHER_SIMD
+#endif
+
+using namespace WinSys;
+
+#ifdef TEXT_MATCHER_SIMD
+namespace {
+	bool HasAvx2() {
+		int regs[4];
+		::__cpuid(regs, 0);
+		if (regs[0] < 7)
+			return false;
+
+		// AVX, and the OS saves the YMM registers
+		const int osxsaveAvx = 1 << 27 | 1 << 28;
+		::__cpuid(regs, 1);
+		if ((regs[2] & osxsaveAvx) != osxsaveAvx || (::_xgetbv(0) & 6) != 6)
+			return false;
+
+		::__cpuidex(regs, 7, 0);
+		return (regs[1] & (1 << 5)) != 0;
+	}
+
+	const bool Avx2 = HasAvx2();
+
+	// ASCII upper case letters to lower case; anything else unchanged (signed compares leave chars >= 0x8000 alone)
+	__m128i FoldBlock(__m128i chars) {
+		auto upper = _mm_and_si128(_mm_cmpgt_epi16(chars, _mm_set1_epi16('A' - 1)), _mm_cmplt_epi16(chars, _mm_set1_epi16('Z' + 1)));
+		return _mm_or_si128(chars, _mm_and_si128(upper, _mm_set1_epi16(0x20)));
+	}
+
+	__m256i FoldBlock(__m256i chars) {
+		auto upper = _mm256_and_si256(_mm256_cmpgt_epi16(chars, _mm256_set1_epi16('A' - 1)), _mm256_cmpgt_epi16(_mm256_set1_epi16('Z' + 1), chars));
+		return _mm256_or_si256(chars, _mm256_and_si256(upper, _mm256_set1_epi16(0x20)));
+	}
+}
+#endif
+
+TextMatcher::TextMatcher(std::wstring_view pattern) : _pattern(pattern) {
+	for (auto& ch : _pattern)
+		ch = Fold(ch);
+	_vectorFind = !_pattern.empty() && _pattern.front() < 0x80 && _pattern.back() < 0x80;
+}
+
+wchar_t TextMatcher::Fold(wchar_t ch) {
+	if (ch < 0x80)
+		return ch >= L'A' && ch <= L'Z' ? static_cast<wchar_t>(ch | 0x20) : ch;
+	auto lower = static_cast<wchar_t>(::towlower(ch));
+	return lower < 0x80 ? ch : lower;
+}
+
+const std::wstring& TextMatcher::GetPattern() const {
+	return _pattern;
+}
+
+bool TextMatcher::IsEmpty() const {
+	return _pattern.empty();
+}
+
+bool TextMatcher::MatchAt(const wchar_t* text) const {
+	auto pattern = _pattern.data();
+	auto len = _pattern.size();
+	size_t i = 0;
+#ifdef TEXT_MATCHER_SIMD
+	for (; i + 8 <= len; i += 8) {
+		auto eq = _mm_cmpeq_epi16(FoldBlock(_mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i))),
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern + i)));
+		if (_mm_movemask_epi8(eq) == 0xffff)
+			continue;
+		// may differ only in non-ASCII case
+		for (auto j = i; j < i + 8; j++)
+			if (Fold(text[j]) != pattern[j])
+				return false;
+	}
+#endif
+	for (; i < len; i++)
+		if (Fold(text[i]) != pattern[i])
+			return false;
+	return true;
+}
+
+size_t TextMatcher::FindScalar(std::wstring_view text, size_t start) const {
+	auto len = _pattern.size();
+	for (auto i = start; i + len <= text.size(); i++)
+		if (Fold(text[i]) == _pattern[0] && MatchAt(text.data() + i))
+			return i;
+	return npos;
+}
+
+size_t TextMatcher::Find(std::wstring_view text) const {
+	auto len = _pattern.size();
+	if (len == 0)
+		return 0;
+	if (text.size() < len)
+		return npos;
+
+	size_t i = 0;
+#ifdef TEXT_MATCHER_SIMD
+	if (_vectorFind) {
+		// candidate positions are those where both the first and the last pattern characters match
+		auto p = text.data();
+		auto starts = text.size() - len + 1;
+		unsigned long bit;
+		if (Avx2) {
+			auto first = _mm256_set1_epi16(_pattern.front()), last = _mm256_set1_epi16(_pattern.back());
+			for (; i + 16 <= starts; i += 16) {
+				auto b1 = FoldBlock(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)));
+				auto b2 = FoldBlock(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i + len - 1)));
+				auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi16(b1, first), _mm256_cmpeq_epi16(b2, last))));
+				// two mask bits per character
+				for (; ::_BitScanForward(&bit, mask); mask &= ~(3u << bit))
+					if (MatchAt(p + i + bit / 2))
+						return i + bit / 2;
+			}
+		}
+		auto first = _mm_set1_epi16(_pattern.front()), last = _mm_set1_epi16(_pattern.back());
+		for (; i + 8 <= starts; i += 8) {
+			auto b1 = FoldBlock(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)));
+			auto b2 = FoldBlock(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i + len - 1)));
+			auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi16(b1, first), _mm_cmpeq_epi16(b2, last))));
+			for (; ::_BitScanForward(&bit, mask); mask &= ~(3u << bit))
+				if (MatchAt(p + i + bit / 2))
+					return i + bit / 2;
+		}
+	}
+#endif
+	return FindScalar(text, i);
+}
+
+bool TextMatcher::Contains(std::wstring_view text) const {
+	return Find(text) != npos;
+}
+
+bool TextMatcher::StartsWith(std::wstring_view text) const {
+	return text.size() >= _pattern.size() && MatchAt(text.data());
+}
+
+bool TextMatcher::Equals(std::wstring_view text) const {
+	return text.size() == _pattern.size() && MatchAt(text.data());
+}
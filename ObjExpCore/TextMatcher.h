@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace WinSys {
+	//
+	// case insensitive UTF-16 matching of many texts against one pattern, without copying or lowercasing the texts.
+	// ASCII letters are folded 8 (SSE2) or 16 (AVX2) characters at a time; other characters are folded with towlower,
+	// but never into ASCII, so the vector paths are exact. substring search compares the pattern's first and last
+	// characters a block at a time and verifies only the positions where both match
+	//
+
+	class TextMatcher final {
+	public:
+		static constexpr size_t npos = std::wstring_view::npos;
+
+		explicit TextMatcher(std::wstring_view pattern = {});
+
+		[[nodiscard]] const std::wstring& GetPattern() const;
+		[[nodiscard]] bool IsEmpty() const;
+
+		// position of the first occurrence of the pattern in text, npos if none. an empty pattern is found at 0
+		[[nodiscard]] size_t Find(std::wstring_view text) const;
+		[[nodiscard]] bool Contains(std::wstring_view text) const;
+		// text starts with the pattern
+		[[nodiscard]] bool StartsWith(std::wstring_view text) const;
+		[[nodiscard]] bool Equals(std::wstring_view text) const;
+
+		[[nodiscard]] static wchar_t Fold(wchar_t ch);
+
+	private:
+		bool MatchAt(const wchar_t* text) const;
+		size_t FindScalar(std::wstring_view text, size_t start) const;
+
+		// folded
+		std::wstring _pattern;
+		// first and last characters are ASCII, so candidates can be found with vector compares
+		bool _vectorFind;
+	};
+}
@@ -2,6 +2,7 @@
 
 #include <string>
 #include "Keys.h"
+#include "PerfCounter.h"
 
 namespace WinSys {
 	enum class ThreadState : uint32_t {
@@ -61,11 +62,15 @@ namespace WinSys {
 	};
 
 	struct ThreadInfo {
-		friend class ProcessManager;
+		friend class ProcessSnapshotParser;
 	public:
 		const std::wstring& GetProcessImageName() const {
 			return _processName;
 		}
+		// slot in the parser's thread counters
+		PerfCounter::Slot GetCounterSlot() const {
+			return _counterSlot;
+		}
 
 		uint64_t KernelTime;
 		uint64_t UserTime;
@@ -75,6 +80,8 @@ namespace WinSys {
 		int32_t Priority;
 		int32_t BasePriority;
 		uint32_t ContextSwitches;
+		// only with cycle based CPU accounting; 0 if not available
+		uint64_t CycleTime{ 0 };
 		ThreadState ThreadState;
 		WaitReason WaitReason;
 		int32_t CPU;
@@ -87,5 +94,9 @@ namespace WinSys {
 
 	private:
 		std::wstring _processName;
+		uint32_t _generation{ 0 };
+		PerfCounter::Slot _counterSlot{ PerfCounter::InvalidSlot };
+		// PerfCounter time the cycle time was read, and since the previous read (0 if either read failed)
+		int64_t _cycleTimestamp{ 0 }, _cycleInterval{ 0 };
 	};
 }
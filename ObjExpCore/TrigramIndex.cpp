@@ -0,0 +1,168 @@
+#include "pch.h"
+#include "TrigramIndex.h"
+#include <algorithm>
+#include <wctype.h>
+
+using namespace WinSys;
+
+namespace {
+	// purge removed documents once there are this many, or a quarter of the live ones
+	const size_t MinPurge = 1024;
+}
+
+std::wstring TrigramIndex::ToLower(std::wstring_view text) {
+	std::wstring lower(text);
+	for (auto& ch : lower)
+		ch = static_cast<wchar_t>(::towlower(ch));
+	return lower;
+}
+
+void TrigramIndex::GetTrigrams(const std::wstring& text, std::vector<Trigram>& trigrams) {
+	trigrams.clear();
+	if (text.size() < 3)
+		return;
+
+	trigrams.reserve(text.size() - 2);
+	for (size_t i = 0; i + 2 < text.size(); i++)
+		trigrams.push_back((Trigram)(uint16_t)text[i] << 32 | (Trigram)(uint16_t)text[i + 1] << 16 | (uint16_t)text[i + 2]);
+	std::sort(trigrams.begin(), trigrams.end());
+	trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+}
+
+TrigramIndex::DocId TrigramIndex::Add(std::wstring_view text) {
+	DocId id;
+	if (!_free.empty()) {
+		id = _free.back();
+		_free.pop_back();
+	}
+	else {
+		id = static_cast<DocId>(_docs.size());
+		_docs.emplace_back();
+	}
+
+	auto& doc = _docs[id];
+	doc.Text = ToLower(text);
+	doc.Live = true;
+	_count++;
+
+	std::vector<Trigram> trigrams;
+	GetTrigrams(doc.Text, trigrams);
+	for (auto t : trigrams)
+		_postings[t].push_back(id);
+	return id;
+}
+
+void TrigramIndex::Remove(DocId id) {
+	if (!IsValid(id))
+		return;
+
+	auto& doc = _docs[id];
+	doc.Live = false;
+	_count--;
+	// short texts are in no posting list, so can be reused right away
+	if (doc.Text.size() < 3) {
+		doc.Text.clear();
+		_free.push_back(id);
+		return;
+	}
+	_removed.push_back(id);
+	if (_removed.size() >= MinPurge && _removed.size() >= _count / 4)
+		Purge();
+}
+
+void TrigramIndex::Purge() {
+	// the trigrams of the removed documents, so only their posting lists are touched
+	std::vector<Trigram> trigrams, all;
+	for (auto id : _removed) {
+		GetTrigrams(_docs[id].Text, trigrams);
+		all.insert(all.end(), trigrams.begin(), trigrams.end());
+	}
+	std::sort(all.begin(), all.end());
+	all.erase(std::unique(all.begin(), all.end()), all.end());
+
+	for (auto t : all) {
+		auto it = _postings.find(t);
+		if (it == _postings.end())
+			continue;
+		auto& ids = it->second;
+		ids.erase(std::remove_if(ids.begin(), ids.end(), [&](auto id) { return !_docs[id].Live; }), ids.end());
+		if (ids.empty())
+			_postings.erase(it);
+	}
+
+	for (auto id : _removed) {
+		auto& text = _docs[id].Text;
+		text.clear();
+		text.shrink_to_fit();
+		_free.push_back(id);
+	}
+	_removed.clear();
+}
+
+void TrigramIndex::Clear() {
+	_docs.clear();
+	_postings.clear();
+	_removed.clear();
+	_free.clear();
+	_count = 0;
+}
+
+const std::wstring& TrigramIndex::GetText(DocId id) const {
+	static const std::wstring empty;
+	return IsValid(id) ? _docs[id].Text : empty;
+}
+
+bool TrigramIndex::IsValid(DocId id) const {
+	return id < _docs.size() && _docs[id].Live;
+}
+
+std::vector<TrigramIndex::DocId> TrigramIndex::Find(std::wstring_view text, size_t maxResults) const {
+	std::vector<DocId> result;
+	if (text.empty())
+		return result;
+
+	auto lower = ToLower(text);
+	auto full = [&]() {
+		return maxResults && result.size() >= maxResults;
+	};
+
+	if (lower.size() < 3) {
+		for (DocId id = 0; id < _docs.size() && !full(); id++)
+			if (_docs[id].Live && _docs[id].Text.find(lower) != std::wstring::npos)
+				result.push_back(id);
+		return result;
+	}
+
+	std::vector<Trigram> trigrams;
+	GetTrigrams(lower, trigrams);
+	const std::vector<DocId>* candidates = nullptr;
+	for (auto t : trigrams) {
+		auto it = _postings.find(t);
+		// a trigram no document has
+		if (it == _postings.end())
+			return result;
+		if (candidates == nullptr || it->second.size() < candidates->size())
+			candidates = &it->second;
+	}
+
+	for (auto id : *candidates) {
+		auto& doc = _docs[id];
+		if (doc.Live && doc.Text.find(lower) != std::wstring::npos) {
+			result.push_back(id);
+			if (full())
+				break;
+		}
+	}
+	return result;
+}
+
+size_t TrigramIndex::GetCount() const {
+	return _count;
+}
+
+TrigramIndexStats TrigramIndex::GetStats() const {
+	TrigramIndexStats stats{ _count, _postings.size(), 0, _removed.size() };
+	for (auto& [t, ids] : _postings)
+		stats.Postings += ids.size();
+	return stats;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+
+namespace WinSys {
+	struct TrigramIndexStats {
+		size_t Documents;
+		size_t Trigrams;
+		// total entries in all posting lists
+		size_t Postings;
+		// removed documents still referenced by posting lists
+		size_t Removed;
+	};
+
+	//
+	// case insensitive substring index over many short strings (names, paths, titles).
+	// each document is listed under every distinct 3 character sequence of its text; a query looks up
+	// the rarest trigram of the search text and verifies only the documents listed under it.
+	// queries shorter than 3 characters scan all documents.
+	// removed documents are purged from the posting lists in batches, after which their ids are reused.
+	// not thread safe; the owner serializes access
+	//
+
+	class TrigramIndex final {
+	public:
+		using DocId = uint32_t;
+		static constexpr DocId InvalidDoc = 0xffffffff;
+
+		DocId Add(std::wstring_view text);
+		void Remove(DocId id);
+		void Clear();
+
+		// the lowercased text of a live document
+		[[nodiscard]] const std::wstring& GetText(DocId id) const;
+		[[nodiscard]] bool IsValid(DocId id) const;
+
+		// documents containing text (case insensitive), up to maxResults (0 for all)
+		[[nodiscard]] std::vector<DocId> Find(std::wstring_view text, size_t maxResults = 0) const;
+
+		[[nodiscard]] size_t GetCount() const;
+		[[nodiscard]] TrigramIndexStats GetStats() const;
+
+	private:
+		using Trigram = uint64_t;
+
+		static std::wstring ToLower(std::wstring_view text);
+		static void GetTrigrams(const std::wstring& text, std::vector<Trigram>& trigrams);
+		void Purge();
+
+		struct Document {
+			std::wstring Text;
+			bool Live{ false };
+		};
+
+		std::vector<Document> _docs;
+		std::unordered_map<Trigram, std::vector<DocId>> _postings;
+		// removed, but still in posting lists
+		std::vector<DocId> _removed;
+		// purged, ready for reuse
+		std::vector<DocId> _free;
+		size_t _count{ 0 };
+	};
+}
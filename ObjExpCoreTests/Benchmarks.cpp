@@ -0,0 +1,369 @@
+#include "pch.h"
+#include "SnapshotCorpus.h"
+#include <ObjectManager.h>
+#include <PerfCounter.h>
+#include <Profiler.h>
+#include <ProcessHandlesTracker.h>
+#include <ProcessManager.h>
+#include <ProcessModuleTracker.h>
+#include <ProcessSnapshotParser.h>
+#include <SortHelper.h>
+#include <TextMatcher.h>
+#include <TrigramIndex.h>
+#include <psapi.h>
+#include <random>
+#include <unordered_set>
+#include <wctype.h>
+
+using namespace WinSys;
+
+//
+// rough timings of the optimized paths against the straightforward code they replaced,
+// on synthetic data the size of a busy server. run a Release build; the results print in msec
+//
+
+namespace {
+	template<typename Fn>
+	void Time(const char* name, int iterations, Fn&& fn) {
+		size_t count = 0;
+		auto start = PerfCounter::Now();
+		for (int i = 0; i < iterations; i++)
+			count += fn();
+		auto elapsed = PerfCounter::Now() - start;
+		printf("%-48s %9.3f msec/iteration (%zu)\n", name, elapsed / 10000.0 / iterations, count / iterations);
+	}
+
+	// a refresh of the live system, as the processes view does on every tick
+	void BenchmarkProcessManager() {
+		ProcessManager pm;
+		pm.EnumProcessesAndThreads();
+		Time("ProcessManager::EnumProcesses", 100, [&]() {
+			return pm.EnumProcesses();
+			});
+		Time("ProcessManager::EnumProcessesAndThreads", 100, [&]() {
+			return pm.EnumProcessesAndThreads();
+			});
+	}
+
+	// the processes view's rows: some columns are in the row, others in a side table looked up per row
+	struct SortRow {
+		uint32_t Id;
+		int32_t CPU;
+		size_t WorkingSet;
+	};
+
+	struct SortRowEx {
+		uint32_t IoPriority;
+	};
+
+	void BenchmarkSort() {
+		const uint32_t Rows = 5000;
+		std::vector<std::shared_ptr<SortRow>> rows;
+		std::unordered_map<SortRow*, SortRowEx> rowsEx;
+		for (uint32_t i = 0; i < Rows; i++) {
+			auto row = std::make_shared<SortRow>(SortRow{ 4 * (i + 1), (int32_t)(i * 7919 % 1000), (size_t)(i * 104729 % 100003) << 12 });
+			rowsEx[row.get()] = SortRowEx{ i * 31 % 7 };
+			rows.push_back(std::move(row));
+		}
+		std::shuffle(rows.begin(), rows.end(), std::mt19937(42));
+		auto unsorted = rows;
+		auto ex = [&](SortRow* row) -> SortRowEx& {
+			return rowsEx.find(row)->second;
+		};
+
+		// the comparator the view used: the column switch and lookups run on every comparison
+		auto compare = [&](int column) {
+			rows = unsorted;
+			std::sort(rows.begin(), rows.end(), [&](const auto& r1, const auto& r2) {
+				switch (column) {
+					case 0: return SortHelper::SortNumbers(r1->CPU, r2->CPU, false);
+					case 1: return SortHelper::SortNumbers(r1->WorkingSet, r2->WorkingSet, false);
+					case 2: return SortHelper::SortNumbers(ex(r1.get()).IoPriority, ex(r2.get()).IoPriority, true);
+				}
+				return false;
+				});
+			return rows.size();
+		};
+		auto byKey = [&](int column) {
+			rows = unsorted;
+			switch (column) {
+				case 0: SortHelper::SortByKey(rows, [](const auto& r) { return SortHelper::PackKey(r->CPU, false); }); break;
+				case 1: SortHelper::SortByKey(rows, [](const auto& r) { return SortHelper::PackKey(r->WorkingSet, false); }); break;
+				case 2: SortHelper::SortByKey(rows, [&](const auto& r) { return SortHelper::PackKey(ex(r.get()).IoPriority, true); }); break;
+			}
+			return rows.size();
+		};
+
+		// the target is under 1 msec per sort
+		// the I/O priority is looked up in the side table
+		static const char* const columns[] = { "CPU", "working set", "I/O priority" };
+		for (int column = 0; column < (int)_countof(columns); column++) {
+			char name[64];
+			sprintf_s(name, "comparator, 5000 rows by %s", columns[column]);
+			Time(name, 200, [&]() { return compare(column); });
+			sprintf_s(name, "SortByKey, 5000 rows by %s", columns[column]);
+			Time(name, 200, [&]() { return byKey(column); });
+		}
+	}
+
+	// synthetic counter streams through the rate pass: every metric of every entity set once per sample
+	void BenchmarkPerfCounter() {
+		const int Samples = 50;
+		for (uint32_t entities : { 5000u, 100000u }) {
+			PerfCounter counter;
+			for (uint32_t i = 0; i < entities; i++)
+				counter.AddEntity();
+
+			int64_t timestamp = 0, commitTime = 0;
+			uint64_t sample = 0;
+			char name[64];
+			sprintf_s(name, "PerfCounter sample (%u entities)", entities);
+			Time(name, Samples, [&]() {
+				sample++;
+				counter.Begin(timestamp += 10000000);
+				for (uint32_t i = 0; i < entities; i++)
+					for (uint32_t m = 0; m < (uint32_t)PerfMetric::COUNT; m++)
+						counter.Set(i, static_cast<PerfMetric>(m), sample * (i % 97 + m + 1));
+				auto start = PerfCounter::Now();
+				counter.Commit();
+				commitTime += PerfCounter::Now() - start;
+				return counter.GetEntityCount();
+				});
+			printf("%-48s %9.3f msec/iteration\n", "  of which Commit (deltas and rates)", commitTime / 10000.0 / Samples);
+		}
+	}
+
+	// the number of object names and module paths the search benchmarks run over
+	const size_t NameCount = 1000000;
+
+	// module paths and handle names, like the search indexes hold
+	std::vector<std::wstring> MakeTexts(size_t count) {
+		static const PCWSTR dirs[] = {
+			L"C:\\Windows\\System32\\", L"C:\\Program Files\\Common Files\\", L"\\Device\\HarddiskVolume3\\Users\\Public\\",
+			L"\\REGISTRY\\MACHINE\\SOFTWARE\\Classes\\", L"\\Sessions\\1\\BaseNamedObjects\\",
+		};
+		std::vector<std::wstring> texts;
+		texts.reserve(count);
+		for (size_t i = 0; i < count; i++)
+			texts.push_back(dirs[i % _countof(dirs)] + std::wstring(L"Component") + std::to_wstring(i * 7919 % 1000003) + L".dll");
+		return texts;
+	}
+
+	void BenchmarkTrigramIndex(const std::vector<std::wstring>& texts) {
+		TrigramIndex index;
+		auto start = PerfCounter::Now();
+		for (auto& text : texts)
+			index.Add(text);
+		printf("%-48s %9.3f msec (%zu names)\n", "TrigramIndex build", (PerfCounter::Now() - start) / 10000.0, texts.size());
+
+		Time("TrigramIndex::Find", 100, [&]() {
+			return index.Find(L"component1234").size();
+			});
+		Time("TrigramIndex::Find (common trigrams)", 100, [&]() {
+			return index.Find(L"system32\\component").size();
+			});
+	}
+
+	void BenchmarkTextMatcher(const std::vector<std::wstring>& texts) {
+		const std::wstring query(L"component1234");
+		Time("lowercase copy + find", 10, [&]() {
+			size_t found = 0;
+			for (auto& text : texts) {
+				auto lower = text;
+				for (auto& ch : lower)
+					ch = static_cast<wchar_t>(::towlower(ch));
+				found += lower.find(query) != std::wstring::npos;
+			}
+			return found;
+			});
+
+		TextMatcher matcher(query);
+		Time("TextMatcher::Contains", 10, [&]() {
+			size_t found = 0;
+			for (auto& text : texts)
+				found += matcher.Contains(text);
+			return found;
+			});
+	}
+
+	// 5000 processes, 100000 threads
+	void BenchmarkParser() {
+		std::vector<RecordedSnapshot> snapshots;
+		for (uint32_t i = 0; i < 4; i++)
+			snapshots.push_back(MakeSnapshot(5000, 20, i));
+		ProcessSnapshotParser parser;
+		int64_t timestamp = 0;
+		Time("ProcessSnapshotParser::Parse (5000 x 20)", 20, [&]() {
+			auto& snapshot = snapshots[timestamp / 10000000 % snapshots.size()];
+			timestamp += 10000000;
+			return parser.Parse(snapshot.Buffer.data(), snapshot.Buffer.size(), timestamp, false, true);
+			});
+	}
+
+	//
+	// a system wide module scan, as the DLL search does it: a new tracker per process, so only the shared image cache
+	// carries over. the first pass over the live processes starts with an empty cache, then 1000 scans reuse it
+	//
+	void BenchmarkModuleScan() {
+		std::vector<DWORD> pids(4096);
+		DWORD size;
+		if (!::EnumProcesses(pids.data(), (DWORD)(pids.size() * sizeof(DWORD)), &size))
+			return;
+		pids.resize(size / sizeof(DWORD));
+
+		auto scan = [&](size_t count) {
+			size_t modules = 0;
+			for (size_t i = 0; i < count; i++) {
+				ProcessModuleTracker tracker(pids[i % pids.size()]);
+				modules += tracker.EnumModules();
+			}
+			return modules;
+		};
+		auto printCacheStats = []() {
+			auto stats = ProcessModuleTracker::GetImageCacheStats();
+			printf("  image cache: %zu images, %llu hits, %llu misses\n", stats.Images, stats.Hits, stats.Misses);
+		};
+
+		auto start = PerfCounter::Now();
+		auto modules = scan(pids.size());
+		printf("%-48s %9.3f msec/process (%zu processes, %zu modules)\n", "module scan, empty image cache",
+			(PerfCounter::Now() - start) / 10000.0 / pids.size(), pids.size(), modules);
+		printCacheStats();
+
+		const size_t Processes = 1000;
+		start = PerfCounter::Now();
+		modules = scan(Processes);
+		printf("%-48s %9.3f msec/process (%zu modules)\n", "module scan, 1000 processes",
+			(PerfCounter::Now() - start) / 10000.0 / Processes, modules);
+		printCacheStats();
+	}
+
+	size_t GetWorkingSet() {
+		PROCESS_MEMORY_COUNTERS counters{ sizeof(counters) };
+		::GetProcessMemoryInfo(::GetCurrentProcess(), &counters, sizeof(counters));
+		return counters.WorkingSetSize;
+	}
+
+	//
+	// a handle table of a busy server (250000 handles to 62500 named objects), built as EnumHandlesAndObjects does:
+	// with pooled records and interned names, and with a make_shared record and a name of its own per handle as before.
+	// allocations are the operator new calls on this thread (see main.cpp); name buffers come from the CString heap.
+	// the pooled table is built first, as its chunks are never freed and would otherwise reuse the other table's memory
+	//
+	void BenchmarkHandleTable() {
+		const uint32_t Handles = 250000, HandlesPerObject = 4;
+
+		auto build = [&](bool pooled, const char* title) {
+			auto allocations = Profiler::GetThreadAllocations();
+			auto workingSet = GetWorkingSet();
+			auto start = PerfCounter::Now();
+
+			std::vector<std::shared_ptr<ObjectInfo>> objects;
+			std::vector<std::shared_ptr<HandleInfo>> handles;
+			objects.reserve(Handles / HandlesPerObject);
+			handles.reserve(Handles);
+			for (uint32_t i = 0; i < Handles; i++) {
+				if (i % HandlesPerObject == 0) {
+					auto object = pooled ? ObjectManager::CreateObjectInfo() : std::make_shared<ObjectInfo>();
+					object->Object = reinterpret_cast<PVOID>((ULONG_PTR)(i / HandlesPerObject + 1) * 64);
+					object->HandleCount = HandlesPerObject;
+					objects.push_back(std::move(object));
+				}
+				auto object = objects.back().get();
+
+				// a fresh string per handle, as the name query returns
+				CString name;
+				name.Format(L"\\Device\\HarddiskVolume3\\Data\\File%u.dat", i / HandlesPerObject);
+				auto hi = pooled ? ObjectManager::CreateHandleInfo() : std::make_shared<HandleInfo>();
+				hi->Object = object->Object;
+				hi->ProcessId = 4 * (i % 1000 + 1);
+				hi->HandleValue = 4 * (i / 1000 + 1);
+				hi->ObjectInfo = object;
+				hi->Name = pooled ? ObjectManager::InternName(name) : name;
+				if (object->Name.IsEmpty())
+					object->Name = hi->Name;
+				object->Handles.push_back(hi);
+				handles.push_back(std::move(hi));
+			}
+
+			// measured with the table alive, i.e. at its peak
+			printf("%-48s %9.3f msec, %llu allocations, working set +%lld KB\n", title, (PerfCounter::Now() - start) / 10000.0,
+				Profiler::GetThreadAllocations() - allocations, ((int64_t)GetWorkingSet() - (int64_t)workingSet) >> 10);
+		};
+
+		build(true, "handle table, 250000 handles (pooled)");
+		auto stats = ObjectManager::GetRecordStats();
+		printf("  handle pool: %zu bytes x %zu peak blocks in %zu chunks, %llu allocations\n",
+			stats.Handles.BlockSize, stats.Handles.PeakBlocks, stats.Handles.Chunks, stats.Handles.Allocations);
+		printf("  object pool: %zu bytes x %zu peak blocks in %zu chunks, %llu allocations\n",
+			stats.Objects.BlockSize, stats.Objects.PeakBlocks, stats.Objects.Chunks, stats.Objects.Allocations);
+		printf("  name pool: %zu names, %llu hits, %llu misses\n", stats.InternedNames, stats.InternHits, stats.InternMisses);
+
+		build(false, "handle table, 250000 handles (make_shared)");
+	}
+
+	// a refresh of a process with a huge handle table, where one handle in 100 was closed, reused or opened since the last one
+	void BenchmarkHandleDiff() {
+		const uint32_t Handles = 150000;
+		std::vector<HandleEntryInfo> before, after;
+		before.reserve(Handles);
+		after.reserve(Handles + Handles / 100);
+		for (uint32_t i = 0; i < Handles; i++) {
+			auto value = (HANDLE)(ULONG_PTR)(4 * (i + 1));
+			uint16_t type = i % 7 + 1;
+			before.push_back({ value, type });
+			if (i % 100 == 0)
+				continue;
+			after.push_back({ value, i % 100 == 50 ? (uint16_t)(type + 1) : type });
+		}
+		for (uint32_t i = Handles; i < Handles + Handles / 100; i++)
+			after.push_back({ (HANDLE)(ULONG_PTR)(4 * (i + 1)), 1 });
+
+		std::vector<HandleEntryInfo> opened, closed;
+		Time("DiffHandles, 150000 handles (sorted merge)", 100, [&]() {
+			opened.clear();
+			closed.clear();
+			ProcessHandlesTracker::DiffHandles(before, after, opened, closed);
+			return opened.size() + closed.size();
+			});
+
+		// the hash set the tracker kept before: copied on every refresh, each new handle looked up in it
+		struct Hash {
+			size_t operator()(const HandleEntryInfo& h) const {
+				return std::hash<HANDLE>()(h.HandleValue) ^ h.ObjectTypeIndex;
+			}
+		};
+		struct Equal {
+			bool operator()(const HandleEntryInfo& h1, const HandleEntryInfo& h2) const {
+				return h1.HandleValue == h2.HandleValue && h1.ObjectTypeIndex == h2.ObjectTypeIndex;
+			}
+		};
+		std::unordered_set<HandleEntryInfo, Hash, Equal> set(before.begin(), before.end());
+		Time("DiffHandles, 150000 handles (hash set)", 100, [&]() {
+			opened.clear();
+			closed.clear();
+			auto old = set;
+			for (auto& h : after)
+				if (old.erase(h) == 0)
+					opened.push_back(h);
+			closed.insert(closed.end(), old.begin(), old.end());
+			return opened.size() + closed.size();
+			});
+	}
+}
+
+void RunBenchmarks() {
+	BenchmarkProcessManager();
+	BenchmarkModuleScan();
+	// before the large corpora below grow the heap
+	BenchmarkHandleTable();
+	BenchmarkHandleDiff();
+	BenchmarkSort();
+	BenchmarkPerfCounter();
+
+	auto texts = MakeTexts(NameCount);
+	BenchmarkTrigramIndex(texts);
+	BenchmarkTextMatcher(texts);
+
+	BenchmarkParser();
+}
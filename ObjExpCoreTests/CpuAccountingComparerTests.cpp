@@ -0,0 +1,32 @@
+#include "pch.h"
+#include "Test.h"
+#include "SnapshotCorpus.h"
+#include <CpuAccountingComparer.h>
+
+using namespace WinSys;
+
+TEST(CpuAccountingComparer_ReplaysRecordedCycles) {
+	CpuAccountingComparer comparer;
+	for (uint32_t s = 0; s < 3; s++) {
+		auto snapshot = MakeSnapshot(5, 2, s);
+		// process 0 uses no time, but its threads (24 and 28) run between clock ticks
+		for (auto& cycles : snapshot.ThreadCycles)
+			if (cycles.ThreadId == 24 || cycles.ThreadId == 28)
+				cycles.Cycles = (s + 1) * 1000000ULL;
+		comparer.Add(snapshot.Buffer.data(), snapshot.Buffer.size(), snapshot.Timestamp, snapshot.Extended, ReplayThreadCycles(snapshot));
+	}
+
+	auto& c = comparer.GetComparison();
+	CHECK(c.Samples == 3);
+	// the first sample and the processes replaced in the others (1 and 2) have no CPU to compare
+	CHECK(c.Processes == 8);
+	CHECK(c.Threads == 16);
+	CHECK(c.ThreadsIdleByTime == 4);
+	// the process cycle times are in the snapshot, where process 0 has none
+	CHECK(c.ProcessesIdleByTime == 0);
+	CHECK(c.GetMeanThreadDifference() > 0);
+	CHECK(c.MaxThreadDifference >= c.GetMeanThreadDifference());
+
+	CHECK(comparer.GetTimeParser().GetCpuAccounting() == CpuAccounting::Time);
+	CHECK(comparer.GetCycleParser().GetCpuAccounting() == CpuAccounting::Cycles);
+}
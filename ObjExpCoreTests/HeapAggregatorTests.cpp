@@ -0,0 +1,54 @@
+#include "pch.h"
+#include "Test.h"
+#include <ProcessHeaps.h>
+
+using namespace WinSys;
+
+namespace {
+	ProcessHeapEntry Block(size_t address, size_t size, ProcessHeapEntryFlags flag = ProcessHeapEntryFlags::Fixed) {
+		return ProcessHeapEntry{ reinterpret_cast<void*>(address), size, flag };
+	}
+}
+
+TEST(HeapAggregator_TotalsAndHistogram) {
+	HeapAggregator aggregator;
+	aggregator.Add(Block(0x1000, 1));
+	aggregator.Add(Block(0x2000, 16));
+	aggregator.Add(Block(0x3000, 31, ProcessHeapEntryFlags::Moveable));
+	aggregator.Add(Block(0x4000, 4096, ProcessHeapEntryFlags::Free));
+
+	auto& summary = aggregator.GetSummary();
+	CHECK(summary.BusyBlocks == 3);
+	CHECK(summary.BusyBytes == 48);
+	CHECK(summary.FreeBlocks == 1);
+	CHECK(summary.FreeBytes == 4096);
+	CHECK(summary.Histogram[0] == 1);
+	// 16 and 31 are both in [16, 32)
+	CHECK(summary.Histogram[4] == 2);
+	// free blocks aren't in the histogram
+	CHECK(summary.Histogram[12] == 0);
+
+	aggregator.Reset();
+	CHECK(aggregator.GetSummary().BusyBlocks == 0);
+	CHECK(aggregator.GetSummary().Histogram[4] == 0);
+	CHECK(aggregator.GetLargestBlocks().empty());
+}
+
+TEST(HeapAggregator_LargestBlocks) {
+	HeapAggregator aggregator(3);
+	size_t sizes[] = { 50, 10, 70, 20, 90, 30, 60 };
+	size_t address = 0x10000;
+	for (auto size : sizes)
+		aggregator.Add(Block(address += 0x100, size));
+	aggregator.Add(Block(0x90000, 1000, ProcessHeapEntryFlags::Free));
+
+	auto largest = aggregator.GetLargestBlocks();
+	CHECK(largest.size() == 3);
+	CHECK(largest[0].BlockSize == 90 && largest[1].BlockSize == 70 && largest[2].BlockSize == 60);
+	CHECK(largest[0].Address == reinterpret_cast<void*>(0x10500));
+
+	HeapAggregator none(0);
+	none.Add(Block(0x1000, 100));
+	CHECK(none.GetLargestBlocks().empty());
+	CHECK(none.GetSummary().BusyBlocks == 1);
+}
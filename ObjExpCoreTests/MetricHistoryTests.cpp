@@ -0,0 +1,99 @@
+#include "pch.h"
+#include "Test.h"
+#include <MetricHistory.h>
+
+using namespace WinSys;
+
+namespace {
+	void Add(ThreadHistory& history, float cpu, float switches = 0) {
+		float values[] = { cpu, switches };
+		history.Add(values);
+	}
+}
+
+TEST(MetricHistory_RawLevelKeepsTheNewest) {
+	ThreadHistory history;
+	CHECK(history.GetCount() == 0);
+	CHECK(history.GetLast(ThreadHistoryMetric::CPU) == 0);
+
+	for (int i = 0; i < 100; i++)
+		Add(history, (float)i, (float)(i * 2));
+	CHECK(history.GetSamples() == 100);
+	CHECK(history.GetCount(0) == ThreadHistory::RawSize);
+	CHECK(history.GetLast(ThreadHistoryMetric::CPU) == 99);
+	CHECK(history.GetLast(ThreadHistoryMetric::ContextSwitchRate) == 198);
+
+	// oldest first
+	MetricRange points[ThreadHistory::RawSize];
+	CHECK(history.Get(ThreadHistoryMetric::CPU, 0, points, 3) == 3);
+	CHECK(points[0].Avg == 97 && points[1].Avg == 98 && points[2].Avg == 99);
+	CHECK(points[2].Min == 99 && points[2].Max == 99);
+	CHECK(history.Get(ThreadHistoryMetric::CPU, 0, points, ThreadHistory::RawSize) == ThreadHistory::RawSize);
+	CHECK(points[0].Avg == 100 - ThreadHistory::RawSize);
+}
+
+TEST(MetricHistory_Levels) {
+	ThreadHistory history;
+	const uint32_t factor = ThreadHistory::Factor;
+	for (uint32_t i = 0; i < factor * factor; i++)
+		Add(history, (float)(i % factor));
+
+	CHECK(history.GetCount(1) == factor);
+	CHECK(history.GetCount(2) == 1);
+
+	// each level 1 point covers 0..7
+	MetricRange point;
+	CHECK(history.Get(ThreadHistoryMetric::CPU, 1, &point, 1) == 1);
+	CHECK(point.Min == 0 && point.Max == factor - 1 && point.Avg == (factor - 1) / 2.0f);
+	CHECK(history.Get(ThreadHistoryMetric::CPU, 2, &point, 1) == 1);
+	CHECK(point.Min == 0 && point.Max == factor - 1 && point.Avg == (factor - 1) / 2.0f);
+
+	// a partial group isn't a point yet
+	Add(history, 100);
+	CHECK(history.GetCount(1) == factor);
+
+	// level capacities
+	for (uint32_t i = 0; i < 2 * factor * factor * ThreadHistory::Level2Size; i++)
+		Add(history, 1);
+	CHECK(history.GetCount(1) == ThreadHistory::Level1Size);
+	CHECK(history.GetCount(2) == ThreadHistory::Level2Size);
+}
+
+TEST(MetricHistory_Downsampled) {
+	ThreadHistory history;
+	MetricRange points[8];
+	CHECK(history.GetDownsampled(ThreadHistoryMetric::CPU, 16, points, 8) == 0);
+
+	for (int i = 0; i < 16; i++)
+		Add(history, (float)i);
+
+	// pairs of raw points merged
+	CHECK(history.GetDownsampled(ThreadHistoryMetric::CPU, 16, points, 8) == 8);
+	CHECK(points[0].Min == 0 && points[0].Max == 1 && points[0].Avg == 0.5f);
+	CHECK(points[7].Min == 14 && points[7].Max == 15);
+
+	// fewer points than the width are repeated
+	CHECK(history.GetDownsampled(ThreadHistoryMetric::CPU, 4, points, 8) == 8);
+	CHECK(points[0].Avg == 12 && points[1].Avg == 12 && points[7].Avg == 15);
+
+	// more samples than the raw level holds come from level 1
+	for (int i = 0; i < 200; i++)
+		Add(history, 5);
+	CHECK(history.GetDownsampled(ThreadHistoryMetric::CPU, 160, points, 4) == 4);
+	CHECK(points[3].Min == 5 && points[3].Max == 5);
+}
+
+TEST(MetricHistory_SummaryAndClear) {
+	ThreadHistory history;
+	Add(history, 1);
+	Add(history, 5);
+	Add(history, 3);
+	auto summary = history.GetSummary(ThreadHistoryMetric::CPU);
+	CHECK(summary.Min == 1 && summary.Max == 5 && summary.Avg == 3);
+	CHECK(history.GetSummary(ThreadHistoryMetric::CPU, 1).Max == 0);
+
+	history.Clear();
+	CHECK(history.GetCount() == 0 && history.GetSamples() == 0);
+	Add(history, 2);
+	CHECK(history.GetSummary(ThreadHistoryMetric::CPU).Min == 2);
+}
@@ -0,0 +1,90 @@
+#include "pch.h"
+#include "Test.h"
+#include <PerfCounter.h>
+
+using namespace WinSys;
+
+namespace {
+	// one second apart
+	const int64_t Second = 10000000;
+
+	void Sample(PerfCounter& counter, int64_t timestamp, std::initializer_list<std::pair<PerfCounter::Slot, uint64_t>> values) {
+		counter.Begin(timestamp);
+		for (auto& [slot, value] : values)
+			counter.Set(slot, PerfMetric::ReadBytes, value);
+		counter.Commit();
+	}
+}
+
+TEST(PerfCounter_DeltasAndRates) {
+	PerfCounter counter(4);
+	auto a = counter.AddEntity(), b = counter.AddEntity();
+	CHECK(counter.GetEntityCount() == 2);
+
+	Sample(counter, Second, { { a, 100 }, { b, 1000 } });
+	// a single sample has no delta
+	CHECK(counter.GetDelta(a, PerfMetric::ReadBytes) == 0);
+	CHECK(counter.GetValue(a, PerfMetric::ReadBytes) == 100);
+	CHECK(counter.GetInterval() == 0);
+
+	Sample(counter, 3 * Second, { { a, 300 }, { b, 1500 } });
+	CHECK(counter.GetInterval() == 2 * Second);
+	CHECK(counter.GetDelta(a, PerfMetric::ReadBytes) == 200);
+	CHECK(counter.GetRate(a, PerfMetric::ReadBytes) == 100);
+	CHECK(counter.GetDeltas(PerfMetric::ReadBytes)[b] == 500);
+	CHECK(counter.GetRates(PerfMetric::ReadBytes)[b] == 250);
+
+	Sample(counter, 4 * Second, { { a, 400 }, { b, 1600 } });
+	CHECK(counter.GetDelta(a, PerfMetric::ReadBytes, 2) == 300);
+	CHECK(counter.GetRate(a, PerfMetric::ReadBytes, 2) == 100);
+	CHECK(counter.GetDelta(a, PerfMetric::ReadBytes, 3) == 0);
+	// spans must be below the depth
+	CHECK(counter.GetDelta(a, PerfMetric::ReadBytes, 4) == 0);
+}
+
+TEST(PerfCounter_MissedSamplesAndCounterResets) {
+	PerfCounter counter(2);
+	auto a = counter.AddEntity(), b = counter.AddEntity();
+	Sample(counter, Second, { { a, 100 }, { b, 100 } });
+	// b missing: it starts over
+	Sample(counter, 2 * Second, { { a, 50 } });
+	CHECK(counter.GetSampleCount(b) == 0);
+	// a's counter went back
+	CHECK(counter.GetDelta(a, PerfMetric::ReadBytes) == 0);
+	CHECK(counter.GetDeltas(PerfMetric::ReadBytes)[a] == 0);
+
+	Sample(counter, 3 * Second, { { a, 80 }, { b, 200 } });
+	CHECK(counter.GetDelta(a, PerfMetric::ReadBytes) == 30);
+	CHECK(counter.GetDeltas(PerfMetric::ReadBytes)[b] == 0);
+	CHECK(counter.GetSampleCount(a) == counter.GetDepth());
+}
+
+TEST(PerfCounter_SlotsAreReused) {
+	PerfCounter counter;
+	auto a = counter.AddEntity();
+	auto b = counter.AddEntity();
+	Sample(counter, Second, { { a, 10 }, { b, 10 } });
+	Sample(counter, 2 * Second, { { a, 20 }, { b, 20 } });
+
+	counter.RemoveEntity(a);
+	CHECK(counter.GetEntityCount() == 1);
+	CHECK(counter.GetDeltas(PerfMetric::ReadBytes)[a] == 0);
+	auto c = counter.AddEntity();
+	CHECK(c == a);
+	CHECK(counter.GetSlotCount() == 2);
+	CHECK(counter.GetSampleCount(c) == 0);
+
+	// the new entity doesn't inherit the old values
+	Sample(counter, 3 * Second, { { c, 1000 }, { b, 30 } });
+	CHECK(counter.GetDelta(c, PerfMetric::ReadBytes) == 0);
+	CHECK(counter.GetDelta(b, PerfMetric::ReadBytes) == 10);
+}
+
+TEST(PerfCounter_NowIsMonotonic) {
+	auto first = PerfCounter::Now();
+	::Sleep(20);
+	auto second = PerfCounter::Now();
+	CHECK(second > first);
+	// 20 msec is at least 15 msec even with a coarse timer
+	CHECK(second - first >= 150000);
+}
@@ -0,0 +1,58 @@
+#include "pch.h"
+#include "Test.h"
+#include <ProcessHandlesTracker.h>
+
+using namespace WinSys;
+
+namespace {
+	HandleEntryInfo Handle(ULONG_PTR value, uint16_t type) {
+		return HandleEntryInfo{ (HANDLE)value, type };
+	}
+
+	bool Same(const std::vector<HandleEntryInfo>& handles, std::initializer_list<HandleEntryInfo> expected) {
+		if (handles.size() != expected.size())
+			return false;
+		size_t i = 0;
+		for (auto& h : expected) {
+			if (handles[i].HandleValue != h.HandleValue || handles[i].ObjectTypeIndex != h.ObjectTypeIndex)
+				return false;
+			i++;
+		}
+		return true;
+	}
+}
+
+TEST(ProcessHandlesTracker_DiffUnchanged) {
+	std::vector<HandleEntryInfo> handles{ Handle(4, 7), Handle(8, 7), Handle(0x10, 37) };
+	std::vector<HandleEntryInfo> opened, closed;
+	ProcessHandlesTracker::DiffHandles(handles, handles, opened, closed);
+	CHECK(opened.empty());
+	CHECK(closed.empty());
+}
+
+TEST(ProcessHandlesTracker_DiffOpenedAndClosed) {
+	std::vector<HandleEntryInfo> before{ Handle(4, 7), Handle(8, 7), Handle(0xc, 16), Handle(0x10, 37), Handle(0x20, 7) };
+	// 8 and 0x20 closed, 0x14 and 0x24 opened, 0xc reused for a file
+	std::vector<HandleEntryInfo> after{ Handle(4, 7), Handle(0xc, 37), Handle(0x10, 37), Handle(0x14, 16), Handle(0x24, 7) };
+	std::vector<HandleEntryInfo> opened, closed;
+	ProcessHandlesTracker::DiffHandles(before, after, opened, closed);
+	CHECK(Same(closed, { Handle(8, 7), Handle(0xc, 16), Handle(0x20, 7) }));
+	CHECK(Same(opened, { Handle(0xc, 37), Handle(0x14, 16), Handle(0x24, 7) }));
+
+	// the results are appended
+	ProcessHandlesTracker::DiffHandles(after, before, opened, closed);
+	CHECK(opened.size() == 6 && closed.size() == 6);
+}
+
+TEST(ProcessHandlesTracker_DiffEmpty) {
+	std::vector<HandleEntryInfo> handles{ Handle(4, 7), Handle(8, 7) }, empty;
+	std::vector<HandleEntryInfo> opened, closed;
+	ProcessHandlesTracker::DiffHandles(empty, handles, opened, closed);
+	CHECK(Same(opened, { Handle(4, 7), Handle(8, 7) }));
+	CHECK(closed.empty());
+
+	opened.clear();
+	ProcessHandlesTracker::DiffHandles(handles, empty, opened, closed);
+	CHECK(opened.empty());
+	CHECK(Same(closed, { Handle(4, 7), Handle(8, 7) }));
+}
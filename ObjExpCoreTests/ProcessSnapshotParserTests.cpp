@@ -0,0 +1,96 @@
+#include "pch.h"
+#include "Test.h"
+#include "SnapshotCorpus.h"
+#include <ProcessSnapshotParser.h>
+#include <ProcessSnapshotLayout.h>
+#include <ProcessInfo.h>
+#include <ThreadInfo.h>
+
+using namespace WinSys;
+
+namespace {
+	size_t Parse(ProcessSnapshotParser& parser, const RecordedSnapshot& snapshot, bool includeThreads = true) {
+		return parser.Parse(snapshot.Buffer.data(), snapshot.Buffer.size(), snapshot.Timestamp, snapshot.Extended, includeThreads);
+	}
+}
+
+TEST(ProcessSnapshotParser_FirstSnapshot) {
+	ProcessSnapshotParser parser;
+	CHECK(Parse(parser, MakeSnapshot(10, 3, 0)) == 10);
+	CHECK(parser.GetThreadCount() == 30);
+	CHECK(parser.GetNewProcesses().size() == 10);
+	CHECK(parser.GetNewThreads().size() == 30);
+	CHECK(parser.GetTerminatedProcesses().empty());
+
+	auto pi = parser.GetProcessById(12);
+	CHECK(pi != nullptr);
+	CHECK(pi->GetImageName() == L"process2.exe");
+	CHECK(pi->ThreadCount == 3 && pi->GetThreads().size() == 3);
+	CHECK(pi->ParentId == 4);
+	CHECK(pi->CPU == 0);
+	CHECK(pi->GetThreads()[0]->GetProcessImageName() == L"process2.exe");
+	CHECK(pi->GetThreads()[0]->ProcessId == 12);
+}
+
+TEST(ProcessSnapshotParser_Deltas) {
+	ProcessSnapshotParser parser;
+	Parse(parser, MakeSnapshot(10, 3, 0));
+	// process 1 is replaced in sample 1
+	auto replaced = parser.GetProcessById(8);
+	Parse(parser, MakeSnapshot(10, 3, 1));
+
+	CHECK(parser.GetProcessCount() == 10);
+	CHECK(parser.GetTerminatedProcesses().size() == 1 && parser.GetTerminatedProcesses()[0] == replaced);
+	CHECK(parser.GetNewProcesses().size() == 1 && parser.GetNewProcesses()[0]->Id == 8);
+	CHECK(parser.GetProcessById(8) != replaced);
+	CHECK(parser.GetTerminatedThreads().size() == 3);
+	CHECK(parser.GetNewThreads().size() == 3);
+
+	// each thread of process i uses i percent of a processor (CPU is in 1/10000 percent)
+	auto pi = parser.GetProcessById(20);
+	CHECK(pi->GetImageName() == L"process4.exe");
+	CHECK(pi->CPU == 3 * 4 * 10000);
+	for (auto& thread : pi->GetThreads())
+		CHECK(thread->CPU == 4 * 10000);
+	CHECK(parser.GetProcessById(8)->CPU == 0);
+
+	// the same, relative to all processors
+	ProcessSnapshotParser parser4(4);
+	Parse(parser4, MakeSnapshot(10, 3, 0));
+	Parse(parser4, MakeSnapshot(10, 3, 1));
+	CHECK(parser4.GetProcessById(20)->CPU == 3 * 10000);
+
+	auto history = parser.GetProcessHistory(pi->Key);
+	CHECK(history != nullptr && history->GetCount() == 2);
+	CHECK(history->GetLast(ProcessHistoryMetric::CPU) == 12.0f);
+}
+
+TEST(ProcessSnapshotParser_WithoutThreads) {
+	ProcessSnapshotParser parser;
+	Parse(parser, MakeSnapshot(5, 4, 0), false);
+	CHECK(parser.GetProcessCount() == 5);
+	CHECK(parser.GetThreadCount() == 0);
+	CHECK(parser.GetProcessById(4)->ThreadCount == 4);
+}
+
+TEST(ProcessSnapshotParser_MalformedBuffers) {
+	auto snapshot = MakeSnapshot(10, 3, 0);
+	ProcessSnapshotParser parser;
+	CHECK(parser.Parse(snapshot.Buffer.data(), 16, snapshot.Timestamp, false, true) == 0);
+
+	// a truncated buffer stops at the first process that doesn't fit
+	CHECK(parser.Parse(snapshot.Buffer.data(), snapshot.Buffer.size() / 2, snapshot.Timestamp, false, true) < 10);
+
+	// a name outside the buffer is ignored
+	auto second = reinterpret_cast<SnapshotProcess*>(snapshot.Buffer.data() + reinterpret_cast<SnapshotProcess*>(snapshot.Buffer.data())->NextEntryOffset);
+	second->ImageName.Length = 0x8000;
+	// as is a thread count past the end
+	auto last = snapshot.Buffer.data();
+	while (reinterpret_cast<SnapshotProcess*>(last)->NextEntryOffset)
+		last += reinterpret_cast<SnapshotProcess*>(last)->NextEntryOffset;
+	reinterpret_cast<SnapshotProcess*>(last)->NumberOfThreads = 1000;
+
+	ProcessSnapshotParser parser2;
+	CHECK(Parse(parser2, snapshot) == 9);
+	CHECK(parser2.GetProcessById(8)->GetImageName().empty());
+}
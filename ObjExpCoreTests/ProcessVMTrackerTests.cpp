@@ -0,0 +1,134 @@
+#include "pch.h"
+#include "Test.h"
+#include <ProcessVMTracker.h>
+
+using namespace WinSys;
+
+namespace {
+	MEMORY_BASIC_INFORMATION Region(ULONG_PTR base, SIZE_T size, DWORD state, DWORD protect = PAGE_READWRITE) {
+		MEMORY_BASIC_INFORMATION mbi{};
+		mbi.BaseAddress = mbi.AllocationBase = (PVOID)base;
+		mbi.RegionSize = size;
+		mbi.State = state;
+		mbi.Protect = state == MEM_COMMIT ? protect : 0;
+		mbi.Type = state == MEM_FREE ? 0 : MEM_PRIVATE;
+		return mbi;
+	}
+
+	// a recorded address space: free, a reserved stack with its committed top, an image and free to the end
+	std::vector<MEMORY_BASIC_INFORMATION> Recorded() {
+		return {
+			Region(0, 0x10000, MEM_FREE),
+			Region(0x10000, 0xf0000, MEM_RESERVE),
+			Region(0x100000, 0x10000, MEM_COMMIT),
+			Region(0x110000, 0x10000, MEM_COMMIT, PAGE_READONLY),
+			Region(0x120000, 0x7ffe0000, MEM_FREE),
+		};
+	}
+
+	size_t IndexOf(const ProcessVMTracker& tracker, ULONG_PTR base) {
+		auto& regions = tracker.GetRegions();
+		for (size_t i = 0; i < regions.size(); i++)
+			if (regions[i]->BaseAddress == (PVOID)base)
+				return i;
+		return (size_t)-1;
+	}
+}
+
+TEST(ProcessVMTracker_ReplayUnchanged) {
+	ProcessVMTracker tracker(HANDLE(nullptr));
+	CHECK(tracker.Update(Recorded()) == 5);
+	// nothing is new in the first list
+	CHECK(tracker.GetNewRegions().empty());
+	CHECK(tracker.GetOldRegions().empty());
+
+	auto first = tracker.GetRegions();
+	CHECK(tracker.Update(Recorded()) == 5);
+	CHECK(tracker.GetNewRegions().empty());
+	CHECK(tracker.GetOldRegions().empty());
+	for (size_t i = 0; i < first.size(); i++)
+		CHECK(tracker.GetRegions()[i] == first[i]);
+}
+
+TEST(ProcessVMTracker_ChangesAtTheSameBase) {
+	ProcessVMTracker tracker(HANDLE(nullptr));
+	tracker.Update(Recorded());
+	auto stack = tracker.GetRegions()[2];
+	auto reserved = tracker.GetRegions()[1];
+	auto image = tracker.GetRegions()[3];
+
+	// the image made writable: a new region at the same base replaces the old one
+	auto regions = Recorded();
+	regions[3].Protect = PAGE_READWRITE;
+	CHECK(tracker.Update(regions) == 5);
+	CHECK(tracker.GetOldRegions().size() == 1 && tracker.GetOldRegions()[0] == image);
+	CHECK(tracker.GetNewRegions().size() == 1 && tracker.GetNewRegions()[0]->BaseAddress == (PVOID)0x110000);
+	CHECK(tracker.GetNewRegions()[0]->Protect == PAGE_READWRITE);
+	CHECK(tracker.GetRegions()[3] == tracker.GetNewRegions()[0]);
+	CHECK(tracker.GetRegions()[2] == stack);
+
+	// the stack grows: the reserved part shrinks (kept, with its new size) and a committed region appears below the old one,
+	// which is kept as well
+	regions.insert(regions.begin() + 2, Region(0xf0000, 0x10000, MEM_COMMIT));
+	regions[1].RegionSize = 0xe0000;
+	CHECK(tracker.Update(regions) == 6);
+	CHECK(tracker.GetOldRegions().empty());
+	CHECK(tracker.GetNewRegions().size() == 1 && tracker.GetNewRegions()[0]->BaseAddress == (PVOID)0xf0000);
+	CHECK(tracker.GetRegions()[1] == reserved && reserved->RegionSize == 0xe0000);
+	CHECK(tracker.GetRegions()[3] == stack);
+
+	// the reserved part committed: a state change at the same base
+	regions[1] = Region(0x10000, 0xe0000, MEM_COMMIT);
+	CHECK(tracker.Update(regions) == 6);
+	CHECK(tracker.GetOldRegions().size() == 1 && tracker.GetOldRegions()[0] == reserved);
+	CHECK(tracker.GetNewRegions().size() == 1 && tracker.GetNewRegions()[0]->State == MEM_COMMIT);
+	CHECK(IndexOf(tracker, 0x10000) == 1);
+}
+
+TEST(ProcessVMTracker_RegionsFreed) {
+	ProcessVMTracker tracker(HANDLE(nullptr));
+	tracker.Update(Recorded());
+
+	// the stack released: its three regions merge into the free region before them
+	std::vector<MEMORY_BASIC_INFORMATION> regions{
+		Region(0, 0x110000, MEM_FREE),
+		Region(0x110000, 0x10000, MEM_COMMIT, PAGE_READONLY),
+		Region(0x120000, 0x7ffe0000, MEM_FREE),
+	};
+	CHECK(tracker.Update(regions) == 3);
+	CHECK(tracker.GetOldRegions().size() == 2);
+	CHECK(tracker.GetNewRegions().empty());
+	CHECK(tracker.GetRegions()[0]->RegionSize == 0x110000);
+
+	// the last region gone as well (a list cut short)
+	regions.pop_back();
+	CHECK(tracker.Update(regions) == 2);
+	CHECK(tracker.GetOldRegions().size() == 1 && tracker.GetOldRegions()[0]->BaseAddress == (PVOID)0x120000);
+}
+
+TEST(ProcessVMTracker_ReplayLiveRecording) {
+	// this process's regions, recorded once and replayed
+	std::vector<MEMORY_BASIC_INFORMATION> regions;
+	MEMORY_BASIC_INFORMATION mbi;
+	const BYTE* address = nullptr;
+	while (::VirtualQuery(address, &mbi, sizeof(mbi))) {
+		regions.push_back(mbi);
+		address += mbi.RegionSize;
+	}
+	CHECK(regions.size() > 10);
+
+	ProcessVMTracker tracker(HANDLE(nullptr));
+	CHECK(tracker.Update(regions) == regions.size());
+	CHECK(tracker.Update(regions) == regions.size());
+	CHECK(tracker.GetNewRegions().empty() && tracker.GetOldRegions().empty());
+
+	// every other committed region changes protection
+	int changed = 0;
+	for (auto& region : regions)
+		if (region.State == MEM_COMMIT && changed++ % 2 == 0)
+			region.Protect ^= PAGE_GUARD;
+	CHECK(tracker.Update(regions) == regions.size());
+	auto expected = (size_t)(changed + 1) / 2;
+	CHECK(tracker.GetNewRegions().size() == expected);
+	CHECK(tracker.GetOldRegions().size() == expected);
+}
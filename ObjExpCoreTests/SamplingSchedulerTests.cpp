@@ -0,0 +1,216 @@
+#include "pch.h"
+#include "Test.h"
+#include <SamplingScheduler.h>
+#include <atomic>
+
+using namespace WinSys;
+
+//
+// the scheduler runs on real thread pool timers, so these use short intervals and wait
+// for what should happen with a generous timeout, checking what must not happen after a settle time
+//
+
+namespace {
+	template<typename F>
+	bool WaitFor(F&& condition, DWORD timeout = 5000) {
+		auto start = ::GetTickCount64();
+		while (!condition()) {
+			if (::GetTickCount64() - start > timeout)
+				return false;
+			::Sleep(1);
+		}
+		return true;
+	}
+
+	uint64_t GetSamples(const SamplingScheduler& scheduler, uint32_t id) {
+		SamplerStats stats{};
+		scheduler.GetStats(id, stats);
+		return stats.Samples;
+	}
+
+	wil::unique_handle CreateManualEvent() {
+		return wil::unique_handle(::CreateEvent(nullptr, TRUE, FALSE, nullptr));
+	}
+}
+
+TEST(SamplingScheduler_Interval) {
+	SamplingScheduler scheduler;
+	std::atomic<int> samples{ 0 };
+	// the first sample is taken right away, the next not before the interval
+	auto id = scheduler.AddProvider([&] { samples++; }, 10000);
+	CHECK(id != 0);
+	CHECK(WaitFor([&] { return samples == 1; }));
+	::Sleep(200);
+	CHECK(samples == 1);
+
+	auto fast = scheduler.AddProvider([] {}, 20);
+	CHECK(WaitFor([&] { return GetSamples(scheduler, fast) >= 5; }));
+	CHECK(scheduler.GetProviderCount() == 2);
+
+	SamplerStats stats{};
+	CHECK(scheduler.GetStats(fast, stats));
+	CHECK(stats.Interval == 20 && stats.CurrentInterval == 20 && !stats.Paused);
+	CHECK(!scheduler.GetStats(12345, stats));
+
+	// a new interval applies from the next sample
+	CHECK(scheduler.SetInterval(id, 20));
+	CHECK(WaitFor([&] { return samples >= 3; }));
+}
+
+TEST(SamplingScheduler_BackoffAndSpike) {
+	SamplingScheduler scheduler;
+	std::atomic<SampleActivity> activity{ SampleActivity::Unchanged };
+	std::atomic<uint32_t> maxSeen{ 0 };
+	auto id = scheduler.AddAdaptiveProvider([&] { return activity.load(); }, 10, 80);
+
+	auto current = [&] {
+		SamplerStats stats{};
+		scheduler.GetStats(id, stats);
+		if (stats.CurrentInterval > maxSeen)
+			maxSeen = stats.CurrentInterval;
+		return stats.CurrentInterval;
+	};
+	// unchanged samples double the interval up to the maximum
+	CHECK(WaitFor([&] { return current() == 80; }));
+	::Sleep(300);
+	CHECK(current() == 80);
+	CHECK(maxSeen == 80);
+
+	// a spike samples at the base interval again (the boost interval is never longer than it)
+	activity = SampleActivity::Spike;
+	CHECK(WaitFor([&] { return current() == 10; }));
+
+	// changes keep it there
+	activity = SampleActivity::Changed;
+	auto samples = GetSamples(scheduler, id);
+	CHECK(WaitFor([&] { return GetSamples(scheduler, id) >= samples + 10; }));
+	CHECK(current() == 10);
+
+	// a provider without back off never changes its interval
+	auto fixed = scheduler.AddProvider([] {}, 10);
+	CHECK(WaitFor([&] { return GetSamples(scheduler, fixed) >= 5; }));
+	SamplerStats stats{};
+	scheduler.GetStats(fixed, stats);
+	CHECK(stats.CurrentInterval == 10);
+}
+
+TEST(SamplingScheduler_PauseResume) {
+	SamplingScheduler scheduler;
+	std::atomic<int> samples{ 0 };
+	auto id = scheduler.AddProvider([&] { samples++; }, 20, true);
+	::Sleep(200);
+	CHECK(samples == 0);
+	// a paused provider can't be sampled on demand
+	CHECK(!scheduler.SampleNow(id));
+
+	// resuming samples right away, even with a long interval
+	CHECK(scheduler.SetInterval(id, 10000));
+	CHECK(scheduler.Pause(id, false));
+	CHECK(WaitFor([&] { return samples == 1; }, 1000));
+
+	CHECK(scheduler.SetInterval(id, 20));
+	CHECK(WaitFor([&] { return samples >= 3; }));
+	CHECK(scheduler.Pause(id, true));
+	// a sample may have been running when paused
+	::Sleep(100);
+	auto paused = samples.load();
+	::Sleep(200);
+	CHECK(samples == paused);
+
+	SamplerStats stats{};
+	scheduler.GetStats(id, stats);
+	CHECK(stats.Paused);
+
+	// suspending stops every provider; resuming samples the unpaused ones right away
+	CHECK(scheduler.Pause(id, false));
+	CHECK(WaitFor([&] { return samples > paused; }));
+	scheduler.Suspend(true);
+	CHECK(scheduler.IsSuspended());
+	::Sleep(100);
+	auto suspended = samples.load();
+	::Sleep(200);
+	CHECK(samples == suspended);
+	scheduler.Suspend(false);
+	CHECK(WaitFor([&] { return samples > suspended; }));
+}
+
+TEST(SamplingScheduler_RemoveWaitsForRunningSample) {
+	SamplingScheduler scheduler;
+	auto started = CreateManualEvent();
+	std::atomic<bool> done{ false };
+	std::atomic<int> samples{ 0 };
+	auto id = scheduler.AddProvider([&] {
+		samples++;
+		::SetEvent(started.get());
+		::Sleep(200);
+		done = true;
+		}, 10);
+
+	CHECK(::WaitForSingleObject(started.get(), 5000) == WAIT_OBJECT_0);
+	CHECK(scheduler.RemoveProvider(id));
+	// the sample completed before the provider (and what it captures) went away
+	CHECK(done);
+	auto removed = samples.load();
+	::Sleep(100);
+	CHECK(samples == removed);
+	CHECK(scheduler.GetProviderCount() == 0);
+	CHECK(!scheduler.RemoveProvider(id));
+	CHECK(!scheduler.SampleNow(id));
+}
+
+TEST(SamplingScheduler_SamplesNeverOverlap) {
+	SamplingScheduler scheduler;
+	auto release = CreateManualEvent();
+	auto started = CreateManualEvent();
+	std::atomic<int> running{ 0 }, maxRunning{ 0 }, samples{ 0 };
+	auto id = scheduler.AddProvider([&] {
+		auto now = ++running;
+		if (now > maxRunning)
+			maxRunning = now;
+		if (samples++ == 0) {
+			::SetEvent(started.get());
+			::WaitForSingleObject(release.get(), 5000);
+		}
+		else {
+			::Sleep(5);
+		}
+		running--;
+		}, 10000);
+
+	// requests made while the first sample runs are left to it (Running / Rearm)
+	CHECK(::WaitForSingleObject(started.get(), 5000) == WAIT_OBJECT_0);
+	for (int i = 0; i < 20; i++) {
+		CHECK(scheduler.SampleNow(id));
+		::Sleep(1);
+	}
+	CHECK(samples == 1);
+	// so one more sample follows it right away, not after the interval
+	::SetEvent(release.get());
+	CHECK(WaitFor([&] { return samples == 2; }, 1000));
+	::Sleep(200);
+	CHECK(samples == 2);
+
+	// a short interval with sample requests and interval changes from other threads
+	CHECK(scheduler.SetInterval(id, 1));
+	auto hammer = [](PVOID context) -> DWORD {
+		auto args = static_cast<std::pair<SamplingScheduler*, uint32_t>*>(context);
+		for (int i = 0; i < 200; i++) {
+			args->first->SampleNow(args->second);
+			if (i % 50 == 0)
+				args->first->SetInterval(args->second, 1 + i % 3);
+			::Sleep(0);
+		}
+		return 0;
+	};
+	std::pair<SamplingScheduler*, uint32_t> args{ &scheduler, id };
+	wil::unique_handle threads[4];
+	for (auto& h : threads)
+		h.reset(::CreateThread(nullptr, 0, hammer, &args, 0, nullptr));
+	for (auto& h : threads)
+		CHECK(h && ::WaitForSingleObject(h.get(), 10000) == WAIT_OBJECT_0);
+
+	CHECK(WaitFor([&] { return samples >= 20; }));
+	CHECK(scheduler.RemoveProvider(id));
+	CHECK(maxRunning == 1);
+	CHECK(running == 0);
+}
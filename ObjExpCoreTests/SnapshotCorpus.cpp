@@ -0,0 +1,280 @@
+#include "pch.h"
+#include "SnapshotCorpus.h"
+#include <CpuAccountingComparer.h>
+#include <ProcessSnapshot.h>
+#include <ProcessSnapshotLayout.h>
+#include <ProcessSnapshotParser.h>
+#include <PerfCounter.h>
+#include <ThreadInfo.h>
+#include <strsafe.h>
+
+using namespace WinSys;
+
+namespace {
+	const uint32_t SnapshotMagic = 'PANS';
+	const uint16_t SnapshotVersion = 2;
+
+	struct SnapshotFileHeader {
+		uint32_t Magic;
+		uint16_t Version;
+		uint16_t PointerSize;
+		uint32_t Extended;
+		// RecordedThreadCycles records following the buffer
+		uint32_t ThreadCycles;
+		int64_t Timestamp;
+		// address of the buffer when captured, to move the pointers into it on load
+		uint64_t Base;
+		uint64_t Size;
+	};
+
+	void Relocate(RecordedSnapshot& snapshot, uint64_t base) {
+		auto begin = snapshot.Buffer.data();
+		auto size = snapshot.Buffer.size();
+		size_t offset = 0;
+		while (offset + SnapshotThreadsOffset <= size) {
+			auto p = reinterpret_cast<SnapshotProcess*>(begin + offset);
+			auto& name = p->ImageName.Buffer;
+			if (name >= base && name - base < size)
+				name = name - base + reinterpret_cast<uintptr_t>(begin);
+			if (p->NextEntryOffset == 0)
+				break;
+			offset += p->NextEntryOffset;
+		}
+	}
+
+	size_t AlignUp(size_t size) {
+		return (size + 7) & ~size_t(7);
+	}
+}
+
+bool SaveSnapshot(PCWSTR path, const void* buffer, size_t size, int64_t timestamp, bool extended, const std::vector<RecordedThreadCycles>& threadCycles) {
+	wil::unique_hfile hFile(::CreateFile(path, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, 0, nullptr));
+	if (!hFile)
+		return false;
+
+	SnapshotFileHeader header{ SnapshotMagic, SnapshotVersion, sizeof(void*), extended, (uint32_t)threadCycles.size(), timestamp, (uint64_t)buffer, size };
+	auto cyclesSize = (DWORD)(threadCycles.size() * sizeof(RecordedThreadCycles));
+	DWORD bytes;
+	return ::WriteFile(hFile.get(), &header, sizeof(header), &bytes, nullptr) &&
+		::WriteFile(hFile.get(), buffer, (DWORD)size, &bytes, nullptr) && bytes == size &&
+		::WriteFile(hFile.get(), threadCycles.data(), cyclesSize, &bytes, nullptr) && bytes == cyclesSize;
+}
+
+bool LoadSnapshot(PCWSTR path, RecordedSnapshot& snapshot) {
+	wil::unique_hfile hFile(::CreateFile(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, 0, nullptr));
+	if (!hFile)
+		return false;
+
+	SnapshotFileHeader header;
+	DWORD bytes;
+	if (!::ReadFile(hFile.get(), &header, sizeof(header), &bytes, nullptr) || bytes != sizeof(header))
+		return false;
+	// recorded by a build of another bitness
+	if (header.Magic != SnapshotMagic || header.Version != SnapshotVersion || header.PointerSize != sizeof(void*))
+		return false;
+
+	snapshot.Buffer.resize((size_t)header.Size);
+	if (!::ReadFile(hFile.get(), snapshot.Buffer.data(), (DWORD)header.Size, &bytes, nullptr) || bytes != header.Size)
+		return false;
+	snapshot.ThreadCycles.resize(header.ThreadCycles);
+	auto cyclesSize = (DWORD)(header.ThreadCycles * sizeof(RecordedThreadCycles));
+	if (!::ReadFile(hFile.get(), snapshot.ThreadCycles.data(), cyclesSize, &bytes, nullptr) || bytes != cyclesSize)
+		return false;
+
+	snapshot.Timestamp = header.Timestamp;
+	snapshot.Extended = header.Extended != 0;
+	Relocate(snapshot, header.Base);
+	return true;
+}
+
+std::vector<RecordedSnapshot> LoadCorpus(PCWSTR directory) {
+	std::vector<std::wstring> names;
+	WIN32_FIND_DATA data;
+	wil::unique_hfind hFind(::FindFirstFile((std::wstring(directory) + L"\\*.snap").c_str(), &data));
+	if (hFind) {
+		do {
+			names.push_back(data.cFileName);
+		} while (::FindNextFile(hFind.get(), &data));
+	}
+	// named in capture order
+	std::sort(names.begin(), names.end());
+
+	std::vector<RecordedSnapshot> corpus;
+	corpus.reserve(names.size());
+	for (auto& name : names) {
+		RecordedSnapshot snapshot;
+		if (LoadSnapshot((std::wstring(directory) + L"\\" + name).c_str(), snapshot))
+			corpus.push_back(std::move(snapshot));
+		else
+			printf("Skipped %ws\n", name.c_str());
+	}
+	return corpus;
+}
+
+RecordedSnapshot MakeSnapshot(uint32_t processes, uint32_t threadsPerProcess, uint32_t sample) {
+	const int64_t Second = 10000000;
+	// one percent of a second
+	const int64_t Percent = Second / 100;
+
+	auto nameSize = [](uint32_t i) {
+		return AlignUp((std::to_wstring(i).size() + 12) * sizeof(wchar_t));
+	};
+	auto recordSize = [&](uint32_t i) {
+		return SnapshotThreadsOffset + threadsPerProcess * sizeof(SnapshotExtendedThread) + nameSize(i);
+	};
+
+	size_t size = 0;
+	for (uint32_t i = 0; i < processes; i++)
+		size += recordSize(i);
+
+	RecordedSnapshot snapshot;
+	snapshot.Buffer.resize(size);
+	snapshot.Timestamp = (sample + 1) * Second;
+	snapshot.Extended = false;
+
+	size_t offset = 0;
+	for (uint32_t i = 0; i < processes; i++) {
+		auto p = reinterpret_cast<SnapshotProcess*>(snapshot.Buffer.data() + offset);
+		auto pid = 4 * (i + 1);
+		// the last sample the process was replaced in, if any
+		auto replaced = sample >= i % 100 ? sample - (sample - i % 100) % 100 : 0;
+		auto created = (int64_t)replaced * Second + i;
+		// the time used since the process was created
+		auto elapsed = (int64_t)(sample - replaced) * Second;
+		auto threadTime = elapsed / Second * i * Percent;
+
+		p->NextEntryOffset = i + 1 < processes ? (uint32_t)recordSize(i) : 0;
+		p->NumberOfThreads = threadsPerProcess;
+		p->NumberOfThreadsHighWatermark = threadsPerProcess;
+		p->CreateTime = created;
+		p->KernelTime = threadTime * threadsPerProcess;
+		p->CycleTime = p->KernelTime * 300;
+		p->BasePriority = 8;
+		p->UniqueProcessId = pid;
+		p->InheritedFromUniqueProcessId = i ? 4 : 0;
+		p->HandleCount = 100 + i;
+		p->SessionId = 1;
+		p->WorkingSetSize = p->PrivatePageCount = (size_t)(i + 1) << 20;
+		p->ReadTransferCount = elapsed / Second * 4096;
+
+		for (uint32_t t = 0; t < threadsPerProcess; t++) {
+			auto& thread = p->Threads[t].ThreadInfo;
+			thread.CreateTime = created;
+			thread.KernelTime = threadTime;
+			thread.UniqueProcess = pid;
+			thread.UniqueThread = 4 * (processes + i * threadsPerProcess + t + 1);
+			thread.Priority = thread.BasePriority = 8;
+			thread.ContextSwitches = (uint32_t)(elapsed / Second * 10);
+			snapshot.ThreadCycles.push_back({ (uint32_t)thread.UniqueThread, 0, (uint64_t)threadTime * 300, snapshot.Timestamp });
+		}
+
+		auto name = reinterpret_cast<wchar_t*>(reinterpret_cast<uint8_t*>(p) + SnapshotThreadsOffset + threadsPerProcess * sizeof(SnapshotExtendedThread));
+		auto text = L"process" + std::to_wstring(i) + L".exe";
+		::memcpy(name, text.c_str(), text.size() * sizeof(wchar_t));
+		p->ImageName.Length = p->ImageName.MaximumLength = (uint16_t)(text.size() * sizeof(wchar_t));
+		p->ImageName.Buffer = reinterpret_cast<uintptr_t>(name);
+		offset += recordSize(i);
+	}
+	return snapshot;
+}
+
+ProcessSnapshotParser::ThreadCycleQuery ReplayThreadCycles(const RecordedSnapshot& snapshot) {
+	std::unordered_map<uint32_t, const RecordedThreadCycles*> threads;
+	threads.reserve(snapshot.ThreadCycles.size());
+	for (auto& cycles : snapshot.ThreadCycles)
+		threads.insert({ cycles.ThreadId, &cycles });
+
+	return [threads = std::move(threads)](const ThreadInfo& thread, uint64_t& cycles, int64_t& timestamp) {
+		auto it = threads.find(thread.Id);
+		if (it == threads.end())
+			return false;
+		cycles = it->second->Cycles;
+		timestamp = it->second->Timestamp;
+		return true;
+	};
+}
+
+int RecordCorpus(PCWSTR directory, int count) {
+	::CreateDirectory(directory, nullptr);
+	ProcessSnapshot snapshot;
+	ProcessSnapshotParser parser;
+	std::vector<RecordedThreadCycles> threadCycles;
+	for (int i = 0; i < count; i++) {
+		if (i > 0)
+			::Sleep(1000);
+		if (!snapshot.Capture()) {
+			printf("Failed to capture a snapshot (%u)\n", ::GetLastError());
+			return 1;
+		}
+
+		// read right after the snapshot, as ProcessManager does in the cycle mode
+		threadCycles.clear();
+		parser.Parse(snapshot.GetBuffer(), snapshot.GetSize(), snapshot.GetTimestamp(), snapshot.IsExtended(), true);
+		for (auto& thread : parser.GetThreads()) {
+			wil::unique_handle hThread(::OpenThread(THREAD_QUERY_LIMITED_INFORMATION, FALSE, thread->Id));
+			FILETIME created, dummy;
+			uint64_t cycles;
+			// the id may already belong to another thread
+			if (hThread && ::GetThreadTimes(hThread.get(), &created, &dummy, &dummy, &dummy) &&
+				*(int64_t*)&created == thread->Key.Created && ::QueryThreadCycleTime(hThread.get(), &cycles))
+				threadCycles.push_back({ thread->Id, 0, cycles, PerfCounter::Now() });
+		}
+
+		WCHAR path[MAX_PATH];
+		::StringCchPrintf(path, _countof(path), L"%s\\snapshot-%04d.snap", directory, i);
+		if (!SaveSnapshot(path, snapshot.GetBuffer(), snapshot.GetSize(), snapshot.GetTimestamp(), snapshot.IsExtended(), threadCycles)) {
+			printf("Failed to write %ws (%u)\n", path, ::GetLastError());
+			return 1;
+		}
+		auto& summary = snapshot.GetSummary();
+		printf("%ws: %u processes, %u threads, %zu thread cycle times\n", path, summary.Processes, summary.Threads, threadCycles.size());
+	}
+	return 0;
+}
+
+int ReplayCorpus(PCWSTR directory) {
+	auto corpus = LoadCorpus(directory);
+	if (corpus.empty()) {
+		printf("No snapshots in %ws\n", directory);
+		return 1;
+	}
+
+	// repeated until it runs for a few seconds; each pass starts a new parser, as the timestamps start over
+	const int64_t MinTime = 3 * 10000000LL;
+	size_t parsed = 0, processes = 0, threads = 0;
+	auto start = PerfCounter::Now();
+	do {
+		ProcessSnapshotParser parser(::GetActiveProcessorCount(ALL_PROCESSOR_GROUPS));
+		for (auto& snapshot : corpus) {
+			parser.Parse(snapshot.Buffer.data(), snapshot.Buffer.size(), snapshot.Timestamp, snapshot.Extended, true);
+			processes += parser.GetProcessCount();
+			threads += parser.GetThreadCount();
+			parsed++;
+		}
+	} while (PerfCounter::Now() - start < MinTime);
+	auto elapsed = PerfCounter::Now() - start;
+
+	printf("%zu snapshots (%zu processes, %zu threads on average): %.1f snapshots/sec\n",
+		corpus.size(), processes / parsed, threads / parsed, parsed * 10000000.0 / elapsed);
+	return 0;
+}
+
+int CompareCpuAccounting(PCWSTR directory) {
+	auto corpus = LoadCorpus(directory);
+	if (corpus.size() < 2) {
+		printf("Not enough snapshots in %ws\n", directory);
+		return 1;
+	}
+
+	CpuAccountingComparer comparer(::GetActiveProcessorCount(ALL_PROCESSOR_GROUPS));
+	for (auto& snapshot : corpus)
+		comparer.Add(snapshot.Buffer.data(), snapshot.Buffer.size(), snapshot.Timestamp, snapshot.Extended, ReplayThreadCycles(snapshot));
+
+	auto& c = comparer.GetComparison();
+	printf("%u samples; difference between time and cycle based CPU, in percent\n", c.Samples);
+	printf("processes: %llu compared, mean %.3f, max %.3f, %llu idle by time only\n",
+		c.Processes, c.GetMeanProcessDifference(), c.MaxProcessDifference, c.ProcessesIdleByTime);
+	printf("threads: %llu compared, mean %.3f, max %.3f, %llu idle by time only\n",
+		c.Threads, c.GetMeanThreadDifference(), c.MaxThreadDifference, c.ThreadsIdleByTime);
+	return 0;
+}
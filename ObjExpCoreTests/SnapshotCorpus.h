@@ -0,0 +1,48 @@
+#pragma once
+
+#include <ProcessSnapshotParser.h>
+
+//
+// recorded process snapshots (the raw buffers ProcessSnapshotParser takes), for replaying the parser off the live system.
+// a corpus is a directory of .snap files in capture order. the records have the native pointer size,
+// so a corpus replays on builds of the same bitness
+//
+
+// a thread's cycle time, read right after the snapshot it is recorded with
+struct RecordedThreadCycles {
+	uint32_t ThreadId;
+	uint32_t Reserved;
+	uint64_t Cycles;
+	// PerfCounter time of the read
+	int64_t Timestamp;
+};
+
+struct RecordedSnapshot {
+	std::vector<uint8_t> Buffer;
+	std::vector<RecordedThreadCycles> ThreadCycles;
+	int64_t Timestamp;
+	bool Extended;
+};
+
+bool SaveSnapshot(PCWSTR path, const void* buffer, size_t size, int64_t timestamp, bool extended, const std::vector<RecordedThreadCycles>& threadCycles);
+// the image name pointers are moved to the loaded buffer
+bool LoadSnapshot(PCWSTR path, RecordedSnapshot& snapshot);
+std::vector<RecordedSnapshot> LoadCorpus(PCWSTR directory);
+
+//
+// a well formed snapshot of processes with threadsPerProcess threads each, one second after the previous sample.
+// process i (pid 4 * (i + 1)) uses i percent of a processor per thread; every sample replaces one process in 100
+// with a new one of the same pid, so successive samples have new and terminated processes and threads.
+// thread cycles are 300 per 100 nsec of thread time, read at the snapshot's timestamp
+//
+RecordedSnapshot MakeSnapshot(uint32_t processes, uint32_t threadsPerProcess, uint32_t sample);
+
+// the cycle query of a parser replaying the snapshot's recorded thread cycles; valid while the snapshot is
+WinSys::ProcessSnapshotParser::ThreadCycleQuery ReplayThreadCycles(const RecordedSnapshot& snapshot);
+
+// captures count live snapshots a second apart into the directory, with the cycle times of their threads
+int RecordCorpus(PCWSTR directory, int count);
+// parses the corpus repeatedly and prints the throughput
+int ReplayCorpus(PCWSTR directory);
+// parses the corpus with time and cycle based CPU accounting and prints how far the two disagree
+int CompareCpuAccounting(PCWSTR directory);
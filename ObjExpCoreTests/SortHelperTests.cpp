@@ -0,0 +1,57 @@
+#include "pch.h"
+#include "Test.h"
+#include <SortHelper.h>
+
+namespace {
+	enum class Color : int8_t {
+		Red = -1, Green, Blue
+	};
+
+	template<typename Number>
+	bool Before(Number n1, Number n2, bool ascending) {
+		return SortHelper::PackKey(n1, ascending) < SortHelper::PackKey(n2, ascending);
+	}
+}
+
+TEST(SortHelper_PackKeyOrder) {
+	CHECK(Before(1u, 2u, true) && !Before(2u, 1u, true));
+	CHECK(Before(2u, 1u, false));
+	CHECK(Before(0ULL, ~0ULL, true));
+
+	// signed values across zero
+	CHECK(Before(-5, 3, true) && Before(3, -5, false));
+	CHECK(Before(INT64_MIN, INT64_MAX, true));
+	CHECK(Before(-1LL, 0LL, true));
+	CHECK(Before<int16_t>(-300, -2, true));
+
+	// enums by their underlying type
+	CHECK(Before(Color::Red, Color::Blue, true));
+	CHECK(Before(Color::Blue, Color::Green, false));
+
+	// equal values give equal keys in both directions
+	CHECK(SortHelper::PackKey(-7, true) == SortHelper::PackKey(-7LL, true));
+	CHECK(SortHelper::PackKey(42u, false) == SortHelper::PackKey(42ULL, false));
+}
+
+TEST(SortHelper_SortByKeyIsStable) {
+	struct Item {
+		int Value;
+		int Order;
+	};
+	std::vector<Item> items{ { 3, 0 }, { -1, 1 }, { 3, 2 }, { 0, 3 }, { -1, 4 } };
+
+	SortHelper::SortByKey(items, [](auto& item) { return SortHelper::PackKey(item.Value, true); });
+	int ascending[] = { 1, 4, 3, 0, 2 };
+	for (size_t i = 0; i < items.size(); i++)
+		CHECK(items[i].Order == ascending[i]);
+
+	// ties keep their current order when descending too
+	SortHelper::SortByKey(items, [](auto& item) { return SortHelper::PackKey(item.Value, false); });
+	int descending[] = { 0, 2, 3, 1, 4 };
+	for (size_t i = 0; i < items.size(); i++)
+		CHECK(items[i].Order == descending[i]);
+
+	std::vector<std::wstring> names{ L"b", L"a", L"c" };
+	SortHelper::SortByKey(names, [](auto& name) { return name; }, std::less<>());
+	CHECK(names[0] == L"a" && names[2] == L"c");
+}
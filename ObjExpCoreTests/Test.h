@@ -0,0 +1,27 @@
+#pragma once
+
+//
+// minimal self registering test cases: TEST(Name) { CHECK(...); }
+// a failed check reports and continues, so one run lists every failure
+//
+
+struct TestCase {
+	const char* Name;
+	void (*Run)();
+};
+
+std::vector<TestCase>& GetTests();
+void ReportFailure(const char* file, int line, const char* expression);
+
+struct TestRegistrar {
+	TestRegistrar(const char* name, void (*run)()) {
+		GetTests().push_back(TestCase{ name, run });
+	}
+};
+
+#define TEST(name) \
+	static void name(); \
+	static TestRegistrar name##Registrar(#name, name); \
+	static void name()
+
+#define CHECK(expression) ((expression) ? (void)0 : ReportFailure(__FILE__, __LINE__, #expression))
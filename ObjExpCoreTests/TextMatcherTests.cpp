@@ -0,0 +1,58 @@
+#include "pch.h"
+#include "Test.h"
+#include <TextMatcher.h>
+
+using namespace WinSys;
+
+TEST(TextMatcher_Find) {
+	TextMatcher matcher(L"DLL");
+	CHECK(matcher.GetPattern() == L"dll");
+	CHECK(matcher.Find(L"ntdll.dll") == 2);
+	CHECK(matcher.Find(L"NTDLL") == 2);
+	CHECK(matcher.Find(L"dl") == TextMatcher::npos);
+	CHECK(matcher.Find(L"") == TextMatcher::npos);
+	CHECK(matcher.Contains(L"C:\\WINDOWS\\SYSTEM32\\KERNELBASE.DLL"));
+	CHECK(!matcher.Contains(L"C:\\Windows\\System32\\notepad.exe"));
+
+	TextMatcher empty;
+	CHECK(empty.IsEmpty());
+	CHECK(empty.Find(L"anything") == 0);
+}
+
+TEST(TextMatcher_LongTextsUseEveryBlockPosition) {
+	// the match is moved through every position of the 8 and 16 character blocks, and past them
+	TextMatcher matcher(L"Needle");
+	for (size_t pos = 0; pos < 70; pos++) {
+		std::wstring text(80, L'x');
+		text.replace(pos, 6, L"nEEDLE");
+		CHECK(matcher.Find(text) == pos);
+	}
+	// first and last characters match, the middle doesn't
+	CHECK(matcher.Find(std::wstring(40, L'n') + L"nxxxxe" + std::wstring(40, L'e')) == TextMatcher::npos);
+}
+
+TEST(TextMatcher_LongPatterns) {
+	std::wstring pattern = L"\\Device\\HarddiskVolume3\\Windows\\System32";
+	TextMatcher matcher(pattern);
+	CHECK(matcher.Find(L"\\device\\harddiskvolume3\\windows\\system32\\ntdll.dll") == 0);
+	CHECK(matcher.StartsWith(L"\\DEVICE\\HARDDISKVOLUME3\\WINDOWS\\SYSTEM32\\"));
+	CHECK(!matcher.StartsWith(L"\\Device\\HarddiskVolume3\\Windows\\System"));
+	CHECK(matcher.Equals(L"\\device\\harddiskvolume3\\windows\\system32"));
+	CHECK(!matcher.Equals(L"\\device\\harddiskvolume3\\windows\\system32\\"));
+}
+
+TEST(TextMatcher_NonAscii) {
+	// non-ASCII characters fold with towlower (locale dependent), but never into ASCII
+	TextMatcher matcher(L"\u00e9t\u00e9");
+	CHECK(matcher.Contains(L"l'\u00e9t\u00e9"));
+	CHECK(!matcher.Contains(L"ete"));
+	CHECK(TextMatcher::Fold(L'A') == L'a');
+	CHECK(TextMatcher::Fold(L'[') == L'[');
+	// the Kelvin sign lowercases to 'k'
+	CHECK(TextMatcher::Fold(L'\u212A') == L'\u212A');
+	CHECK(!TextMatcher(L"k").Contains(L"\u212A"));
+
+	std::wstring text(50, L'\u00e9');
+	text += L"Abc";
+	CHECK(TextMatcher(L"\u00e9ABC").Find(text) == 49);
+}
@@ -0,0 +1,86 @@
+#include "pch.h"
+#include "Test.h"
+#include <TrigramIndex.h>
+
+using namespace WinSys;
+
+namespace {
+	bool Contains(const std::vector<TrigramIndex::DocId>& ids, TrigramIndex::DocId id) {
+		return std::find(ids.begin(), ids.end(), id) != ids.end();
+	}
+}
+
+TEST(TrigramIndex_FindsSubstringsIgnoringCase) {
+	TrigramIndex index;
+	auto ntdll = index.Add(L"C:\\Windows\\System32\\ntdll.dll");
+	auto kernel = index.Add(L"C:\\Windows\\System32\\KERNEL32.DLL");
+	auto notepad = index.Add(L"notepad.exe");
+
+	auto found = index.Find(L"SYSTEM32");
+	CHECK(found.size() == 2);
+	CHECK(Contains(found, ntdll) && Contains(found, kernel));
+	CHECK(index.Find(L"kernel32.dll") == std::vector<TrigramIndex::DocId>{ kernel });
+	CHECK(index.Find(L"Pad.") == std::vector<TrigramIndex::DocId>{ notepad });
+	CHECK(index.Find(L"explorer").empty());
+	CHECK(index.Find(L"").empty());
+	CHECK(index.GetText(kernel) == L"c:\\windows\\system32\\kernel32.dll");
+}
+
+TEST(TrigramIndex_ShortQueriesScan) {
+	TrigramIndex index;
+	auto a = index.Add(L"ab");
+	auto b = index.Add(L"xaby");
+	index.Add(L"xyz");
+
+	auto found = index.Find(L"AB");
+	CHECK(found.size() == 2 && Contains(found, a) && Contains(found, b));
+	CHECK(index.Find(L"y").size() == 2);
+}
+
+TEST(TrigramIndex_MaxResults) {
+	TrigramIndex index;
+	for (int i = 0; i < 10; i++)
+		index.Add(L"svchost.exe");
+	CHECK(index.Find(L"host", 3).size() == 3);
+	CHECK(index.Find(L"host").size() == 10);
+	CHECK(index.Find(L"ho", 4).size() == 4);
+}
+
+TEST(TrigramIndex_RemoveAndReuse) {
+	TrigramIndex index;
+	std::vector<TrigramIndex::DocId> ids;
+	// enough removals to trigger a purge
+	for (int i = 0; i < 3000; i++)
+		ids.push_back(index.Add(L"handle " + std::to_wstring(i)));
+	auto keep = index.Add(L"keep me");
+	for (auto id : ids)
+		index.Remove(id);
+
+	CHECK(index.GetCount() == 1);
+	CHECK(!index.IsValid(ids[0]));
+	CHECK(index.Find(L"handle").empty());
+	CHECK(index.Find(L"keep") == std::vector<TrigramIndex::DocId>{ keep });
+
+	auto stats = index.GetStats();
+	CHECK(stats.Documents == 1);
+	CHECK(stats.Removed < 3000);
+
+	// purged ids are reused; the new text is found under its own trigrams only
+	auto reused = index.Add(L"new handle");
+	CHECK(reused != keep);
+	CHECK(index.Find(L"handle") == std::vector<TrigramIndex::DocId>{ reused });
+	CHECK(index.Find(L"handle 12").empty());
+
+	index.Remove(reused);
+	index.Remove(reused);
+	CHECK(index.GetCount() == 1);
+}
+
+TEST(TrigramIndex_Clear) {
+	TrigramIndex index;
+	index.Add(L"process");
+	index.Clear();
+	CHECK(index.GetCount() == 0);
+	CHECK(index.Find(L"process").empty());
+	CHECK(index.Add(L"thread") == 0);
+}
@@ -0,0 +1,74 @@
+#include "pch.h"
+#include "Test.h"
+#include "SnapshotCorpus.h"
+#include <Profiler.h>
+#include <new.h>
+
+//
+// runs all tests (or those whose names contain the argument); the exit code is the number of failed tests.
+// -bench runs the benchmarks instead; -record <dir> [count] captures a snapshot corpus, -replay <dir> times parsing it
+// and -compare <dir> compares time and cycle based CPU accounting on it
+//
+
+void RunBenchmarks();
+
+//
+// counts allocations for the benchmarks (per thread), the same way the application does for its profiler
+//
+
+void* operator new(size_t size) {
+	WinSys::Profiler::CountAllocation();
+	for (;;) {
+		if (auto p = ::malloc(size ? size : 1))
+			return p;
+		if (::_callnewh(size) == 0)
+			throw std::bad_alloc();
+	}
+}
+
+void operator delete(void* p) noexcept {
+	::free(p);
+}
+
+namespace {
+	int Failures;
+}
+
+std::vector<TestCase>& GetTests() {
+	static std::vector<TestCase> tests;
+	return tests;
+}
+
+void ReportFailure(const char* file, int line, const char* expression) {
+	printf("  %s(%d): CHECK(%s) failed\n", file, line, expression);
+	Failures++;
+}
+
+int wmain(int argc, const wchar_t* argv[]) {
+	if (argc > 1 && ::_wcsicmp(argv[1], L"-bench") == 0) {
+		RunBenchmarks();
+		return 0;
+	}
+	if (argc > 2 && ::_wcsicmp(argv[1], L"-record") == 0)
+		return RecordCorpus(argv[2], argc > 3 ? ::_wtoi(argv[3]) : 10);
+	if (argc > 2 && ::_wcsicmp(argv[1], L"-replay") == 0)
+		return ReplayCorpus(argv[2]);
+	if (argc > 2 && ::_wcsicmp(argv[1], L"-compare") == 0)
+		return CompareCpuAccounting(argv[2]);
+
+	int run = 0, failed = 0;
+	for (auto& test : GetTests()) {
+		if (argc > 1 && ::strstr(test.Name, CStringA(argv[1])) == nullptr)
+			continue;
+
+		auto failures = Failures;
+		test.Run();
+		run++;
+		if (Failures > failures) {
+			printf("FAILED %s\n", test.Name);
+			failed++;
+		}
+	}
+	printf("%d tests, %d failed\n", run, failed);
+	return failed;
+}
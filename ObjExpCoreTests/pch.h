@@ -0,0 +1,19 @@
+#pragma once
+
+// same environment as ObjExpCore, whose headers are tested
+#define WIN32_LEAN_AND_MEAN
+#define PHNT_MODE 1
+#define PHNT_VERSION PHNT_THRESHOLD
+#define _HAS_EXCEPTIONS 0
+
+#include <phnt_windows.h>
+#include <phnt.h>
+
+#include <atlstr.h>
+#include <vector>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <algorithm>
+#include <wil\resource.h>
+#include <stdio.h>
@@ -94,6 +94,7 @@ LRESULT CDeviceManagerView::OnFindNext(WORD, WORD, HWND, BOOL&) {
 }
 
 void CDeviceManagerView::Refresh() {
+	PROFILE_SCOPE("CDeviceManagerView", "Refresh");
 	m_Tree.LockWindowUpdate(TRUE);
 	m_Tree.DeleteAllItems();
 
@@ -305,11 +305,76 @@ CString FormatHelper::GetProcessColumnValue(ProcessColumn col, const WinSys::Pro
 		case ProcessColumn::Description: return px.GetDescription();
 		case ProcessColumn::Company: return px.GetCompanyName();
 		case ProcessColumn::DpiAwareness: return FormatHelper::DpiAwarenessToString(px.GetDpiAwareness());
+		case ProcessColumn::IoReadRate:
+		case ProcessColumn::IoWriteRate:
+		case ProcessColumn::IoOtherRate:
+			if (!px.IsTerminated) {
+				auto metric = col == ProcessColumn::IoReadRate ? PerfMetric::ReadBytes : (col == ProcessColumn::IoWriteRate ? PerfMetric::WriteBytes : PerfMetric::OtherBytes);
+				return FormatHelper::FormatWithCommas((long long)pm.GetProcessCounters().GetRate(p->GetCounterSlot(), metric));
+			}
+			break;
 	}
 
 	return text;
 }
 
+uint64_t FormatHelper::GetProcessColumnKey(ProcessColumn col, const WinSys::ProcessManager& pm, ProcessInfo* p, const ProcessInfoEx& px, uint32_t generation) {
+	switch (col) {
+		// fixed for the life of the process, or queried once and kept by ProcessInfoEx
+		case ProcessColumn::Name:
+		case ProcessColumn::PackageFullName:
+		case ProcessColumn::UserName:
+		case ProcessColumn::Id:
+		case ProcessColumn::Session:
+		case ProcessColumn::ExePath:
+		case ProcessColumn::CreateTime:
+		case ProcessColumn::Attributes:
+		case ProcessColumn::CommandLine:
+		case ProcessColumn::Elevated:
+		case ProcessColumn::Platform:
+		case ProcessColumn::Description:
+		case ProcessColumn::Company:
+			return 0;
+
+		case ProcessColumn::Handles: return p->HandleCount;
+		case ProcessColumn::Threads: return p->ThreadCount;
+		case ProcessColumn::PeakThreads: return p->PeakThreads;
+		case ProcessColumn::CPU: return px.IsTerminated ? ~0ULL : (uint32_t)p->CPU;
+		case ProcessColumn::Priority: return p->BasePriority;
+		case ProcessColumn::CPUTime: return p->UserTime + p->KernelTime;
+		case ProcessColumn::KernelTime: return p->KernelTime;
+		case ProcessColumn::UserTime: return p->UserTime;
+		case ProcessColumn::CommitSize: return p->PagefileUsage >> 10;
+		case ProcessColumn::PeakCommitSize: return p->PeakPagefileUsage >> 10;
+		case ProcessColumn::WorkingSet: return p->WorkingSetSize >> 10;
+		case ProcessColumn::PeakWorkingSet: return p->PeakWorkingSetSize >> 10;
+		case ProcessColumn::VirtualSize: return p->VirtualSize >> 10;
+		case ProcessColumn::PeakVirtualSize: return p->PeakVirtualSize >> 10;
+		case ProcessColumn::PagedPool: return p->PagedPoolUsage >> 10;
+		case ProcessColumn::NonPagedPool: return p->NonPagedPoolUsage >> 10;
+		case ProcessColumn::PeakPagedPool: return p->PeakPagedPoolUsage >> 10;
+		case ProcessColumn::PeakNonPagedPool: return p->PeakNonPagedPoolUsage >> 10;
+		case ProcessColumn::IoReadBytes: return p->ReadTransferCount;
+		case ProcessColumn::IoWriteBytes: return p->WriteTransferCount;
+		case ProcessColumn::IoOtherBytes: return p->OtherTransferCount;
+		case ProcessColumn::IoReads: return p->ReadOperationCount;
+		case ProcessColumn::IoWrites: return p->WriteOperationCount;
+		case ProcessColumn::IoOther: return p->OtherOperationCount;
+		case ProcessColumn::JobId: return p->JobObjectId;
+		case ProcessColumn::IoReadRate:
+		case ProcessColumn::IoWriteRate:
+		case ProcessColumn::IoOtherRate:
+			if (!px.IsTerminated) {
+				auto metric = col == ProcessColumn::IoReadRate ? PerfMetric::ReadBytes : (col == ProcessColumn::IoWriteRate ? PerfMetric::WriteBytes : PerfMetric::OtherBytes);
+				return (uint64_t)(long long)pm.GetProcessCounters().GetRate(p->GetCounterSlot(), metric);
+			}
+			return ~0ULL;
+	}
+
+	// parent, priorities, GUI objects, window title, integrity, virtualization, DPI awareness
+	return generation;
+}
+
 CString FormatHelper::ProcessAttributesToString(ProcessAttributes attributes) {
 	CString text;
 
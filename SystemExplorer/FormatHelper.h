@@ -15,6 +15,7 @@ enum class ProcessColumn {
 	IoReadBytes, IoWriteBytes, IoOtherBytes, IoReads, IoWrites, IoOther,
 	GDIObjects, UserObjects, PeakGdiObjects, PeakUserObjects, Integrity, Elevated, Virtualized,
 	WindowTitle, Platform, Description, Company, DpiAwareness,
+	IoReadRate, IoWriteRate, IoOtherRate,
 	COUNT
 };
 
@@ -33,6 +34,9 @@ struct FormatHelper {
 	static CString ComFlagsToString(WinSys::ComFlags flags);
 	static PCWSTR ComApartmentToString(WinSys::ComFlags flags);
 	static CString GetProcessColumnValue(ProcessColumn col, const WinSys::ProcessManager& pm, WinSys::ProcessInfo* pi, ProcessInfoEx& px);
+	// changes whenever the column's text may change, so formatted text can be cached until it does.
+	// columns only known by querying the process change key with every snapshot (generation)
+	static uint64_t GetProcessColumnKey(ProcessColumn col, const WinSys::ProcessManager& pm, WinSys::ProcessInfo* pi, const ProcessInfoEx& px, uint32_t generation);
 	static CString ProcessAttributesToString(ProcessAttributes attributes);
 	static PCWSTR DpiAwarenessToString(DpiAwareness da);
 };
@@ -14,6 +14,8 @@
 #include "SecurityHelper.h"
 #include "UndocListView.h"
 #include "ProcessHelper.h"
+#include "SnapshotBus.h"
+#include "ObjectNameCache.h"
 
 using namespace WinSys;
 
@@ -60,7 +62,7 @@ CString CHandlesView::GetColumnText(HWND, int row, int col) {
 			if (data->HandleAttributes & 0x8000)
 				return data->Name;
 			else {
-				text = m_ObjMgr.GetObjectName(ULongToHandle(data->HandleValue), data->ProcessId, data->ObjectTypeIndex);
+				text = m_ObjMgr.GetObjectName(ULongToHandle(data->HandleValue), data->ProcessId, data->ObjectTypeIndex, data->Object);
 				data->Name = text;
 				data->HandleAttributes |= 0x8000;
 			}
@@ -89,24 +91,47 @@ CString CHandlesView::GetColumnText(HWND, int row, int col) {
 			return AccessMaskDecoder::DecodeAccessMask(m_ObjMgr.GetType(data->ObjectTypeIndex)->TypeName, data->GrantedAccess);
 
 		case 9:	// details
-			if (::GetTickCount64() > m_TargetUpdateTime || m_DetailsCache.find(data.get()) == m_DetailsCache.end()) {
+			// shared by all handles to the object, refreshed every few seconds
+			if (!ObjectNameCache::Get().GetDetails(data->Object, data->ObjectTypeIndex, text, 5000)) {
 				auto h = m_ObjMgr.DupHandle(ULongToHandle(data->HandleValue), data->ProcessId, data->ObjectTypeIndex);
 				if (h) {
 					auto type = ObjectTypeFactory::CreateObjectType(data->ObjectTypeIndex, ObjectManager::GetType(data->ObjectTypeIndex)->TypeName);
 					text = type ? type->GetDetails(h) : CString();
-					m_DetailsCache[data.get()] = text;
+					ObjectNameCache::Get().SetDetails(data->Object, data->ObjectTypeIndex, text);
 					::CloseHandle(h);
 				}
-				m_TargetUpdateTime = ::GetTickCount64() + 5000;
-			}
-			else {
-				return m_DetailsCache[data.get()];
 			}
 			break;
 	}
 	return text;
 }
 
+bool CHandlesView::GetFindKey(HWND, int row, int col, std::wstring_view& key, FindKeyBuffer& buffer) const {
+	auto& data = m_Handles[row];
+	switch (col) {
+		case 0:	// type
+			key = m_ObjMgr.GetType(data->ObjectTypeIndex)->TypeName;
+			return true;
+
+		case 2:	// name, unless it's still to be queried
+			if ((data->HandleAttributes & 0x8000) == 0)
+				return false;
+			key = std::wstring_view(data->Name, data->Name.GetLength());
+			return true;
+
+		case 3:	// handle
+			::StringCchPrintf(buffer, _countof(buffer), L"%d (0x%X)", data->HandleValue, data->HandleValue);
+			key = buffer;
+			return true;
+
+		case 5:	// PID
+			::StringCchPrintf(buffer, _countof(buffer), L"%d (0x%X)", data->ProcessId, data->ProcessId);
+			key = buffer;
+			return true;
+	}
+	return false;
+}
+
 int CHandlesView::GetRowImage(HWND, int row) const {
 	return Frame()->GetIconIndexByType((PCWSTR)m_ObjMgr.GetType(m_Handles[row]->ObjectTypeIndex)->TypeName);
 }
@@ -135,11 +160,11 @@ bool CHandlesView::CompareItems(HandleInfo& h1, HandleInfo& h2, const SortInfo*
 
 		case 2:		// name
 			if ((h1.HandleAttributes & 0x8000) == 0) {
-				h1.Name = m_ObjMgr.GetObjectName(ULongToHandle(h1.HandleValue), h1.ProcessId, h1.ObjectTypeIndex);
+				h1.Name = m_ObjMgr.GetObjectName(ULongToHandle(h1.HandleValue), h1.ProcessId, h1.ObjectTypeIndex, h1.Object);
 				h1.HandleAttributes |= 0x8000;
 			}
 			if ((h2.HandleAttributes & 0x8000) == 0) {
-				h2.Name = m_ObjMgr.GetObjectName(ULongToHandle(h2.HandleValue), h2.ProcessId, h2.ObjectTypeIndex);
+				h2.Name = m_ObjMgr.GetObjectName(ULongToHandle(h2.HandleValue), h2.ProcessId, h2.ObjectTypeIndex, h2.Object);
 				h2.HandleAttributes |= 0x8000;
 			}
 			return SortHelper::SortStrings(h1.Name, h2.Name, si->SortAscending);
@@ -284,7 +309,7 @@ void CHandlesView::OnUpdate() {
 				::CloseHandle(hDup);
 				continue;
 			}
-			auto hi = std::make_shared<HandleInfo>();
+			auto hi = ObjectManager::CreateHandleInfo();
 			hi->HandleValue = HandleToULong(h.HandleValue);
 			hi->ProcessId = m_Pid;
 			hi->ObjectTypeIndex = h.ObjectTypeIndex;
@@ -398,23 +423,23 @@ LRESULT CHandlesView::OnObjectProperties(WORD, WORD, HWND, BOOL&) {
 }
 
 void CHandlesView::Refresh() {
+	PROFILE_SCOPE("CHandlesView", "Refresh");
 	if (m_hProcess && ::WaitForSingleObject(m_hProcess.get(), 0) == WAIT_OBJECT_0) {
 		KillTimer(1);
 		AtlMessageBox(*this, (L"Process " + std::to_wstring(m_Pid) + L" is no longer running.").c_str(), IDS_TITLE, MB_OK | MB_ICONWARNING);
 		Frame()->CloseView(*this);
 		return;
 	}
-	m_ObjMgr.EnumHandles(m_HandleType, m_Pid, m_NamedObjectsOnly);
+	// keeps the records (and resolved names) of handles that are still open
+	m_ObjMgr.UpdateHandles(m_HandleType, m_Pid, m_NamedObjectsOnly);
 	if (m_HandleTracker) {
-		m_DetailsCache.clear();
-		m_DetailsCache.reserve(1024);
 		m_Changes.clear();
 		m_Changes.reserve(8);
 		m_HandleTracker->EnumHandles(true);
 		if (!m_Paused)
 			SetTimer(1, 1000, nullptr);
 	}
-	m_ProcMgr.EnumProcesses();
+	SnapshotBus::Get().UpdateProcesses(m_ProcMgr);
 	m_Handles = m_ObjMgr.GetHandles();
 	DoSort(GetSortInfo(m_List));
 	m_List.SetItemCountEx(static_cast<int>(m_Handles.size()), LVSICF_NOINVALIDATEALL | LVSICF_NOSCROLL);
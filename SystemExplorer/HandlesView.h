@@ -20,6 +20,7 @@ public:
 	void DoSort(const SortInfo* si);
 	bool IsSortable(int col) const;
 	CString GetColumnText(HWND, int row, int col);
+	bool GetFindKey(HWND, int row, int col, std::wstring_view& key, FindKeyBuffer& buffer) const;
 	int GetRowImage(HWND, int row) const;
 	static CString HandleAttributesToString(ULONG attributes);
 
@@ -84,8 +85,6 @@ private:
 	int m_ColumnCount;
 	int m_Pid;
 	std::vector<std::shared_ptr<HandleInfo>> m_Handles;
-	std::unordered_map<HandleInfo*, CString> m_DetailsCache;
-	DWORD64 m_TargetUpdateTime = 0;
 	std::vector<Change> m_Changes;
 	wil::unique_handle m_hProcess;
 	bool m_Paused = false;
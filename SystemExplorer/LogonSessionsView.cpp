@@ -98,6 +98,7 @@ LRESULT CLogonSessionsView::OnRefresh(WORD, WORD, HWND, BOOL&) {
 }
 
 void CLogonSessionsView::Refresh() {
+	PROFILE_SCOPE("CLogonSessionsView", "Refresh");
 	m_Sessions = WinSys::LsaSecurity::EnumLogonSessions();
 	DoSort(GetSortInfo(m_List));
 	m_List.SetItemCountEx(static_cast<int>(m_Sessions.size()), LVSICF_NOSCROLL | LVSICF_NOINVALIDATEALL);
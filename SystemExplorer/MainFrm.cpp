@@ -31,6 +31,9 @@
 #include "SysInfoView.h"
 #include "InstallServiceDlg.h"
 #include "SystemModulesView.h"
+#include "ProfilerView.h"
+#include "ObjectNameCache.h"
+#include "ObjectNameResolver.h"
 #include "ProcessTreeView.h"
 #include <ProcessInfo.h>
 #include <Helpers.h>
@@ -270,7 +273,7 @@ LRESULT CMainFrame::OnCreate(UINT /*uMsg*/, WPARAM /*wParam*/, LPARAM /*lParam*/
 
 	CreateSimpleStatusBar();
 	m_StatusBar.SubclassWindow(m_hWndStatusBar);
-	int parts[] = { 100, 200, 300, 430, 560, 700, 830, 960, 1100 };
+	int parts[] = { 100, 200, 300, 430, 560, 700, 830, 960, 1100, 1260, 1420, 1640, 1900 };
 	m_StatusBar.SetParts(_countof(parts), parts);
 
 	m_view.m_bDestroyImageList = false;
@@ -308,6 +311,8 @@ LRESULT CMainFrame::OnCreate(UINT /*uMsg*/, WPARAM /*wParam*/, LPARAM /*lParam*/
 		UISetCheck(ID_OPTIONS_SINGLEINSTANCEONLY, TRUE);
 	if (settings.MinimizeToTray)
 		UISetCheck(ID_OPTIONS_MINIMIZETOTRAY, TRUE);
+	if (settings.Processes.CycleBasedCpu)
+		UISetCheck(ID_OPTIONS_CYCLEBASEDCPU, TRUE);
 
 	// icons
 	struct {
@@ -408,6 +413,9 @@ LRESULT CMainFrame::OnCreate(UINT /*uMsg*/, WPARAM /*wParam*/, LPARAM /*lParam*/
 		//PostMessage(WM_COMMAND, ID_OBJECTS_ALLOBJECTTYPES);
 		PostMessage(WM_COMMAND, ID_SYSTEM_PROCESSES);
 	}
+	// a new frame is visible, even if all others are minimized
+	SnapshotBus::Get().Suspend(false);
+	m_Performance.Subscribe(SnapshotKind::Performance, 1000);
 	SetTimer(1, 1000, nullptr);
 
 	return 0;
@@ -417,10 +425,13 @@ LRESULT CMainFrame::OnCreate(UINT /*uMsg*/, WPARAM /*wParam*/, LPARAM /*lParam*/
 
 LRESULT CMainFrame::OnTimer(UINT, WPARAM id, LPARAM, BOOL&) {
 	if (id == 1) {
-		static ObjectAndHandleStats stats;
-		static PERFORMANCE_INFORMATION pi = { sizeof(pi) };
+		auto snapshot = m_Performance.GetNewPerformanceSnapshot();
+		if (snapshot == nullptr)
+			return 0;
+
 		CString text;
-		if (::GetPerformanceInfo(&pi, sizeof(pi))) {
+		if (snapshot->InfoValid) {
+			auto& pi = snapshot->Info;
 			text.Format(L"Processes: %u", pi.ProcessCount);
 			m_StatusBar.SetText(1, text);
 			text.Format(L"Threads: %u", pi.ThreadCount);
@@ -434,16 +445,53 @@ LRESULT CMainFrame::OnTimer(UINT, WPARAM id, LPARAM, BOOL&) {
 			text.Format(L"Kernel NP: %llu MB", pi.KernelNonpaged >> 8);
 			m_StatusBar.SetText(6, text);
 		}
-		if (ObjectManager::GetStats(stats)) {
+		if (snapshot->StatsValid) {
+			auto& stats = snapshot->Stats;
 			text.Format(L"Handles: %lld", stats.TotalHandles);
 			m_StatusBar.SetText(7, text);
 			text.Format(L"Objects: %lld", stats.TotalObjects);
 			m_StatusBar.SetText(8, text);
 		}
+		text.Format(L"Shared Snapshots: %llu", SnapshotBus::Get().GetStats().GetAvoided());
+		m_StatusBar.SetText(9, text);
+		text.Format(L"Sampling CPU: %llu ms", SnapshotBus::Get().GetStats().CpuTime / 10000);
+		m_StatusBar.SetText(10, text);
+		auto cache = ObjectNameCache::Get().GetStats();
+		text.Format(L"Name Cache: %.1f%% names, %.1f%% details", cache.GetHitRate(), cache.GetDetailsHitRate());
+		m_StatusBar.SetText(11, text);
+		// each name lookup was a query before the cache; skipped requests are file objects known to block
+		text.Format(L"Name Queries: %llu of %llu (%llu skipped)", ObjectManager::GetNameQueryCount(),
+			cache.Hits + cache.Misses, ObjectNameResolver::Get().GetStats().Skipped);
+		m_StatusBar.SetText(12, text);
 	}
 	return 0;
 }
 
+LRESULT CMainFrame::OnSize(UINT, WPARAM type, LPARAM, BOOL& bHandled) {
+	if (type == SIZE_MINIMIZED)
+		SetMinimized(true);
+	else if (type == SIZE_RESTORED || type == SIZE_MAXIMIZED)
+		SetMinimized(false);
+
+	bHandled = FALSE;
+	return 0;
+}
+
+void CMainFrame::SetMinimized(bool minimized) {
+	if (m_Minimized == minimized)
+		return;
+
+	m_Minimized = minimized;
+	s_MinimizedFrames += minimized ? 1 : -1;
+	if (minimized)
+		KillTimer(1);
+	else
+		SetTimer(1, 1000, nullptr);
+
+	// stop all sampling while nothing is visible
+	SnapshotBus::Get().Suspend(s_FrameCount > 0 && s_MinimizedFrames == s_FrameCount);
+}
+
 LRESULT CMainFrame::OnSysCommand(UINT, WPARAM wp, LPARAM, BOOL& bHandled) {
 	if ((wp & 0xfff0) == SC_MINIMIZE && Settings::Get().MinimizeToTray) {
 		AddTrayIcon(AtlLoadIconImage(IDR_MAINFRAME, 0, 16, 16), L"System Explorer");
@@ -459,9 +507,14 @@ LRESULT CMainFrame::OnDestroy(UINT /*uMsg*/, WPARAM /*wParam*/, LPARAM /*lParam*
 	CMessageLoop* pLoop = _Module.GetMessageLoop();
 	pLoop->RemoveMessageFilter(this);
 	pLoop->RemoveIdleHandler(this);
+	m_Performance.Unsubscribe();
 
+	if (m_Minimized)
+		s_MinimizedFrames--;
 	bHandled = --s_FrameCount > 0;
 	s_Frames.erase(this);
+	// the remaining frames may all be minimized
+	SnapshotBus::Get().Suspend(s_FrameCount > 0 && s_MinimizedFrames == s_FrameCount);
 
 	if (s_FrameCount == 0) {
 		SaveSettings();
@@ -806,6 +859,15 @@ LRESULT CMainFrame::OnMinimizeToTray(WORD, WORD, HWND, BOOL&) {
 	return 0;
 }
 
+LRESULT CMainFrame::OnCycleBasedCpu(WORD, WORD, HWND, BOOL&) {
+	// picked up by the process and thread views on their next update
+	auto& s = Settings::Get();
+	s.Processes.CycleBasedCpu = !s.Processes.CycleBasedCpu;
+	UISetCheck(ID_OPTIONS_CYCLEBASEDCPU, s.Processes.CycleBasedCpu);
+
+	return 0;
+}
+
 LRESULT CMainFrame::OnViewSystemInformation(WORD, WORD, HWND, BOOL&) {
 	auto pView = new CSysInfoView(this);
 	pView->Create(m_view, rcDefault, nullptr, WS_CHILD | WS_VISIBLE | WS_CLIPSIBLINGS | WS_CLIPCHILDREN, 0);
@@ -1140,6 +1202,14 @@ LRESULT CMainFrame::OnViewKernelModules(WORD /*wNotifyCode*/, WORD /*wID*/, HWND
 	return 0;
 }
 
+LRESULT CMainFrame::OnViewProfiler(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/) {
+	auto pView = new CProfilerView(this);
+	pView->Create(m_view, rcDefault, nullptr, WS_CHILD | WS_VISIBLE | WS_CLIPSIBLINGS | WS_CLIPCHILDREN, 0);
+	m_view.AddPage(pView->m_hWnd, L"Self Profiler", m_Icons[(int)IconType::SystemInfo], (IView*)pView);
+
+	return 0;
+}
+
 LRESULT CMainFrame::SendMessageToAllFrames(bool excludeCurrent, UINT msg, WPARAM wParam, LPARAM lParam) {
 	return 0;
 }
@@ -9,6 +9,7 @@
 #include "ToolBarHelper.h"
 #include "Settings.h"
 #include "NotifyIcon.h"
+#include "SnapshotBus.h"
 #include <unordered_set>
 
 class CMainFrame : 
@@ -52,6 +53,7 @@ public:
 		MESSAGE_HANDLER(WM_TIMER, OnTimer)
 		MESSAGE_HANDLER(WM_CREATE, OnCreate)
 		MESSAGE_HANDLER(WM_DESTROY, OnDestroy)
+		MESSAGE_HANDLER(WM_SIZE, OnSize)
 		COMMAND_ID_HANDLER(ID_VIEW_TOOLBAR, OnViewToolBar)
 		COMMAND_ID_HANDLER(ID_VIEW_STATUS_BAR, OnViewStatusBar)
 		COMMAND_ID_HANDLER(ID_APP_ABOUT, OnAppAbout)
@@ -70,6 +72,7 @@ public:
 		COMMAND_ID_HANDLER(ID_SYSTEM_LOGONSESSIONS, OnViewLogonSessions)
 		COMMAND_ID_HANDLER(ID_SYSTEM_INFORMATION, OnViewSystemInformation)
 		COMMAND_ID_HANDLER(ID_SYSTEM_KERNELMODULES, OnViewKernelModules)
+		COMMAND_ID_HANDLER(ID_VIEW_PROFILER, OnViewProfiler)
 		COMMAND_ID_HANDLER(ID_SYSTEM_COM, OnViewCom)
 		COMMAND_ID_HANDLER(ID_SYSTEM_DRIVERS, OnViewDrivers)
 		COMMAND_ID_HANDLER(ID_WINDOW_CLOSE_ALL, OnWindowCloseAll)
@@ -102,6 +105,7 @@ public:
 		COMMAND_ID_HANDLER(ID_OPTIONS_REPLACETASKMANAGER, OnReplaceTaskManager)
 		COMMAND_ID_HANDLER(ID_OPTIONS_SINGLEINSTANCEONLY, OnSingleInstance)
 		COMMAND_ID_HANDLER(ID_OPTIONS_MINIMIZETOTRAY, OnMinimizeToTray)
+		COMMAND_ID_HANDLER(ID_OPTIONS_CYCLEBASEDCPU, OnCycleBasedCpu)
 
 		COMMAND_ID_HANDLER(ID_GUI_ALLWINDOWSINDEFAULTDESKTOP, OnShowAllWindowsDefaultDesktop)
 		COMMAND_RANGE_HANDLER(ID_WINDOW_TABFIRST, ID_WINDOW_TABLAST, OnWindowActivate)
@@ -137,6 +141,7 @@ private:
 	LRESULT OnTimer(UINT /*uMsg*/, WPARAM /*wParam*/, LPARAM /*lParam*/, BOOL& /*bHandled*/);
 	LRESULT OnSysCommand(UINT /*uMsg*/, WPARAM /*wParam*/, LPARAM /*lParam*/, BOOL& /*bHandled*/);
 	LRESULT OnDestroy(UINT /*uMsg*/, WPARAM /*wParam*/, LPARAM /*lParam*/, BOOL& bHandled);
+	LRESULT OnSize(UINT /*uMsg*/, WPARAM /*wParam*/, LPARAM /*lParam*/, BOOL& bHandled);
 	LRESULT OnFileExit(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/);
 	LRESULT OnFileExitAll(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/);
 	LRESULT OnViewSystemServices(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/);
@@ -175,12 +180,14 @@ private:
 	LRESULT OnReplaceTaskManager(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/);
 	LRESULT OnSingleInstance(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/);
 	LRESULT OnMinimizeToTray(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/);
+	LRESULT OnCycleBasedCpu(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/);
 	LRESULT OnViewSystemInformation(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/);
 	LRESULT OnViewDrivers(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/);
 	LRESULT OnFindReplaceMessage(UINT /*uMsg*/, WPARAM id, LPARAM lParam, BOOL& handled);
 	LRESULT OnEditFind(WORD, WORD, HWND, BOOL&);
 	LRESULT OnEditFindNext(WORD, WORD, HWND, BOOL&);
 	LRESULT OnViewKernelModules(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/);
+	LRESULT OnViewProfiler(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/);
 	LRESULT OnViewProcessTree(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/);
 
 private:
@@ -190,6 +197,7 @@ private:
 	void InitCommandBar();
 	void InitToolBar(CToolBarCtrl& tb);
 	bool DetachTab(int index);
+	void SetMinimized(bool minimized);
 	LRESULT SendMessageToAllFrames(bool excludeCurrent, UINT msg, WPARAM wParam = 0, LPARAM lParam = 0);
 	LRESULT ShowNotImplemented();
 
@@ -201,6 +209,8 @@ private:
 	inline static CImageListManaged m_TabImages;
 	inline static std::unordered_map<std::wstring, int> m_IconMap;
 	inline static CFont m_MonoFont;
+	SnapshotSubscription m_Performance;
+	bool m_Minimized{ false };
 
 	enum class IconType {
 		Objects, Types, Handles, ObjectManager, Windows, Services,
@@ -211,6 +221,7 @@ private:
 	CFindReplaceDialog* m_pFindDlg{ nullptr };
 	inline static int m_Icons[(int)IconType::COUNT];
 	inline static int s_FrameCount;
+	inline static int s_MinimizedFrames;
 	inline static std::unordered_set<CMainFrame*> s_Frames;
 	inline static CString m_FindText;
 	inline static DWORD m_FindFlags{ 0 };
@@ -7,6 +7,7 @@
 #include <Psapi.h>
 #include "ntdll.h"
 #include <Helpers.h>
+#include "SnapshotBus.h"
 
 CMemoryMapView::CMemoryMapView(IMainFrame* frame, DWORD pid) : CViewBase(frame), m_Pid(pid) {
 }
@@ -119,6 +120,7 @@ LRESULT CMemoryMapView::OnRefresh(WORD, WORD, HWND, BOOL&) {
 }
 
 void CMemoryMapView::Refresh() {
+	PROFILE_SCOPE("CMemoryMapView", "Refresh");
 	if (m_Details.empty())
 		m_Details.reserve(128);
 
@@ -128,7 +130,7 @@ void CMemoryMapView::Refresh() {
 	m_Details.reserve(m_Items.size() / 2);
 
 	// enum threads
-	m_ProcMgr.EnumProcessesAndThreads(m_Pid);
+	SnapshotBus::Get().UpdateProcesses(m_ProcMgr, true, m_Pid);
 	m_Threads = m_ProcMgr.GetThreads();
 
 	// enum heaps
@@ -122,6 +122,7 @@ LRESULT CModulesView::OnGoToFileLocation(WORD, WORD, HWND, BOOL&) {
 }
 
 void CModulesView::Refresh() {
+	PROFILE_SCOPE("CModulesView", "Refresh");
 	if (!m_Tracker.IsRunning()) {
 		KillTimer(1);
 		AtlMessageBox(*this, L"Process has terminated", IDS_TITLE, MB_OK | MB_ICONWARNING);
@@ -2,7 +2,10 @@
 #include "ObjectManager.h"
 #include "DriverHelper.h"
 #include "NtDll.h"
+#include "ObjectNameResolver.h"
+#include "ObjectNameCache.h"
 #include <VersionHelpers.h>
+#include <Profiler.h>
 
 #pragma pack(push, 1)
 typedef struct _GDI_HANDLE_ENTRY {
@@ -38,8 +41,72 @@ std::unordered_map<std::wstring, std::shared_ptr<ObjectTypeInfo>> ObjectManager:
 std::vector<ObjectManager::Change> ObjectManager::_changes;
 int64_t ObjectManager::_totalHandles;
 int64_t ObjectManager::_totalObjects;
+static std::atomic<uint64_t> s_NameQueries;
+
+static NT::SYSTEM_HANDLE_INFORMATION_EX* QueryHandles(std::unique_ptr<BYTE[]>& buffer, ULONG& size) {
+	// the size of the previous query is the hint, with some room for new handles
+	if (size == 0)
+		size = 1 << 23;
+
+	for (;;) {
+		if (!buffer)
+			buffer = std::make_unique<BYTE[]>(size);
+		ULONG len = 0;
+		auto status = NT::NtQuerySystemInformation(NT::SystemExtendedHandleInformation, buffer.get(), size, &len);
+		if (status == 0) {
+			auto p = reinterpret_cast<NT::SYSTEM_HANDLE_INFORMATION_EX*>(buffer.get());
+			// objects gone from the table can't be named anymore
+			ObjectNameCache::Get().Retain(p);
+			return p;
+		}
+		if (status != STATUS_INFO_LENGTH_MISMATCH)
+			return nullptr;
+
+		buffer.reset();
+		size = len > size ? len + len / 8 : size << 1;
+	}
+}
+
+using HandleEntries = std::vector<const NT::SYSTEM_HANDLE_TABLE_ENTRY_INFO_EX*>;
+
+// calls onName for each handle, taking names from the cache and querying each uncached object only once
+static bool ResolveNames(const HandleEntries& handles, const std::function<void(size_t index, const CString& name, bool completed)>& onName, const std::atomic<bool>* cancel) {
+	auto& cache = ObjectNameCache::Get();
+	const size_t none = -1;
+	std::vector<ObjectNameResolver::Request> requests;
+	// the handles waiting for the name of the same object are chained through next
+	std::vector<size_t> first, next(handles.size(), none);
+	std::unordered_map<PVOID, size_t> queued;
+
+	CString name;
+	for (size_t i = 0; i < handles.size(); i++) {
+		auto& handle = *handles[i];
+		if (cache.GetName(handle.Object, handle.ObjectTypeIndex, name)) {
+			onName(i, name, true);
+			continue;
+		}
+		auto [it, inserted] = queued.try_emplace(handle.Object, requests.size());
+		if (inserted) {
+			requests.push_back({ (HANDLE)handle.HandleValue, (ULONG)handle.UniqueProcessId, handle.ObjectTypeIndex, false, handle.Object });
+			first.push_back(i);
+		}
+		else {
+			next[i] = first[it->second];
+			first[it->second] = i;
+		}
+	}
+
+	return ObjectNameResolver::Get().Resolve(requests, [&](size_t index, const CString& name, bool completed) {
+		auto i = first[index];
+		if (completed)
+			cache.SetName(handles[i]->Object, handles[i]->ObjectTypeIndex, name);
+		for (; i != none; i = next[i])
+			onName(i, name, completed);
+		}, cancel);
+}
 
 int ObjectManager::EnumTypes() {
+	PROFILE_SCOPE("Enumeration", "EnumTypes");
 	const ULONG len = 1 << 14;
 	BYTE buffer[len];
 	if (!NT_SUCCESS(NT::NtQueryObject(nullptr, NT::ObjectTypesInformation, buffer, len, nullptr)))
@@ -115,25 +182,15 @@ int ObjectManager::EnumTypes() {
 }
 
 bool ObjectManager::EnumHandlesAndObjects(PCWSTR type, DWORD pid, PCWSTR prefix, bool namedOnly) {
+	PROFILE_SCOPE("Enumeration", "EnumHandlesAndObjects");
 	EnumTypes();
 
-	ULONG len = 1 << 25;
-	std::unique_ptr<BYTE[]> buffer;
-	do {
-		buffer = std::make_unique<BYTE[]>(len);
-		auto status = NT::NtQuerySystemInformation(NT::SystemExtendedHandleInformation, buffer.get(), len, &len);
-		if (status == STATUS_INFO_LENGTH_MISMATCH) {
-			len <<= 1;
-			continue;
-		}
-		if (status == 0)
-			break;
+	auto p = QueryHandles(_handlesBuffer, _handlesBufferSize);
+	if (p == nullptr)
 		return false;
-	} while (true);
 
 	auto filteredTypeIndex = type == nullptr || ::wcslen(type) == 0 ? -1 : _typesNameMap.at(type)->TypeIndex;
 
-	auto p = (NT::SYSTEM_HANDLE_INFORMATION_EX*)buffer.get();
 	auto count = p->NumberOfHandles;
 	_objects.clear();
 	_objectsByAddress.clear();
@@ -142,6 +199,9 @@ bool ObjectManager::EnumHandlesAndObjects(PCWSTR type, DWORD pid, PCWSTR prefix,
 
 	CString sprefix(prefix ? prefix : L"");
 
+	HandleEntries entries;
+	entries.reserve(count / 2);
+
 	auto& handles = p->Handles;
 	for (decltype(count) i = 0; i < count; i++) {
 		auto& handle = handles[i];
@@ -151,15 +211,20 @@ bool ObjectManager::EnumHandlesAndObjects(PCWSTR type, DWORD pid, PCWSTR prefix,
 		if (pid && handle.UniqueProcessId != pid)
 			continue;
 
-		auto name = GetObjectName((HANDLE)handle.HandleValue, (ULONG)handle.UniqueProcessId, handle.ObjectTypeIndex);
+		entries.push_back(&handle);
+	}
+
+	// handles are added as their names arrive
+	return ResolveNames(entries, [&](size_t index, const CString& name, bool) {
+		auto& handle = *entries[index];
 		if (prefix) {
 			if (name.IsEmpty() || name.Left(sprefix.GetLength()).CompareNoCase(sprefix) != 0)
-				continue;
+				return;
 		}
 		if (namedOnly && name.IsEmpty())
-			continue;
+			return;
 
-		auto hi = std::make_shared<HandleInfo>();
+		auto hi = CreateHandleInfo();
 		hi->HandleValue = (ULONG)handle.HandleValue;
 		hi->GrantedAccess = handle.GrantedAccess;
 		hi->Object = handle.Object;
@@ -167,7 +232,7 @@ bool ObjectManager::EnumHandlesAndObjects(PCWSTR type, DWORD pid, PCWSTR prefix,
 		hi->ProcessId = (ULONG)handle.UniqueProcessId;
 		hi->ObjectTypeIndex = handle.ObjectTypeIndex;
 		if (auto it = _objectsByAddress.find(handle.Object); it == _objectsByAddress.end()) {
-			auto obj = std::make_shared<ObjectInfo>();
+			auto obj = CreateObjectInfo();
 			obj->HandleCount = 1;
 			obj->Object = handle.Object;
 			obj->Handles.push_back(hi);
@@ -175,7 +240,7 @@ bool ObjectManager::EnumHandlesAndObjects(PCWSTR type, DWORD pid, PCWSTR prefix,
 			obj->TypeName = GetType(obj->TypeIndex)->TypeName;
 			hi->ObjectInfo = obj.get();
 			if(!name.IsEmpty())
-				obj->Name = name;
+				obj->Name = InternName(name);
 
 			_objects.push_back(obj);
 			_objectsByAddress.insert({ handle.Object, obj });
@@ -186,34 +251,37 @@ bool ObjectManager::EnumHandlesAndObjects(PCWSTR type, DWORD pid, PCWSTR prefix,
 			it->second->Handles.push_back(hi);
 		}
 		_handles.push_back(hi);
-	}
-
-	return true;
+		}, _cancel);
 }
 
 bool ObjectManager::EnumHandles(PCWSTR type, DWORD pid, bool namedObjectsOnly) {
+	PROFILE_SCOPE("Enumeration", "EnumHandles");
 	EnumTypes();
 
-	ULONG len = 1 << 25;
-	std::unique_ptr<BYTE[]> buffer;
-	do {
-		buffer = std::make_unique<BYTE[]>(len);
-		auto status = NT::NtQuerySystemInformation(NT::SystemExtendedHandleInformation, buffer.get(), len, &len);
-		if (status == STATUS_INFO_LENGTH_MISMATCH) {
-			len <<= 1;
-			continue;
-		}
-		if (status == 0)
-			break;
+	auto p = QueryHandles(_handlesBuffer, _handlesBufferSize);
+	if (p == nullptr)
 		return false;
-	} while (true);
 
 	auto filteredTypeIndex = type == nullptr || ::wcslen(type) == 0 ? -1 : _typesNameMap.at(type)->TypeIndex;
 
-	auto p = (NT::SYSTEM_HANDLE_INFORMATION_EX*)buffer.get();
 	auto count = p->NumberOfHandles;
 	_handles.clear();
 	_handles.reserve(count);
+
+	auto add = [&](auto& handle, const CString& name) {
+		auto hi = CreateHandleInfo();
+		hi->HandleValue = (ULONG)handle.HandleValue;
+		hi->GrantedAccess = handle.GrantedAccess;
+		hi->Object = handle.Object;
+		hi->HandleAttributes = handle.HandleAttributes;
+		hi->ProcessId = (ULONG)handle.UniqueProcessId;
+		hi->ObjectTypeIndex = handle.ObjectTypeIndex;
+		hi->Name = InternName(name);
+
+		_handles.emplace_back(hi);
+	};
+
+	HandleEntries entries;
 	for (decltype(count) i = 0; i < count; i++) {
 		auto& handle = p->Handles[i];
 		if (pid && handle.UniqueProcessId != pid)
@@ -226,25 +294,140 @@ bool ObjectManager::EnumHandles(PCWSTR type, DWORD pid, bool namedObjectsOnly) {
 		if (_skipThisProcess && handle.UniqueProcessId == ::GetCurrentProcessId())
 			continue;
 
-		CString name;
-		if (namedObjectsOnly && (name = GetObjectName((HANDLE)handle.HandleValue, (DWORD)handle.UniqueProcessId, handle.ObjectTypeIndex)).IsEmpty())
-			continue;
+		if (namedObjectsOnly)
+			entries.push_back(&handle);
+		else
+			add(handle, CString());
+	}
+
+	return ResolveNames(entries, [&](size_t index, const CString& name, bool) {
+		if (!name.IsEmpty())
+			add(*entries[index], name);
+		}, _cancel);
+}
+
+bool ObjectManager::UpdateHandles(PCWSTR type, DWORD pid, bool namedObjectsOnly) {
+	PROFILE_SCOPE("Enumeration", "UpdateHandles");
+	EnumTypes();
+
+	auto p = QueryHandles(_handlesBuffer, _handlesBufferSize);
+	if (p == nullptr)
+		return false;
+
+	auto filteredTypeIndex = type == nullptr || ::wcslen(type) == 0 ? -1 : _typesNameMap.at(type)->TypeIndex;
+
+	CString stype(type);
+	if (stype != _trackedType || pid != _trackedPid || namedObjectsOnly != _trackedNamedOnly) {
+		_handlesByKey.clear();
+		_trackedType = stype;
+		_trackedPid = pid;
+		_trackedNamedOnly = namedObjectsOnly;
+	}
+
+	auto count = p->NumberOfHandles;
+	bool first = _handlesByKey.empty();
+	if (first)
+		_handlesByKey.reserve(count + count / 8);
+
+	_newHandles.clear();
+	_closedHandles.clear();
+	_handles.clear();
+	_handles.reserve(count);
+	auto generation = ++_generation;
 
-		auto hi = std::make_shared<HandleInfo>();
+	auto add = [&](auto& handle, TrackedHandle& tracked, const CString& name) {
+		auto hi = CreateHandleInfo();
 		hi->HandleValue = (ULONG)handle.HandleValue;
-		hi->GrantedAccess = handle.GrantedAccess;
 		hi->Object = handle.Object;
-		hi->HandleAttributes = handle.HandleAttributes;
 		hi->ProcessId = (ULONG)handle.UniqueProcessId;
 		hi->ObjectTypeIndex = handle.ObjectTypeIndex;
-		hi->Name = name;
+		hi->GrantedAccess = handle.GrantedAccess;
+		hi->HandleAttributes = handle.HandleAttributes;
+		hi->Name = InternName(name);
+		tracked.Handle = std::move(hi);
+		tracked.Included = true;
+		if (!first)
+			_newHandles.push_back(tracked.Handle);
+		_handles.push_back(tracked.Handle);
+	};
 
-		_handles.emplace_back(hi);
+	// new handles waiting for their names
+	HandleEntries entries;
+	std::vector<TrackedHandle*> pending;
+
+	for (decltype(count) i = 0; i < count; i++) {
+		auto& handle = p->Handles[i];
+		if (pid && handle.UniqueProcessId != pid)
+			continue;
+
+		if (filteredTypeIndex >= 0 && handle.ObjectTypeIndex != filteredTypeIndex)
+			continue;
+
+		if (_skipThisProcess && handle.UniqueProcessId == ::GetCurrentProcessId())
+			continue;
+
+		WinSys::HandleKey key((uint32_t)handle.UniqueProcessId, (uint32_t)handle.HandleValue, (size_t)handle.Object);
+		auto [it, inserted] = _handlesByKey.try_emplace(key);
+		auto& tracked = it->second;
+		tracked.Generation = generation;
+		if (inserted) {
+			tracked.Included = false;
+			if (namedObjectsOnly) {
+				entries.push_back(&handle);
+				pending.push_back(&tracked);
+			}
+			else {
+				add(handle, tracked, CString());
+			}
+		}
+		else if (tracked.Included) {
+			auto& hi = tracked.Handle;
+			hi->GrantedAccess = handle.GrantedAccess;
+			// 0x8000 marks a name already looked up by the views
+			hi->HandleAttributes = handle.HandleAttributes | (hi->HandleAttributes & 0x8000);
+			_handles.push_back(hi);
+		}
+	}
+
+	auto resolved = ResolveNames(entries, [&](size_t index, const CString& name, bool completed) {
+		if (!name.IsEmpty())
+			add(*entries[index], *pending[index], name);
+		else if (!completed)
+			// timed out or abandoned: forgotten below, so the next update queries it again
+			pending[index]->Generation = 0;
+		}, _cancel);
+	if (!resolved) {
+		// cancelled handles would be remembered as unnamed
+		_handlesByKey.clear();
+		return false;
+	}
+
+	for (auto it = _handlesByKey.begin(); it != _handlesByKey.end(); ) {
+		if (it->second.Generation != generation) {
+			if (it->second.Included)
+				_closedHandles.push_back(std::move(it->second.Handle));
+			it = _handlesByKey.erase(it);
+		}
+		else {
+			++it;
+		}
 	}
 
 	return true;
 }
 
+void ObjectManager::SetCancelFlag(const std::atomic<bool>* cancel) {
+	_cancel = cancel;
+}
+
+const std::vector<std::shared_ptr<HandleInfo>>& ObjectManager::GetNewHandles() const {
+	return _newHandles;
+}
+
+const std::vector<std::shared_ptr<HandleInfo>>& ObjectManager::GetClosedHandles() const {
+	return _closedHandles;
+}
+
 const std::vector<std::shared_ptr<ObjectInfo>>& ObjectManager::GetObjects() const {
 	return _objects;
 }
@@ -436,67 +619,60 @@ std::vector<GdiObject> ObjectManager::EnumGdiObjects(DWORD pid) {
 bool ObjectManager::GetObjectInfo(ObjectInfo* info, HANDLE hObject, ULONG pid, USHORT type) const {
 	auto hDup = DupHandle(info);
 	if (hDup) {
-		info->Name = GetObjectName(hDup, type);
+		info->Name = GetObjectName(hDup, type, info->Object);
 		::CloseHandle(hDup);
 		return true;
 	}
 	return false;
 }
 
-CString ObjectManager::GetObjectName(HANDLE hObject, ULONG pid, USHORT type) const {
-	auto hDup = DriverHelper::DupHandle(hObject, pid, 0);
+CString ObjectManager::GetObjectName(HANDLE hObject, ULONG pid, USHORT type, PVOID object) const {
 	CString name;
+	if (object && ObjectNameCache::Get().GetName(object, type, name))
+		return name;
+
+	auto hDup = DriverHelper::DupHandle(hObject, pid, 0);
 	if(hDup) {
-		name = GetObjectName(hDup, type);
+		name = GetObjectName(hDup, type, object);
 		::CloseHandle(hDup);
+		if (object)
+			ObjectNameCache::Get().SetName(object, type, name);
 	}
 	return name;
 }
 
-CString ObjectManager::GetObjectName(HANDLE hDup, USHORT type) {
+CString ObjectManager::GetObjectName(HANDLE hDup, USHORT type, PVOID object) {
+	static int fileTypeIndex = _typesNameMap.find(L"File")->second->TypeIndex;
+
+	// special case for files in case they're locked
+	if (type == fileTypeIndex)
+		return ObjectNameResolver::Get().GetName(hDup, type, object);
+
+	return QueryObjectName(hDup, type);
+}
+
+CString ObjectManager::QueryObjectName(HANDLE hDup, USHORT type) {
 	static int processTypeIndex = _typesNameMap.find(L"Process")->second->TypeIndex;
 	static int threadTypeIndex = _typesNameMap.find(L"Thread")->second->TypeIndex;
-	static int fileTypeIndex = _typesNameMap.find(L"File")->second->TypeIndex;
 	ATLASSERT(processTypeIndex > 0 && threadTypeIndex > 0);
 
 	CString sname;
-	do {
-		if (type == processTypeIndex || type == threadTypeIndex)
-			break;
-
-		BYTE buffer[2048];
-		if (type == fileTypeIndex) {
-			// special case for files in case they're locked
-			struct Data {
-				HANDLE hDup;
-				BYTE* buffer;
-			} data = { hDup, buffer };
-
-			wil::unique_handle hThread(::CreateThread(nullptr, 1 << 13, [](auto p) {
-				auto d = (Data*)p;
-				return (DWORD)NT::NtQueryObject(d->hDup, NT::ObjectNameInformation, d->buffer, sizeof(buffer), nullptr);
-				}, &data, STACK_SIZE_PARAM_IS_A_RESERVATION, nullptr));
-			if (::WaitForSingleObject(hThread.get(), 6) == WAIT_TIMEOUT) {
-				::TerminateThread(hThread.get(), 1);
-			}
-			else {
-				DWORD code;
-				::GetExitCodeThread(hThread.get(), &code);
-				if (code == STATUS_SUCCESS) {
-					auto name = (NT::POBJECT_NAME_INFORMATION)buffer;
-					sname = CString(name->Name.Buffer, name->Name.Length / sizeof(WCHAR));
-				}
-			}
-		}
-		else if (NT_SUCCESS(NT::NtQueryObject(hDup, NT::ObjectNameInformation, buffer, sizeof(buffer), nullptr))) {
-			auto name = (NT::POBJECT_NAME_INFORMATION)buffer;
-			sname = CString(name->Name.Buffer, name->Name.Length / sizeof(WCHAR));
-		}
-	} while (false);
-
+	if (type == processTypeIndex || type == threadTypeIndex)
+		return sname;
+
+	BYTE buffer[2048];
+	s_NameQueries++;
+	if (NT_SUCCESS(NT::NtQueryObject(hDup, NT::ObjectNameInformation, buffer, sizeof(buffer), nullptr))) {
+		auto name = (NT::POBJECT_NAME_INFORMATION)buffer;
+		sname = CString(name->Name.Buffer, name->Name.Length / sizeof(WCHAR));
+	}
 	return sname;
 }
 
+uint64_t ObjectManager::GetNameQueryCount() {
+	return s_NameQueries;
+}
+
 std::shared_ptr<ObjectTypeInfo> ObjectManager::GetType(USHORT index) {
 	return _typesMap.at(index);
 }
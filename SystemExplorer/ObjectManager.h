@@ -1,5 +1,9 @@
 #pragma once
 
+#include <Keys.h>
+#include <PoolAllocator.h>
+#include <atomic>
+
 struct ObjectTypeInfo;
 
 enum class PoolType {
@@ -94,10 +98,24 @@ struct ObjectAndHandleStats {
 	int64_t PeakObjects;
 };
 
+struct ObjectRecordStats {
+	WinSys::BlockPoolStats Handles;
+	WinSys::BlockPoolStats Objects;
+	size_t InternedNames;
+	uint64_t InternHits, InternMisses;
+};
+
 class ObjectManager {
 public:
 	bool EnumHandlesAndObjects(PCWSTR type = nullptr, DWORD pid = 0, PCWSTR prefix = nullptr, bool namedOnly = false);
 	bool EnumHandles(PCWSTR type = nullptr, DWORD pid = 0, bool namedObjectsOnly = false);
+	// incremental EnumHandles: keeps the HandleInfo of handles still open (keyed by process, handle and object)
+	// and records the handles opened and closed since the previous call with the same filter
+	bool UpdateHandles(PCWSTR type = nullptr, DWORD pid = 0, bool namedObjectsOnly = false);
+	const std::vector<std::shared_ptr<HandleInfo>>& GetNewHandles() const;
+	const std::vector<std::shared_ptr<HandleInfo>>& GetClosedHandles() const;
+	// name lookups of the Enum/Update calls stop when the flag is set
+	void SetCancelFlag(const std::atomic<bool>* cancel);
 	static int EnumTypes();
 
 	const std::vector<std::shared_ptr<ObjectInfo>>& GetObjects() const;
@@ -125,8 +143,14 @@ public:
 	const std::vector<Change>& GetChanges() const;
 
 	bool GetObjectInfo(ObjectInfo* p, HANDLE hObject, ULONG pid, USHORT type) const;
-	CString GetObjectName(HANDLE hObject, ULONG pid, USHORT type) const;
-	static CString GetObjectName(HANDLE hDup, USHORT type);
+	// object is the kernel address used as the name cache key, if known
+	CString GetObjectName(HANDLE hObject, ULONG pid, USHORT type, PVOID object = nullptr) const;
+	// object is the kernel address, if known, so a file object whose name query timed out is not queried again
+	static CString GetObjectName(HANDLE hDup, USHORT type, PVOID object = nullptr);
+	// no time limit; may block indefinitely on some file objects
+	static CString QueryObjectName(HANDLE hDup, USHORT type);
+	// NtQueryObject name queries made by QueryObjectName so far, cache misses and the resolver's included
+	static uint64_t GetNameQueryCount();
 
 
 	static std::shared_ptr<ObjectTypeInfo> GetType(USHORT index);
@@ -134,6 +158,13 @@ public:
 	static const std::vector<std::shared_ptr<ObjectTypeInfo>>& GetObjectTypes();
 	const std::vector<std::shared_ptr<HandleInfo>>& GetHandles() const;
 
+	// records are allocated from shared pools rather than one heap allocation each
+	static std::shared_ptr<HandleInfo> CreateHandleInfo();
+	static std::shared_ptr<ObjectInfo> CreateObjectInfo();
+	// returns a string sharing its buffer with earlier equal names
+	static CString InternName(const CString& name);
+	static ObjectRecordStats GetRecordStats();
+
 	static std::vector<ObjectNameAndType> EnumDirectoryObjects(PCWSTR path);
 	static CString GetSymbolicLinkTarget(PCWSTR path);
 
@@ -145,8 +176,27 @@ private:
 	std::vector<std::shared_ptr<ObjectInfo>> _objects;
 	std::unordered_map<PVOID, std::shared_ptr<ObjectInfo>> _objectsByAddress;
 	std::vector<std::shared_ptr<HandleInfo>> _handles;
+
+	struct TrackedHandle {
+		std::shared_ptr<HandleInfo> Handle;
+		uint32_t Generation;
+		// false if filtered out (e.g. unnamed), so the name is not looked up again
+		bool Included;
+	};
+	std::unordered_map<WinSys::HandleKey, TrackedHandle> _handlesByKey;
+	std::vector<std::shared_ptr<HandleInfo>> _newHandles, _closedHandles;
+	CString _trackedType;
+	DWORD _trackedPid{ 0 };
+	bool _trackedNamedOnly{ false };
+	uint32_t _generation{ 0 };
+
+	// kept between calls; its size is the hint for the next query
+	std::unique_ptr<BYTE[]> _handlesBuffer;
+	ULONG _handlesBufferSize{ 0 };
+
 	static std::vector<Change> _changes;
 	static int64_t _totalHandles, _totalObjects;
 	bool _skipThisProcess = false;
+	const std::atomic<bool>* _cancel{ nullptr };
 };
 
@@ -0,0 +1,131 @@
+#include "pch.h"
+#include "ObjectNameCache.h"
+
+ObjectNameCache& ObjectNameCache::Get() {
+	static ObjectNameCache cache;
+	return cache;
+}
+
+bool ObjectNameCache::GetName(PVOID object, USHORT type, CString& name) {
+	auto lock = _lock.lock_exclusive();
+	auto entry = Find(object, type);
+	if (entry == nullptr || !entry->HasName) {
+		_misses++;
+		return false;
+	}
+	_hits++;
+	name = entry->Name;
+	return true;
+}
+
+void ObjectNameCache::SetName(PVOID object, USHORT type, const CString& name) {
+	if (object == nullptr)
+		return;
+
+	auto lock = _lock.lock_exclusive();
+	auto& entry = FindOrAdd(object, type);
+	entry.Name = name;
+	entry.HasName = true;
+}
+
+bool ObjectNameCache::GetDetails(PVOID object, USHORT type, CString& details, uint32_t maxAge) {
+	auto lock = _lock.lock_exclusive();
+	auto entry = Find(object, type);
+	if (entry == nullptr || entry->DetailsTick == 0 || ::GetTickCount64() - entry->DetailsTick > maxAge) {
+		_detailsMisses++;
+		return false;
+	}
+	_detailsHits++;
+	details = entry->Details;
+	return true;
+}
+
+void ObjectNameCache::SetDetails(PVOID object, USHORT type, const CString& details) {
+	if (object == nullptr)
+		return;
+
+	auto lock = _lock.lock_exclusive();
+	auto& entry = FindOrAdd(object, type);
+	entry.Details = details;
+	entry.DetailsTick = ::GetTickCount64();
+}
+
+void ObjectNameCache::Invalidate(PVOID object) {
+	auto lock = _lock.lock_exclusive();
+	if (auto it = _index.find(object); it != _index.end()) {
+		_entries.erase(it->second);
+		_index.erase(it);
+		_invalidations++;
+	}
+}
+
+void ObjectNameCache::Retain(const NT::SYSTEM_HANDLE_INFORMATION_EX* handles) {
+	auto lock = _lock.lock_exclusive();
+	if (_index.empty())
+		return;
+
+	auto epoch = ++_epoch;
+	auto count = handles->NumberOfHandles;
+	for (decltype(count) i = 0; i < count; i++) {
+		if (auto it = _index.find(handles->Handles[i].Object); it != _index.end())
+			it->second->Epoch = epoch;
+	}
+
+	for (auto it = _entries.begin(); it != _entries.end(); ) {
+		if (it->Epoch != epoch) {
+			_index.erase(it->Object);
+			it = _entries.erase(it);
+			_invalidations++;
+		}
+		else {
+			++it;
+		}
+	}
+}
+
+void ObjectNameCache::SetCapacity(size_t capacity) {
+	auto lock = _lock.lock_exclusive();
+	// the newest entry is never evicted
+	_capacity = capacity ? capacity : 1;
+	Trim();
+}
+
+ObjectNameCacheStats ObjectNameCache::GetStats() const {
+	auto lock = _lock.lock_shared();
+	return ObjectNameCacheStats{ _hits, _misses, _detailsHits, _detailsMisses, _evictions, _invalidations, _index.size() };
+}
+
+ObjectNameCache::Entry* ObjectNameCache::Find(PVOID object, USHORT type) {
+	auto it = _index.find(object);
+	if (it == _index.end())
+		return nullptr;
+
+	auto& entry = *it->second;
+	if (entry.TypeIndex != type) {
+		// the address was reused by an object of another type
+		_entries.erase(it->second);
+		_index.erase(it);
+		_invalidations++;
+		return nullptr;
+	}
+	_entries.splice(_entries.begin(), _entries, it->second);
+	return &entry;
+}
+
+ObjectNameCache::Entry& ObjectNameCache::FindOrAdd(PVOID object, USHORT type) {
+	if (auto entry = Find(object, type); entry)
+		return *entry;
+
+	_entries.push_front(Entry{ object, type });
+	_index.insert({ object, _entries.begin() });
+	Trim();
+	return _entries.front();
+}
+
+void ObjectNameCache::Trim() {
+	while (_index.size() > _capacity) {
+		_index.erase(_entries.back().Object);
+		_entries.pop_back();
+		_evictions++;
+	}
+}
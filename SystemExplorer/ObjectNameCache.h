@@ -0,0 +1,79 @@
+#pragma once
+
+#include <list>
+#include "NtDll.h"
+
+//
+// process wide LRU cache of object names (and type specific details) keyed by kernel object address.
+// entries are dropped when their object no longer appears in the system handle table (see Retain).
+// an object freed and another of the same type created at the same address between two handle
+// table queries keeps the old name until the next query
+//
+
+struct ObjectNameCacheStats {
+	// name lookups
+	uint64_t Hits;
+	uint64_t Misses;
+	// details lookups, which replace type specific queries rather than name queries
+	uint64_t DetailsHits;
+	uint64_t DetailsMisses;
+	uint64_t Evictions;
+	uint64_t Invalidations;
+	size_t Entries;
+
+	double GetHitRate() const {
+		return Hits + Misses ? Hits * 100.0 / (Hits + Misses) : 0;
+	}
+	double GetDetailsHitRate() const {
+		return DetailsHits + DetailsMisses ? DetailsHits * 100.0 / (DetailsHits + DetailsMisses) : 0;
+	}
+};
+
+class ObjectNameCache final {
+public:
+	static ObjectNameCache& Get();
+
+	bool GetName(PVOID object, USHORT type, CString& name);
+	void SetName(PVOID object, USHORT type, const CString& name);
+
+	// details older than maxAge msec are treated as missing
+	bool GetDetails(PVOID object, USHORT type, CString& details, uint32_t maxAge);
+	void SetDetails(PVOID object, USHORT type, const CString& details);
+
+	void Invalidate(PVOID object);
+	// drops the entries of objects not referenced by any handle in the table
+	void Retain(const NT::SYSTEM_HANDLE_INFORMATION_EX* handles);
+
+	void SetCapacity(size_t capacity);
+	ObjectNameCacheStats GetStats() const;
+
+private:
+	ObjectNameCache() = default;
+	ObjectNameCache(const ObjectNameCache&) = delete;
+	ObjectNameCache& operator=(const ObjectNameCache&) = delete;
+
+	struct Entry {
+		PVOID Object;
+		USHORT TypeIndex;
+		bool HasName{ false };
+		CString Name;
+		CString Details;
+		ULONGLONG DetailsTick{ 0 };
+		uint32_t Epoch{ 0 };
+	};
+	using EntryList = std::list<Entry>;
+
+	// lock held
+	Entry* Find(PVOID object, USHORT type);
+	Entry& FindOrAdd(PVOID object, USHORT type);
+	void Trim();
+
+private:
+	mutable wil::srwlock _lock;
+	// most recently used first
+	EntryList _entries;
+	std::unordered_map<PVOID, EntryList::iterator> _index;
+	size_t _capacity{ 1 << 16 };
+	uint32_t _epoch{ 0 };
+	uint64_t _hits{ 0 }, _misses{ 0 }, _detailsHits{ 0 }, _detailsMisses{ 0 }, _evictions{ 0 }, _invalidations{ 0 };
+};
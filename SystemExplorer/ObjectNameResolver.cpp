@@ -0,0 +1,311 @@
+#include "pch.h"
+#include "ObjectNameResolver.h"
+#include "ObjectManager.h"
+#include "DriverHelper.h"
+#include <PerfCounter.h>
+
+using namespace WinSys;
+
+namespace {
+	// past this many stuck workers, requests that may block are no longer run
+	const uint32_t MaxStuckWorkers = 8;
+	// an address may be reused by another object once the stuck one is gone, so the set starts over when full
+	const size_t MaxTimedOutObjects = 1024;
+	// msec between checks of the cancel flag while waiting for results
+	const uint32_t CancelPollInterval = 50;
+
+	// only file objects' name queries may block (e.g. synchronous pipes with a pending read)
+	bool MayBlock(USHORT type) {
+		static const auto fileTypeIndex = ObjectManager::GetType(L"File")->TypeIndex;
+		return type == fileTypeIndex;
+	}
+}
+
+struct ObjectNameResolver::Result {
+	size_t Index;
+	CString Name;
+	bool Completed;
+};
+
+struct ObjectNameResolver::Batch {
+	const std::vector<Request>* Requests;
+	const std::atomic<bool>* Cancel;
+	// guarded by the resolver lock
+	std::vector<Result> Results;
+	size_t Pending;
+	// a worker started a request with a deadline, so the wait for results needs a timeout
+	bool DeadlineStarted{ false };
+	std::condition_variable ResultReady;
+};
+
+struct ObjectNameResolver::Worker {
+	ObjectNameResolver* Resolver;
+	// guarded by the resolver lock
+	Job Current{ nullptr, 0 };
+	// PerfCounter time, 0 if the current request can't block
+	int64_t Deadline{ 0 };
+	bool Abandoned{ false };
+};
+
+ObjectNameResolver& ObjectNameResolver::Get() {
+	// never destroyed, as abandoned workers may still be running at exit
+	static auto resolver = new ObjectNameResolver;
+	return *resolver;
+}
+
+ObjectNameResolver::ObjectNameResolver() {
+	auto cpus = ::GetActiveProcessorCount(ALL_PROCESSOR_GROUPS);
+	_maxWorkers = cpus < 2 ? 2 : (cpus > 8 ? 8 : cpus);
+	_workers.reserve(_maxWorkers);
+}
+
+bool ObjectNameResolver::Resolve(const std::vector<Request>& requests, const ResultHandler& onResult, const std::atomic<bool>* cancel) {
+	if (requests.empty())
+		return true;
+
+	auto start = PerfCounter::Now();
+	Batch batch;
+	batch.Requests = &requests;
+	batch.Cancel = cancel;
+	batch.Pending = requests.size();
+	batch.Results.reserve(256);
+	_requests += requests.size();
+
+	{
+		std::lock_guard locker(_lock);
+		while (_workers.size() < _maxWorkers && StartWorker())
+			;
+		if (_nextJob == _jobs.size()) {
+			_jobs.clear();
+			_nextJob = 0;
+		}
+		_jobs.reserve(_jobs.size() + requests.size());
+		for (size_t i = 0; i < requests.size(); i++) {
+			if (ShouldSkip(requests[i])) {
+				_skipped++;
+				Fail(&batch, i);
+			}
+			else {
+				_jobs.push_back({ &batch, i });
+			}
+		}
+		if (_workers.empty())
+			DropQueuedJobs(nullptr);
+	}
+	_jobReady.notify_all();
+
+	std::vector<Result> results;
+	results.reserve(256);
+	int64_t deadline = 0;
+	bool done = false;
+	while (!done) {
+		{
+			std::unique_lock locker(_lock);
+			// woken by results and by workers starting requests with a deadline; otherwise only when the
+			// earliest deadline passes or to check the cancel flag
+			auto wait = INFINITE;
+			if (deadline) {
+				auto now = PerfCounter::Now();
+				wait = deadline > now ? static_cast<DWORD>((deadline - now + 9999) / 10000) : 0;
+			}
+			if (cancel && wait > CancelPollInterval)
+				wait = CancelPollInterval;
+			auto wake = [&]() {
+				return !batch.Results.empty() || batch.Pending == 0 || batch.DeadlineStarted;
+			};
+			if (wait == INFINITE)
+				batch.ResultReady.wait(locker, wake);
+			else
+				batch.ResultReady.wait_for(locker, std::chrono::milliseconds(wait), wake);
+			batch.DeadlineStarted = false;
+			if (cancel && *cancel)
+				DropQueuedJobs(&batch);
+			deadline = CheckDeadlines(&batch);
+			results.swap(batch.Results);
+			done = batch.Pending == 0 && batch.Results.empty();
+		}
+		for (auto& result : results)
+			onResult(result.Index, result.Name, result.Completed);
+		results.clear();
+	}
+
+	_resolveTime += (PerfCounter::Now() - start) / 10000;
+	return !(cancel && *cancel);
+}
+
+CString ObjectNameResolver::GetName(HANDLE hDup, USHORT type, PVOID object) {
+	// the worker gets its own handle, as it may outlive this call if it gets stuck
+	HANDLE hLocal;
+	if (!::DuplicateHandle(::GetCurrentProcess(), hDup, ::GetCurrentProcess(), &hLocal, 0, FALSE, DUPLICATE_SAME_ACCESS))
+		return L"";
+
+	std::vector<Request> requests{ Request{ hLocal, ::GetCurrentProcessId(), type, true, object } };
+	CString result;
+	Resolve(requests, [&](auto, auto& name, auto) { result = name; });
+	return result;
+}
+
+void ObjectNameResolver::SetDeadline(uint32_t msec) {
+	_deadline = msec;
+}
+
+ObjectNameStats ObjectNameResolver::GetStats() const {
+	ObjectNameStats stats;
+	stats.Requests = _requests;
+	stats.Resolved = _resolved;
+	stats.TimedOut = _timedOut;
+	stats.Cancelled = _cancelled;
+	stats.Skipped = _skipped;
+	stats.ResolveTime = _resolveTime;
+	std::lock_guard locker(_lock);
+	stats.Workers = static_cast<uint32_t>(_workers.size());
+	stats.StuckWorkers = _stuckWorkers;
+	return stats;
+}
+
+bool ObjectNameResolver::StartWorker() {
+	// lock held
+	auto worker = std::make_shared<Worker>();
+	worker->Resolver = this;
+	auto param = new std::shared_ptr<Worker>(worker);
+	wil::unique_handle hThread(::CreateThread(nullptr, 1 << 16, WorkerThread, param, STACK_SIZE_PARAM_IS_A_RESERVATION, nullptr));
+	if (!hThread) {
+		delete param;
+		return false;
+	}
+	_workers.push_back(std::move(worker));
+	return true;
+}
+
+DWORD ObjectNameResolver::WorkerThread(PVOID param) {
+	auto p = static_cast<std::shared_ptr<Worker>*>(param);
+	auto worker = std::move(*p);
+	delete p;
+	worker->Resolver->RunWorker(worker.get());
+	return 0;
+}
+
+void ObjectNameResolver::RunWorker(Worker* worker) {
+	for (;;) {
+		Request request;
+		Batch* batch;
+		size_t index;
+		{
+			std::unique_lock locker(_lock);
+			_jobReady.wait(locker, [&]() { return _nextJob < _jobs.size(); });
+			auto job = _jobs[_nextJob++];
+			if (job.Owner == nullptr)
+				continue;
+
+			batch = job.Owner;
+			index = job.Index;
+			request = (*batch->Requests)[index];
+			if (batch->Cancel && *batch->Cancel) {
+				_cancelled++;
+				Fail(batch, index);
+				continue;
+			}
+			// workers may have got stuck since the request was queued
+			if (ShouldSkip(request)) {
+				_skipped++;
+				Fail(batch, index);
+				continue;
+			}
+			worker->Current = job;
+			worker->Deadline = 0;
+			if (MayBlock(request.TypeIndex)) {
+				worker->Deadline = PerfCounter::Now() + _deadline * 10000LL;
+				batch->DeadlineStarted = true;
+				batch->ResultReady.notify_one();
+			}
+		}
+
+		CString name;
+		auto hDup = request.Local ? request.Handle : DriverHelper::DupHandle(request.Handle, request.ProcessId, 0);
+		if (hDup) {
+			// may block for a long time on some file objects
+			name = ObjectManager::QueryObjectName(hDup, request.TypeIndex);
+			::CloseHandle(hDup);
+		}
+
+		std::lock_guard locker(_lock);
+		if (worker->Abandoned) {
+			// the request was already completed as timed out and a replacement was started
+			_stuckWorkers--;
+			return;
+		}
+		worker->Current = { nullptr, 0 };
+		if (!name.IsEmpty())
+			_resolved++;
+		Complete(batch, index, std::move(name), true);
+	}
+}
+
+bool ObjectNameResolver::ShouldSkip(const Request& request) const {
+	// lock held
+	if (!MayBlock(request.TypeIndex))
+		return false;
+	return _stuckWorkers >= MaxStuckWorkers || (request.Object && _timedOutObjects.find(request.Object) != _timedOutObjects.end());
+}
+
+int64_t ObjectNameResolver::CheckDeadlines(Batch* batch) {
+	// lock held
+	auto now = PerfCounter::Now();
+	int64_t next = 0;
+	uint32_t abandoned = 0;
+	for (auto it = _workers.begin(); it != _workers.end(); ) {
+		auto& worker = *it;
+		if (worker->Current.Owner != batch || worker->Deadline == 0 || now <= worker->Deadline) {
+			if (worker->Current.Owner == batch && worker->Deadline && (next == 0 || worker->Deadline < next))
+				next = worker->Deadline;
+			++it;
+			continue;
+		}
+		worker->Abandoned = true;
+		_stuckWorkers++;
+		_timedOut++;
+		if (auto object = (*batch->Requests)[worker->Current.Index].Object) {
+			if (_timedOutObjects.size() >= MaxTimedOutObjects)
+				_timedOutObjects.clear();
+			_timedOutObjects.insert(object);
+		}
+		Complete(batch, worker->Current.Index, L"", false);
+		it = _workers.erase(it);
+		abandoned++;
+	}
+
+	while (abandoned-- > 0 && StartWorker())
+		;
+	// no worker left to run them (threads could not be created); other batches may be waiting without a deadline
+	if (_workers.empty())
+		DropQueuedJobs(nullptr);
+	return next;
+}
+
+void ObjectNameResolver::Complete(Batch* batch, size_t index, CString name, bool completed) {
+	// lock held
+	batch->Results.push_back({ index, std::move(name), completed });
+	batch->Pending--;
+	batch->ResultReady.notify_one();
+}
+
+void ObjectNameResolver::Fail(Batch* batch, size_t index) {
+	// lock held
+	auto& request = (*batch->Requests)[index];
+	if (request.Local)
+		::CloseHandle(request.Handle);
+	Complete(batch, index, L"", false);
+}
+
+void ObjectNameResolver::DropQueuedJobs(Batch* batch) {
+	// lock held
+	for (auto i = _nextJob; i < _jobs.size(); i++) {
+		auto& job = _jobs[i];
+		if (job.Owner == nullptr || (batch && job.Owner != batch))
+			continue;
+
+		_cancelled++;
+		Fail(job.Owner, job.Index);
+		job.Owner = nullptr;
+	}
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <unordered_set>
+
+//
+// resolves object names on a bounded pool of worker threads.
+// querying the name of some file objects blocks indefinitely (e.g. synchronous pipes with a pending read),
+// so requests for file objects have a deadline; a worker stuck past it is abandoned (not terminated)
+// and replaced. the object it was querying is not queried again, and while too many workers are stuck,
+// requests that may block fail without a query
+//
+
+struct ObjectNameStats {
+	uint64_t Requests;
+	uint64_t Resolved;
+	uint64_t TimedOut;
+	uint64_t Cancelled;
+	// failed without a query: objects that timed out before, or requests that may block while too many workers are stuck
+	uint64_t Skipped;
+	// wall time spent in Resolve, in msec
+	uint64_t ResolveTime;
+	uint32_t Workers;
+	uint32_t StuckWorkers;
+
+	double GetThroughput() const {
+		return ResolveTime ? Requests * 1000.0 / ResolveTime : 0;
+	}
+};
+
+class ObjectNameResolver final {
+public:
+	static ObjectNameResolver& Get();
+
+	struct Request {
+		// handle in the process below, or a handle in this process owned (and closed) by the resolver if Local is true
+		HANDLE Handle;
+		ULONG ProcessId;
+		USHORT TypeIndex;
+		bool Local{ false };
+		// kernel address of the object, if known, to skip objects whose query timed out before
+		PVOID Object{ nullptr };
+	};
+
+	// completed is false for requests that timed out or were cancelled (as opposed to objects with no name)
+	using ResultHandler = std::function<void(size_t index, const CString& name, bool completed)>;
+
+	// resolves the names of a batch in parallel. onResult is called on the calling thread as names arrive
+	// (not in request order) with an empty name for failed, timed out or cancelled requests.
+	// returns false if cancelled
+	bool Resolve(const std::vector<Request>& requests, const ResultHandler& onResult, const std::atomic<bool>* cancel = nullptr);
+
+	// single local handle; hDup is not used by the resolver after the call returns
+	CString GetName(HANDLE hDup, USHORT type, PVOID object = nullptr);
+
+	void SetDeadline(uint32_t msec);
+	ObjectNameStats GetStats() const;
+
+private:
+	ObjectNameResolver();
+	ObjectNameResolver(const ObjectNameResolver&) = delete;
+	ObjectNameResolver& operator=(const ObjectNameResolver&) = delete;
+
+	struct Result;
+	struct Batch;
+	struct Worker;
+	struct Job {
+		Batch* Owner;
+		size_t Index;
+	};
+
+	static DWORD WINAPI WorkerThread(PVOID param);
+	void RunWorker(Worker* worker);
+	bool StartWorker();
+	// the following are called with the lock held
+	bool ShouldSkip(const Request& request) const;
+	// abandons the batch's workers past their deadline, returns the earliest deadline still pending (0 if none)
+	int64_t CheckDeadlines(Batch* batch);
+	void Complete(Batch* batch, size_t index, CString name, bool completed);
+	// completes the request as failed without querying it
+	void Fail(Batch* batch, size_t index);
+	// all batches' jobs if batch is nullptr
+	void DropQueuedJobs(Batch* batch);
+
+private:
+	mutable std::mutex _lock;
+	std::condition_variable _jobReady;
+	std::vector<Job> _jobs;
+	size_t _nextJob{ 0 };
+	std::vector<std::shared_ptr<Worker>> _workers;
+	uint32_t _maxWorkers;
+	uint32_t _stuckWorkers{ 0 };
+	std::unordered_set<PVOID> _timedOutObjects;
+	std::atomic<uint32_t> _deadline{ 20 };
+
+	std::atomic<uint64_t> _requests{ 0 }, _resolved{ 0 }, _timedOut{ 0 }, _cancelled{ 0 }, _skipped{ 0 }, _resolveTime{ 0 };
+};
@@ -0,0 +1,65 @@
+#include "pch.h"
+#include "ObjectManager.h"
+#include <unordered_set>
+
+//
+// the pooled handle and object records and the name pool.
+// kept apart from the rest of ObjectManager as they make no system calls, so the tests can build them
+//
+
+namespace {
+	struct NameHash {
+		size_t operator()(const CString& name) const {
+			return std::hash<std::wstring_view>()(std::wstring_view(name, name.GetLength()));
+		}
+	};
+
+	struct NamePool {
+		wil::srwlock Lock;
+		std::unordered_set<CString, NameHash> Names;
+		uint64_t Hits{ 0 }, Misses{ 0 };
+	};
+
+	NamePool& GetNamePool() {
+		static NamePool pool;
+		return pool;
+	}
+}
+
+std::shared_ptr<HandleInfo> ObjectManager::CreateHandleInfo() {
+	return std::allocate_shared<HandleInfo>(WinSys::PoolAllocator<HandleInfo>());
+}
+
+std::shared_ptr<ObjectInfo> ObjectManager::CreateObjectInfo() {
+	return std::allocate_shared<ObjectInfo>(WinSys::PoolAllocator<ObjectInfo>());
+}
+
+CString ObjectManager::InternName(const CString& name) {
+	if (name.IsEmpty())
+		return name;
+
+	auto& pool = GetNamePool();
+	auto lock = pool.Lock.lock_exclusive();
+	if (auto it = pool.Names.find(name); it != pool.Names.end()) {
+		pool.Hits++;
+		return *it;
+	}
+	// names no longer referenced elsewhere stay alive in the pool; start over once it gets big
+	if (pool.Names.size() >= 1 << 16)
+		pool.Names.clear();
+	pool.Misses++;
+	pool.Names.insert(name);
+	return name;
+}
+
+ObjectRecordStats ObjectManager::GetRecordStats() {
+	ObjectRecordStats stats;
+	stats.Handles = WinSys::BlockPool<HandleInfo>::Get().GetStats();
+	stats.Objects = WinSys::BlockPool<ObjectInfo>::Get().GetStats();
+	auto& pool = GetNamePool();
+	auto lock = pool.Lock.lock_shared();
+	stats.InternedNames = pool.Names.size();
+	stats.InternHits = pool.Hits;
+	stats.InternMisses = pool.Misses;
+	return stats;
+}
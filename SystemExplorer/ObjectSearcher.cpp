@@ -2,66 +2,163 @@
 #include "ObjectSearcher.h"
 #include "ObjectManager.h"
 #include "ProcessManager.h"
+#include "SnapshotBus.h"
+#include "SearchIndex.h"
+#include <TextMatcher.h>
+#include <string_view>
+
+namespace {
+	std::vector<DWORD> GetProcessIds() {
+		std::vector<DWORD> pids;
+		wil::unique_handle hSnapshot(::CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0));
+		if (!hSnapshot)
+			return pids;
+
+		PROCESSENTRY32 pe;
+		pe.dwSize = sizeof(pe);
+		if (!::Process32First(hSnapshot.get(), &pe))
+			return pids;
+
+		pids.reserve(512);
+		do {
+			// the idle process has no modules
+			if (pe.th32ProcessID)
+				pids.push_back(pe.th32ProcessID);
+		} while (::Process32Next(hSnapshot.get(), &pe));
+		return pids;
+	}
+
+	// what a Default search covers, from the index or not, so both return the same kinds of results
+	const auto DefaultSearchTypes = ObjectSearchType::Handles | ObjectSearchType::DLLs;
+
+	struct PathHash {
+		using is_transparent = void;
+		size_t operator()(std::wstring_view path) const {
+			return std::hash<std::wstring_view>()(path);
+		}
+	};
+}
+
+//
+// state shared by the DLL search workers. each worker takes the next process until none are left,
+// so a worker stuck on a slow process doesn't hold back the others
+//
+
+struct ObjectSearcher::DllSearch {
+	ObjectSearcher* Searcher;
+	WinSys::TextMatcher Matcher;
+	std::vector<DWORD> Pids;
+	std::atomic<size_t> Next{ 0 };
+	// match result per module path; most DLLs are loaded in many processes, so each path is matched once
+	std::unordered_map<std::wstring, bool, PathHash, std::equal_to<>> Modules;
+	wil::srwlock ModulesLock;
+
+	bool IsMatch(const MODULEENTRY32& me) {
+		std::wstring_view path(me.szExePath);
+		{
+			auto lock = ModulesLock.lock_shared();
+			if (auto it = Modules.find(path); it != Modules.end())
+				return it->second;
+		}
+		auto match = Matcher.Contains(me.szModule);
+
+		auto lock = ModulesLock.lock_exclusive();
+		Modules.try_emplace(std::wstring(path), match);
+		return match;
+	}
+};
 
 ObjectSearcher::ObjectSearcher(HWND hWnd, ObjectSearchType searchType, DWORD pid, const CString& filter)
-	: _hWnd(hWnd), _type(searchType), _pid(pid), _filter(filter) {
+	: _hWnd(hWnd), _type(searchType == ObjectSearchType::Default ? DefaultSearchTypes : searchType), _pid(pid), _filter(filter) {
+	_hDone.reset(::CreateEvent(nullptr, TRUE, TRUE, nullptr));
+}
+
+ObjectSearcher::~ObjectSearcher() {
+	Cancel();
+	if (_hDone)
+		::WaitForSingleObject(_hDone.get(), INFINITE);
 }
 
 void ObjectSearcher::SearchAsync(const CString& text) {
 	_text = text;
-	::QueueUserWorkItem([](PVOID p) -> DWORD {
+	_cancelRequested = false;
+	_running = true;
+	::ResetEvent(_hDone.get());
+	if (!::QueueUserWorkItem([](PVOID p) -> DWORD {
 		((ObjectSearcher*)p)->DoSearch();
 		return 0;
-		}, this, WT_EXECUTEDEFAULT);
+		}, this, WT_EXECUTELONGFUNCTION)) {
+		_running = false;
+		::SetEvent(_hDone.get());
+		::PostMessage(_hWnd, SearchDoneMessage, 1, 0);
+	}
 }
 
-std::vector<SearchResultItem> ObjectSearcher::GetResults() {
+void ObjectSearcher::Cancel() {
+	_cancelRequested = true;
+}
+
+size_t ObjectSearcher::GetResults(std::vector<SearchResultItem>& items, size_t from) {
 	std::lock_guard locker(_lock);
-	auto results = _items;
-	return results;
+	if (from < _items.size())
+		items.insert(items.end(), _items.begin() + from, _items.end());
+	return _items.size();
 }
 
-void ObjectSearcher::DoSearch() {
-	_running = true;
-	_cancelRequested = false;
-	CString stext(_text);
-	stext.MakeLower();
-	_items.clear();
-	_items.reserve(64);
+void ObjectSearcher::AddResults(std::vector<SearchResultItem>& items) {
+	std::lock_guard locker(_lock);
+	for (auto& item : items)
+		_items.emplace_back(std::move(item));
+	items.clear();
+}
 
-	auto type = _type;
-	if (type == ObjectSearchType::Default)
-		type = ObjectSearchType::Handles | ObjectSearchType::DLLs;
+void ObjectSearcher::DoSearch() {
+	WinSys::TextMatcher matcher(std::wstring_view(_text, _text.GetLength()));
+	{
+		std::lock_guard locker(_lock);
+		_items.clear();
+		_items.reserve(64);
+	}
 
-	if ((type & ObjectSearchType::DLLs) == ObjectSearchType::DLLs)
-		SearchDLLs(stext);
+	if (!SearchFromIndex(_text)) {
+		if ((_type & ObjectSearchType::DLLs) == ObjectSearchType::DLLs)
+			SearchDLLs(matcher);
 
-	if ((type & ObjectSearchType::Handles) == ObjectSearchType::Handles)
-		SearchHandles(stext);
+		if ((_type & ObjectSearchType::Handles) == ObjectSearchType::Handles)
+			SearchHandles(matcher);
+	}
 
 	// when done, post message
-	::PostMessage(_hWnd, SearchDoneMessage, _cancelRequested ? 1 : 0, 0);
 	_running = false;
+	::PostMessage(_hWnd, SearchDoneMessage, _cancelRequested ? 1 : 0, 0);
+	// last, as the object may be destroyed right after
+	::SetEvent(_hDone.get());
 }
 
-void ObjectSearcher::CancelSearch() {
-	_cancelRequested = true;
+bool ObjectSearcher::SearchFromIndex(const CString& text) {
+	// the index has no per process or per type filtering
+	auto& index = SearchIndex::Get();
+	if (_pid || !_filter.IsEmpty() || !index.IsReady())
+		return false;
+
+	auto items = index.Find(text, _type);
+	AddResults(items);
+	return true;
 }
 
-void ObjectSearcher::SearchHandles(const CString& stext) {
+void ObjectSearcher::SearchHandles(const WinSys::TextMatcher& matcher) {
 	ObjectManager om;
 	WinSys::ProcessManager pm;
-	pm.EnumProcesses();
+	SnapshotBus::Get().UpdateProcesses(pm);
 
+	om.SetCancelFlag(&_cancelRequested);
 	om.EnumHandles(_filter, _pid, true);
 
 	for (auto& h : om.GetHandles()) {
 		if (_cancelRequested)
 			break;
 
-		CString name(h->Name);
-		name.MakeLower();
-		if (name.Find(stext) >= 0) {
+		if (matcher.Contains(std::wstring_view(h->Name, h->Name.GetLength()))) {
 			SearchResultItem item;
 			item.Id = h->HandleValue;
 			item.Name = h->Name;
@@ -75,40 +172,62 @@ void ObjectSearcher::SearchHandles(const CString& stext) {
 	}
 }
 
-void ObjectSearcher::SearchDLLs(const CString& text) {
-	wil::unique_handle hSnapshot(::CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0));
-	if (!hSnapshot)
+void ObjectSearcher::SearchDLLs(const WinSys::TextMatcher& matcher) {
+	DllSearch search;
+	search.Searcher = this;
+	search.Matcher = matcher;
+	search.Pids = GetProcessIds();
+	if (search.Pids.empty())
 		return;
 
-	PROCESSENTRY32 pe;
-	pe.dwSize = sizeof(pe);
-	::Process32First(hSnapshot.get(), &pe);
+	auto workers = ::GetActiveProcessorCount(ALL_PROCESSOR_GROUPS);
+	if (workers > search.Pids.size())
+		workers = static_cast<DWORD>(search.Pids.size());
 
+	wil::unique_threadpool_work work(::CreateThreadpoolWork([](PTP_CALLBACK_INSTANCE, PVOID context, PTP_WORK) {
+		auto search = static_cast<DllSearch*>(context);
+		search->Searcher->SearchProcessDLLs(*search);
+		}, &search, nullptr));
+	if (!work) {
+		SearchProcessDLLs(search);
+		return;
+	}
+
+	for (DWORD i = 0; i < workers; i++)
+		::SubmitThreadpoolWork(work.get());
+	::WaitForThreadpoolWorkCallbacks(work.get(), FALSE);
+}
+
+void ObjectSearcher::SearchProcessDLLs(DllSearch& search) {
 	MODULEENTRY32 me;
 	me.dwSize = sizeof(me);
+	std::vector<SearchResultItem> found;
 
-	while (::Process32Next(hSnapshot.get(), &pe)) {
-		wil::unique_handle hModules(::CreateToolhelp32Snapshot(TH32CS_SNAPMODULE, pe.th32ProcessID));
-		if (!hModules)
+	while (!_cancelRequested) {
+		auto index = search.Next++;
+		if (index >= search.Pids.size())
+			break;
+
+		auto pid = search.Pids[index];
+		wil::unique_handle hModules(::CreateToolhelp32Snapshot(TH32CS_SNAPMODULE, pid));
+		if (!hModules || !::Module32First(hModules.get(), &me))
 			continue;
 
-		if (::Module32First(hModules.get(), &me)) {
-			do {
-				CString name(me.szModule);
-				name.MakeLower();
-				if (name.Find(text) >= 0) {
-					SearchResultItem item;
-					item.Id = (DWORD64)me.modBaseAddr;
-					item.Name = me.szModule;
-					item.Type = L"DLL";
-					item.ProcessId = pe.th32ProcessID;
-					item.Details = me.szExePath;
-
-					std::lock_guard locker(_lock);
-					_items.emplace_back(std::move(item));
-				}
-			} while (::Module32Next(hModules.get(), &me));
-		}
+		do {
+			if (!search.IsMatch(me))
+				continue;
 
+			SearchResultItem item;
+			item.Id = (DWORD64)me.modBaseAddr;
+			item.Name = me.szModule;
+			item.Type = L"DLL";
+			item.ProcessId = pid;
+			item.Details = me.szExePath;
+			found.emplace_back(std::move(item));
+		} while (!_cancelRequested && ::Module32Next(hModules.get(), &me));
+
+		// per process, so results show up as the search progresses
+		if (!found.empty())
+			AddResults(found);
 	}
 }
@@ -2,12 +2,17 @@
 
 #include <mutex>
 
+namespace WinSys {
+	class TextMatcher;
+}
+
 enum class ObjectSearchType {
 	Default = 0,
 	Handles = 1,
 	Devices = 2,
 	WindowTitles = 4,
 	DLLs = 8,
+	CommandLines = 16,
 };
 DEFINE_ENUM_FLAG_OPERATORS(ObjectSearchType);
 
@@ -22,21 +27,31 @@ struct SearchResultItem {
 class ObjectSearcher final {
 public:
 	ObjectSearcher(HWND hWnd, ObjectSearchType searchType = ObjectSearchType::Default, DWORD pid = 0, const CString& filter = L"");
+	// cancels a running search and waits for it to stop
+	~ObjectSearcher();
 
 	void SearchAsync(const CString& text);
+	// the search stops soon after; SearchDoneMessage is posted with wParam 1
+	void Cancel();
 	bool IsRunning() const {
 		return _running;
 	}
 
-	std::vector<SearchResultItem> GetResults();
+	// results are only appended while searching, so they can be taken as they come.
+	// appends the results from index from onwards to items, returns the new total
+	size_t GetResults(std::vector<SearchResultItem>& items, size_t from);
 
 	inline static UINT SearchDoneMessage = ::RegisterWindowMessage(L"SearchDone");
 
 private:
-	void SearchHandles(const CString& text);
-	void SearchDLLs(const CString& text);
+	struct DllSearch;
+
+	bool SearchFromIndex(const CString& text);
+	void SearchHandles(const WinSys::TextMatcher& matcher);
+	void SearchDLLs(const WinSys::TextMatcher& matcher);
+	void SearchProcessDLLs(DllSearch& search);
+	void AddResults(std::vector<SearchResultItem>& items);
 	void DoSearch();
-	void CancelSearch();
 
 private:
 	ObjectSearchType _type;
@@ -47,5 +62,7 @@ private:
 	std::mutex _lock;
 	std::atomic<bool> _cancelRequested{ false };
 	std::atomic<bool> _running{ false };
+	// set while no search is running
+	wil::unique_handle _hDone;
 };
 
@@ -15,11 +15,12 @@
 #include "WinStationObjectType.h"
 #include "WorkerFactoryObjectType.h"
 #include "DeviceObjectType.h"
+#include "SnapshotBus.h"
 
 std::unique_ptr<ObjectType> ObjectTypeFactory::CreateObjectType(int typeIndex, const CString& name) {
 	static WinSys::ProcessManager procMgr;
 
-	procMgr.EnumProcesses();
+	SnapshotBus::Get().UpdateProcesses(procMgr);
 	if (name == L"Mutant")
 		return std::make_unique<MutexObjectType>(typeIndex, name);
 	if (name == L"Process")
@@ -8,6 +8,7 @@
 #include "ClipboardHelper.h"
 #include "ObjectsSummaryView.h"
 #include "SortHelper.h"
+#include "SnapshotBus.h"
 
 BOOL CObjectSummaryView::PreTranslateMessage(MSG* pMsg) {
 	return FALSE;
@@ -115,6 +116,10 @@ LRESULT CObjectSummaryView::OnCreate(UINT, WPARAM, LPARAM, BOOL &) {
 }
 
 LRESULT CObjectSummaryView::OnTimer(UINT, WPARAM wParam, LPARAM, BOOL &) {
+	if (wParam == 1 && SnapshotBus::Get().IsSuspended()) {
+		// nothing is visible; check again on the next tick
+		return 0;
+	}
 	if (wParam == 1) {
 		KillTimer(1);
 		m_ObjectManager.EnumTypes();
@@ -16,6 +16,7 @@
 #include "ObjectTypeFactory.h"
 #include "SecurityInfo.h"
 #include "DriverHelper.h"
+#include "SnapshotBus.h"
 
 int CObjectsView::ColumnCount;
 
@@ -252,9 +253,10 @@ LRESULT CObjectsView::OnObjectProperties(WORD, WORD, HWND, BOOL&) {
 }
 
 void CObjectsView::Refresh() {
+	PROFILE_SCOPE("CObjectsView", "Refresh");
 	CWaitCursor wait;
 	m_ObjMgr.EnumHandlesAndObjects(m_Typename, 0, nullptr, m_NamedObjectsOnly);
-	m_ProcMgr.EnumProcesses();
+	SnapshotBus::Get().UpdateProcesses(m_ProcMgr);
 	m_Objects = m_ObjMgr.GetObjects();
 	m_List.SetItemCountEx(static_cast<int>(m_Objects.size()), LVSICF_NOSCROLL);
 	Sort(m_List);
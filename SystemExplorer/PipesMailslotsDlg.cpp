@@ -1,6 +1,7 @@
 #include "pch.h"
 #include "PipesMailslotsDlg.h"
 #include "SortHelper.h"
+#include "SnapshotBus.h"
 
 CPipesMailslotsDlg::CPipesMailslotsDlg(Type type) : m_Type(type) {
 }
@@ -83,7 +84,7 @@ LRESULT CPipesMailslotsDlg::OnCloseCmd(WORD, WORD wID, HWND, BOOL&) {
 }
 
 void CPipesMailslotsDlg::EnumObjects() {
-	m_ProcMgr.EnumProcesses();
+	SnapshotBus::Get().UpdateProcesses(m_ProcMgr);
 	ObjectManager om;
 	om.EnumHandlesAndObjects(L"File", 0, m_Prefix);
 	m_Objects = om.GetObjects();
@@ -248,3 +248,20 @@ int ProcessInfoEx::GetBitness() const {
 	}
 	return _bitness;
 }
+
+const CString* ProcessInfoEx::GetCachedText(int column, uint64_t key) const {
+	if (column >= (int)_texts.size())
+		return nullptr;
+	auto& cached = _texts[column];
+	return cached.Valid && cached.Key == key ? &cached.Text : nullptr;
+}
+
+const CString& ProcessInfoEx::SetCachedText(int column, uint64_t key, CString text) const {
+	if (column >= (int)_texts.size())
+		_texts.resize(column + 1);
+	auto& cached = _texts[column];
+	cached.Key = key;
+	cached.Text = std::move(text);
+	cached.Valid = true;
+	return cached.Text;
+}
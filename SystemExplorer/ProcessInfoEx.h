@@ -52,6 +52,10 @@ public:
 	CString GetVersionObject(const CString& name) const;
 
 	int GetBitness() const;
+
+	// formatted column text, kept until the column's key (FormatHelper::GetProcessColumnKey) changes
+	const CString* GetCachedText(int column, uint64_t key) const;
+	const CString& SetCachedText(int column, uint64_t key, CString text) const;
 	const WinSys::Process* GetProcess() const {
 		return _process.get();
 	}
@@ -61,6 +65,12 @@ public:
 	bool IsTerminated{ false };
 
 private:
+	struct CachedText {
+		uint64_t Key;
+		CString Text;
+		bool Valid{ false };
+	};
+
 	std::unique_ptr<WinSys::Process> _process;
 	WinSys::ProcessInfo* _pi;
 	mutable int _image = -1;
@@ -69,6 +79,7 @@ private:
 	mutable std::wstring _username;
 	mutable std::wstring _commandLine;
 	mutable CString _description, _company;
+	mutable std::vector<CachedText> _texts;
 	mutable HWND _hWnd{ nullptr };
 	mutable DWORD _firstThreadId{ 0 };
 	mutable int _bitness{ 0 };
@@ -4,6 +4,7 @@
 #include <TlHelp32.h>
 #include "SortHelper.h"
 #include <ProcessInfo.h>
+#include "SnapshotBus.h"
 
 int CProcessSelectDlg::GetSelectedProcess(CString& name) const {
 	name = m_Name;
@@ -100,7 +101,7 @@ void CProcessSelectDlg::InitProcessList() {
 }
 
 void CProcessSelectDlg::EnumProcesses() {
-	m_ProcMgr.EnumProcesses();
+	SnapshotBus::Get().UpdateProcesses(m_ProcMgr);
 
 	m_Items.clear();
 	m_Items.reserve(m_ProcMgr.GetProcessCount());
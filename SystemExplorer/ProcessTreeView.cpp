@@ -6,6 +6,7 @@
 #include "ProcessPropertiesDlg.h"
 #include "ProcessesView.h"
 #include "FormatHelper.h"
+#include "SnapshotBus.h"
 
 CString CProcessTreeView::GetDetails(int row) {
 	return CString();
@@ -22,6 +23,7 @@ CString CProcessTreeView::GetName(int row) {
 		L"I/O Reads", L"I/O Writes", L"I/O Others",
 		L"GDI Objects", L"User Objects", L"Peak GDI Objects", L"Peak User Objects", L"Integrity Level",
 		L"Elevated?", L"Virtualization", L"Window Title", L"Platform", L"Description", L"Company", L"DPI Awareness",
+		L"I/O Read Bytes/sec", L"I/O Write Bytes/sec", L"I/O Other Bytes/sec",
 	};
 	if (row >= _countof(names))
 		return L"";
@@ -123,11 +125,12 @@ WinSys::ProcessInfo* CProcessTreeView::GetSelectedProcess() const {
 }
 
 void CProcessTreeView::OnUpdate() {
-	m_ProcMgr.EnumProcesses();
+	SnapshotBus::Get().UpdateProcesses(m_ProcMgr);
 	m_List.RedrawItems(m_List.GetTopIndex(), m_List.GetTopIndex() + m_List.GetCountPerPage());
 }
 
 void CProcessTreeView::DoRefresh() {
+	PROFILE_SCOPE("CProcessTreeView", "Refresh");
 	m_Tree.LockWindowUpdate(TRUE);
 
 	m_Tree.DeleteAllItems();
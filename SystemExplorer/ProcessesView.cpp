@@ -22,7 +22,29 @@ CProcessesView::CProcessesView(IMainFrame* frame) : CViewBase(frame) {
 CString CProcessesView::GetColumnText(HWND, int row, int col) const {
 	auto& p = m_Processes[row];
 	auto& px = GetProcessInfoEx(p.get());
-	return FormatHelper::GetProcessColumnValue((ProcessColumn)col, m_ProcMgr, p.get(), px);
+	// unchanged cells are copies of the cached text (reference counted, no allocation)
+	auto key = FormatHelper::GetProcessColumnKey((ProcessColumn)col, m_ProcMgr, p.get(), px, m_Generation);
+	if (auto text = px.GetCachedText(col, key))
+		return *text;
+
+	PROFILE_SCOPE("CProcessesView", "FormatCell");
+	return px.SetCachedText(col, key, FormatHelper::GetProcessColumnValue((ProcessColumn)col, m_ProcMgr, p.get(), px));
+}
+
+bool CProcessesView::GetFindKey(HWND, int row, int col, std::wstring_view& key, FindKeyBuffer& buffer) const {
+	auto p = m_Processes[row].get();
+	switch (static_cast<ProcessColumn>(col)) {
+		case ProcessColumn::Name: key = p->GetImageName(); return true;
+		case ProcessColumn::PackageFullName: key = p->GetPackageFullName(); return true;
+		case ProcessColumn::UserName: key = GetProcessInfoEx(p).UserName(); return true;
+		case ProcessColumn::CommandLine: key = GetProcessInfoEx(p).GetCommandLine(); return true;
+		case ProcessColumn::Id:
+			::StringCchPrintf(buffer, _countof(buffer), L"%6u (0x%05X)", p->Id, p->Id);
+			key = buffer;
+			return true;
+	}
+	// the cached cell text
+	return false;
 }
 
 int CProcessesView::GetRowImage(HWND, int row) const {
@@ -33,64 +55,80 @@ void CProcessesView::DoSort(const SortInfo* si) {
 	if (si == nullptr)
 		return;
 
-	auto col = si->SortColumn;
 	auto asc = si->SortAscending;
 
-	std::sort(m_Processes.begin(), m_Processes.end(), [&](const auto& p1, const auto& p2) {
-		switch (static_cast<ProcessColumn>(col)) {
-			case ProcessColumn::Name: return SortHelper::SortStrings(p1->GetImageName(), p2->GetImageName(), asc);
-			case ProcessColumn::PackageFullName: return SortHelper::SortStrings(p1->GetPackageFullName(), p2->GetPackageFullName(), asc);
-			case ProcessColumn::Id: return SortHelper::SortNumbers(p1->Id, p2->Id, asc);
-			case ProcessColumn::UserName: return SortHelper::SortStrings(GetProcessInfoEx(p1.get()).UserName(), GetProcessInfoEx(p2.get()).UserName(), asc);
-			case ProcessColumn::Session: return SortHelper::SortNumbers(p1->SessionId, p2->SessionId, asc);
-			case ProcessColumn::PriorityClass: return SortHelper::SortNumbers(GetProcessInfoEx(p1.get()).GetPriorityClass(), GetProcessInfoEx(p2.get()).GetPriorityClass(), asc);
-			case ProcessColumn::CPU: return SortHelper::SortNumbers(p1->CPU, p2->CPU, asc);
-			case ProcessColumn::Parent: return SortHelper::SortNumbers(p1->ParentId, p2->ParentId, asc);
-			case ProcessColumn::CreateTime: return SortHelper::SortNumbers(p1->CreateTime, p2->CreateTime, asc);
-			case ProcessColumn::CommitSize: return SortHelper::SortNumbers(p1->PagefileUsage, p2->PagefileUsage, asc);
-			case ProcessColumn::PeakCommitSize: return SortHelper::SortNumbers(p1->PeakPagefileUsage, p2->PeakPagefileUsage, asc);
-			case ProcessColumn::Priority: return SortHelper::SortNumbers(p1->BasePriority, p2->BasePriority, asc);
-			case ProcessColumn::Threads: return SortHelper::SortNumbers(p1->ThreadCount, p2->ThreadCount, asc);
-			case ProcessColumn::Handles: return SortHelper::SortNumbers(p1->HandleCount, p2->HandleCount, asc);
-			case ProcessColumn::WorkingSet: return SortHelper::SortNumbers(p1->WorkingSetSize, p2->WorkingSetSize, asc);
-			case ProcessColumn::ExePath: return SortHelper::SortStrings(GetProcessInfoEx(p1.get()).GetExecutablePath(), GetProcessInfoEx(p2.get()).GetExecutablePath(), asc);
-			case ProcessColumn::CPUTime: return SortHelper::SortNumbers(p1->KernelTime + p1->UserTime, p2->KernelTime + p2->UserTime, asc);
-			case ProcessColumn::PeakThreads: return SortHelper::SortNumbers(p1->PeakThreads, p2->PeakThreads, asc);
-			case ProcessColumn::VirtualSize: return SortHelper::SortNumbers(p1->VirtualSize, p2->VirtualSize, asc);
-			case ProcessColumn::PeakWorkingSet: return SortHelper::SortNumbers(p1->PeakWorkingSetSize, p2->PeakWorkingSetSize, asc);
-			case ProcessColumn::Attributes: return SortHelper::SortNumbers(GetProcessInfoEx(p1.get()).GetAttributes(m_ProcMgr), GetProcessInfoEx(p2.get()).GetAttributes(m_ProcMgr), asc);
-			case ProcessColumn::PagedPool: return SortHelper::SortNumbers(p1->PagedPoolUsage, p2->PagedPoolUsage, asc);
-			case ProcessColumn::PeakPagedPool: return SortHelper::SortNumbers(p1->PeakPagedPoolUsage, p2->PeakPagedPoolUsage, asc);
-			case ProcessColumn::NonPagedPool: return SortHelper::SortNumbers(p1->NonPagedPoolUsage, p2->NonPagedPoolUsage, asc);
-			case ProcessColumn::PeakNonPagedPool: return SortHelper::SortNumbers(p1->PeakNonPagedPoolUsage, p2->PeakNonPagedPoolUsage, asc);
-			case ProcessColumn::MemoryPriority: return SortHelper::SortNumbers(GetProcessInfoEx(p1.get()).GetMemoryPriority(), GetProcessInfoEx(p2.get()).GetMemoryPriority(), asc);
-			case ProcessColumn::IoPriority: return SortHelper::SortNumbers(GetProcessInfoEx(p1.get()).GetIoPriority(), GetProcessInfoEx(p2.get()).GetIoPriority(), asc);
-			case ProcessColumn::CommandLine: return SortHelper::SortStrings(GetProcessInfoEx(p1.get()).GetCommandLine(), GetProcessInfoEx(p2.get()).GetCommandLine(), asc);
-			case ProcessColumn::IoReadBytes: return SortHelper::SortNumbers(p1->ReadTransferCount, p2->ReadTransferCount, asc);
-			case ProcessColumn::IoWriteBytes: return SortHelper::SortNumbers(p1->WriteTransferCount, p2->WriteTransferCount, asc);
-			case ProcessColumn::IoOtherBytes: return SortHelper::SortNumbers(p1->OtherTransferCount, p2->OtherTransferCount, asc);
-			case ProcessColumn::IoReads: return SortHelper::SortNumbers(p1->ReadOperationCount, p2->ReadOperationCount, asc);
-			case ProcessColumn::IoWrites: return SortHelper::SortNumbers(p1->WriteOperationCount, p2->WriteOperationCount, asc);
-			case ProcessColumn::IoOther: return SortHelper::SortNumbers(p1->OtherOperationCount, p2->OtherOperationCount, asc);
-			case ProcessColumn::GDIObjects: return SortHelper::SortNumbers(GetProcessInfoEx(p1.get()).GetGdiObjects(), GetProcessInfoEx(p2.get()).GetGdiObjects(), asc);
-			case ProcessColumn::UserObjects: return SortHelper::SortNumbers(GetProcessInfoEx(p1.get()).GetUserObjects(), GetProcessInfoEx(p2.get()).GetUserObjects(), asc);
-			case ProcessColumn::PeakGdiObjects: return SortHelper::SortNumbers(GetProcessInfoEx(p1.get()).GetPeakGdiObjects(), GetProcessInfoEx(p2.get()).GetPeakGdiObjects(), asc);
-			case ProcessColumn::PeakUserObjects: return SortHelper::SortNumbers(GetProcessInfoEx(p1.get()).GetPeakUserObjects(), GetProcessInfoEx(p2.get()).GetPeakUserObjects(), asc);
-			case ProcessColumn::KernelTime: return SortHelper::SortNumbers(p1->KernelTime, p2->KernelTime, asc);
-			case ProcessColumn::UserTime: return SortHelper::SortNumbers(p1->UserTime, p2->UserTime, asc);
-			case ProcessColumn::Elevated: return SortHelper::SortBoolean(GetProcessInfoEx(p1.get()).IsElevated(), GetProcessInfoEx(p2.get()).IsElevated(), asc);
-			case ProcessColumn::Integrity: return SortHelper::SortNumbers(GetProcessInfoEx(p1.get()).GetIntegrityLevel(), GetProcessInfoEx(p2.get()).GetIntegrityLevel(), asc);
-			case ProcessColumn::Virtualized: return SortHelper::SortNumbers(GetProcessInfoEx(p1.get()).GetVirtualizationState(), GetProcessInfoEx(p2.get()).GetVirtualizationState(), asc);
-			case ProcessColumn::JobId: return SortHelper::SortNumbers(p1->JobObjectId, p2->JobObjectId, asc);
-			case ProcessColumn::WindowTitle: return SortHelper::SortStrings(GetProcessInfoEx(p1.get()).GetWindowTitle(), GetProcessInfoEx(p2.get()).GetWindowTitle(), asc);
-			case ProcessColumn::Platform: return SortHelper::SortNumbers(GetProcessInfoEx(p1.get()).GetBitness(), GetProcessInfoEx(p2.get()).GetBitness(), asc);
-			case ProcessColumn::Description: return SortHelper::SortStrings(GetProcessInfoEx(p1.get()).GetDescription(), GetProcessInfoEx(p2.get()).GetDescription(), asc);
-			case ProcessColumn::Company: return SortHelper::SortStrings(GetProcessInfoEx(p1.get()).GetCompanyName(), GetProcessInfoEx(p2.get()).GetCompanyName(), asc);
-			case ProcessColumn::DpiAwareness: return SortHelper::SortNumbers(GetProcessInfoEx(p1.get()).GetDpiAwareness(), GetProcessInfoEx(p2.get()).GetDpiAwareness(), asc);
-		}
-		return false;
-		});
+	//
+	// keys are extracted once per row and sorted packed, so the comparisons
+	// don't chase pointers or look up m_ProcessesEx
+	//
+	auto byNumber = [&](auto&& key) {
+		SortHelper::SortByKey(m_Processes, [&](const auto& p) { return SortHelper::PackKey(key(p.get()), asc); });
+	};
+	auto byString = [&](auto&& key) {
+		SortHelper::SortByKey(m_Processes, [&](const auto& p) { return key(p.get()); },
+			[&](const auto& s1, const auto& s2) { return SortHelper::SortStrings(s1, s2, asc); });
+	};
+	auto ex = [&](ProcessInfo* p) -> ProcessInfoEx& { return GetProcessInfoEx(p); };
+	auto& counters = m_ProcMgr.GetProcessCounters();
+	// a terminated process' counter slot may already belong to a new process; its (blank) rate sorts as 0
+	auto ioRate = [&](ProcessInfo* p, PerfMetric metric) {
+		return ex(p).IsTerminated ? 0ULL : (uint64_t)counters.GetRate(p->GetCounterSlot(), metric);
+	};
 
+	switch (static_cast<ProcessColumn>(si->SortColumn)) {
+		case ProcessColumn::Name: byString([](auto p) { return p->GetImageName().c_str(); }); break;
+		case ProcessColumn::PackageFullName: byString([](auto p) { return p->GetPackageFullName().c_str(); }); break;
+		case ProcessColumn::Id: byNumber([](auto p) { return p->Id; }); break;
+		case ProcessColumn::UserName: byString([&](auto p) { return ex(p).UserName().c_str(); }); break;
+		case ProcessColumn::Session: byNumber([](auto p) { return p->SessionId; }); break;
+		case ProcessColumn::PriorityClass: byNumber([&](auto p) { return ex(p).GetPriorityClass(); }); break;
+		case ProcessColumn::CPU: byNumber([](auto p) { return p->CPU; }); break;
+		case ProcessColumn::Parent: byNumber([](auto p) { return p->ParentId; }); break;
+		case ProcessColumn::CreateTime: byNumber([](auto p) { return p->CreateTime; }); break;
+		case ProcessColumn::CommitSize: byNumber([](auto p) { return p->PagefileUsage; }); break;
+		case ProcessColumn::PeakCommitSize: byNumber([](auto p) { return p->PeakPagefileUsage; }); break;
+		case ProcessColumn::Priority: byNumber([](auto p) { return p->BasePriority; }); break;
+		case ProcessColumn::Threads: byNumber([](auto p) { return p->ThreadCount; }); break;
+		case ProcessColumn::Handles: byNumber([](auto p) { return p->HandleCount; }); break;
+		case ProcessColumn::WorkingSet: byNumber([](auto p) { return p->WorkingSetSize; }); break;
+		case ProcessColumn::ExePath: byString([&](auto p) { return ex(p).GetExecutablePath().c_str(); }); break;
+		case ProcessColumn::CPUTime: byNumber([](auto p) { return p->KernelTime + p->UserTime; }); break;
+		case ProcessColumn::PeakThreads: byNumber([](auto p) { return p->PeakThreads; }); break;
+		case ProcessColumn::VirtualSize: byNumber([](auto p) { return p->VirtualSize; }); break;
+		case ProcessColumn::PeakWorkingSet: byNumber([](auto p) { return p->PeakWorkingSetSize; }); break;
+		case ProcessColumn::Attributes: byNumber([&](auto p) { return ex(p).GetAttributes(m_ProcMgr); }); break;
+		case ProcessColumn::PagedPool: byNumber([](auto p) { return p->PagedPoolUsage; }); break;
+		case ProcessColumn::PeakPagedPool: byNumber([](auto p) { return p->PeakPagedPoolUsage; }); break;
+		case ProcessColumn::NonPagedPool: byNumber([](auto p) { return p->NonPagedPoolUsage; }); break;
+		case ProcessColumn::PeakNonPagedPool: byNumber([](auto p) { return p->PeakNonPagedPoolUsage; }); break;
+		case ProcessColumn::MemoryPriority: byNumber([&](auto p) { return ex(p).GetMemoryPriority(); }); break;
+		case ProcessColumn::IoPriority: byNumber([&](auto p) { return ex(p).GetIoPriority(); }); break;
+		case ProcessColumn::CommandLine: byString([&](auto p) { return ex(p).GetCommandLine().c_str(); }); break;
+		case ProcessColumn::IoReadBytes: byNumber([](auto p) { return p->ReadTransferCount; }); break;
+		case ProcessColumn::IoWriteBytes: byNumber([](auto p) { return p->WriteTransferCount; }); break;
+		case ProcessColumn::IoOtherBytes: byNumber([](auto p) { return p->OtherTransferCount; }); break;
+		case ProcessColumn::IoReads: byNumber([](auto p) { return p->ReadOperationCount; }); break;
+		case ProcessColumn::IoWrites: byNumber([](auto p) { return p->WriteOperationCount; }); break;
+		case ProcessColumn::IoOther: byNumber([](auto p) { return p->OtherOperationCount; }); break;
+		case ProcessColumn::GDIObjects: byNumber([&](auto p) { return ex(p).GetGdiObjects(); }); break;
+		case ProcessColumn::UserObjects: byNumber([&](auto p) { return ex(p).GetUserObjects(); }); break;
+		case ProcessColumn::PeakGdiObjects: byNumber([&](auto p) { return ex(p).GetPeakGdiObjects(); }); break;
+		case ProcessColumn::PeakUserObjects: byNumber([&](auto p) { return ex(p).GetPeakUserObjects(); }); break;
+		case ProcessColumn::KernelTime: byNumber([](auto p) { return p->KernelTime; }); break;
+		case ProcessColumn::UserTime: byNumber([](auto p) { return p->UserTime; }); break;
+		case ProcessColumn::Elevated: byNumber([&](auto p) { return ex(p).IsElevated(); }); break;
+		case ProcessColumn::Integrity: byNumber([&](auto p) { return ex(p).GetIntegrityLevel(); }); break;
+		case ProcessColumn::Virtualized: byNumber([&](auto p) { return ex(p).GetVirtualizationState(); }); break;
+		case ProcessColumn::JobId: byNumber([](auto p) { return p->JobObjectId; }); break;
+		case ProcessColumn::WindowTitle: byString([&](auto p) { return ex(p).GetWindowTitle(); }); break;
+		case ProcessColumn::Platform: byNumber([&](auto p) { return ex(p).GetBitness(); }); break;
+		case ProcessColumn::Description: byString([&](auto p) { return (PCWSTR)ex(p).GetDescription(); }); break;
+		case ProcessColumn::Company: byString([&](auto p) { return (PCWSTR)ex(p).GetCompanyName(); }); break;
+		case ProcessColumn::DpiAwareness: byNumber([&](auto p) { return ex(p).GetDpiAwareness(); }); break;
+		case ProcessColumn::IoReadRate: byNumber([&](auto p) { return ioRate(p, PerfMetric::ReadBytes); }); break;
+		case ProcessColumn::IoWriteRate: byNumber([&](auto p) { return ioRate(p, PerfMetric::WriteBytes); }); break;
+		case ProcessColumn::IoOtherRate: byNumber([&](auto p) { return ioRate(p, PerfMetric::OtherBytes); }); break;
+	}
 }
 
 bool CProcessesView::OnDoubleClickList(int row, int col, POINT& pt) {
@@ -226,17 +264,36 @@ LRESULT CProcessesView::OnCreate(UINT, WPARAM, LPARAM, BOOL& bHandled) {
 	cm->AddColumn(L"Description", LVCFMT_LEFT, 250, ColumnFlags::Const | ColumnFlags::Visible);
 	cm->AddColumn(L"Company Name", LVCFMT_LEFT, 150, ColumnFlags::Const | ColumnFlags::Visible);
 	cm->AddColumn(L"DPI Awareness", LVCFMT_LEFT, 80, ColumnFlags::None);
+	cm->AddColumn(L"I/O\\I/O Read Bytes/sec", LVCFMT_RIGHT, 130, ColumnFlags::Numeric);
+	cm->AddColumn(L"I/O\\I/O Write Bytes/sec", LVCFMT_RIGHT, 130, ColumnFlags::Numeric);
+	cm->AddColumn(L"I/O\\I/O Other Bytes/sec", LVCFMT_RIGHT, 130, ColumnFlags::Numeric);
 
 	cm->UpdateColumns();
 
 	Refresh();
 	UpdateUI();
+	m_Snapshots.Subscribe(SnapshotKind::Processes, GetUpdateInterval(), IsPaused());
 
 	return 0;
 }
 
 void CProcessesView::OnUpdate() {
-	Refresh();
+	auto snapshot = m_Snapshots.GetNewProcessSnapshot();
+	if (snapshot)
+		Refresh(snapshot.get());
+}
+
+void CProcessesView::OnActivate(bool activate) {
+	m_Snapshots.Pause(!activate || IsPaused());
+}
+
+void CProcessesView::OnUpdateIntervalChanged(int interval) {
+	m_Snapshots.SetInterval(interval);
+}
+
+int CProcessesView::GetTimerInterval() const {
+	// the snapshot provider samples faster after a spike
+	return SnapshotBus::PollInterval;
 }
 
 LRESULT CProcessesView::OnRefresh(WORD, WORD, HWND, BOOL&) {
@@ -244,9 +301,16 @@ LRESULT CProcessesView::OnRefresh(WORD, WORD, HWND, BOOL&) {
 	return 0;
 }
 
-void CProcessesView::Refresh() {
+void CProcessesView::Refresh(const WinSys::ProcessSnapshot* snapshot) {
+	PROFILE_SCOPE("CProcessesView", "Refresh");
 	bool first = m_Processes.empty();
-	auto count = (int)m_ProcMgr.EnumProcesses();
+	m_ProcMgr.SetCpuAccounting(Settings::Get().Processes.CycleBasedCpu ? CpuAccounting::Cycles : CpuAccounting::Time);
+	if (snapshot && !m_ProcMgr.Update(*snapshot))
+		return;
+	m_Generation++;
+
+	auto count = (int)(snapshot ? m_ProcMgr.GetProcessCount() : m_ProcMgr.EnumProcesses());
+
 	if (first) {
 		m_Processes = m_ProcMgr.GetProcesses();
 		m_spList->SetItemCount(count, 0);
@@ -453,6 +517,7 @@ LRESULT CProcessesView::OnListRightClick(int, LPNMHDR hdr, BOOL&) {
 }
 
 void CProcessesView::OnPauseResume(bool paused) {
+	m_Snapshots.Pause(paused);
 	Frame()->GetUpdateUI()->UISetCheck(ID_VIEW_PAUSE, IsPaused());
 }
 
@@ -5,6 +5,7 @@
 #include "ProcessInfoEx.h"
 #include "resource.h"
 #include "ViewBase.h"
+#include "SnapshotBus.h"
 
 class CProcessesView :
 	public CVirtualListView<CProcessesView>,
@@ -14,6 +15,7 @@ public:
 	CProcessesView(IMainFrame* frame);
 
 	CString GetColumnText(HWND, int row, int col) const;
+	bool GetFindKey(HWND, int row, int col, std::wstring_view& key, FindKeyBuffer& buffer) const;
 	int GetRowImage(HWND, int row) const;
 	void DoSort(const SortInfo* si);
 	bool OnDoubleClickList(int row, int col, POINT& pt);
@@ -23,7 +25,10 @@ public:
 	DWORD OnSubItemPrePaint(int /*idCtrl*/, LPNMCUSTOMDRAW /*lpNMCustomDraw*/);
 
 	void OnUpdate();
+	void OnActivate(bool activate);
 	void OnPauseResume(bool paused);
+	void OnUpdateIntervalChanged(int interval);
+	int GetTimerInterval() const;
 
 	BEGIN_MSG_MAP(CProcessesView)
 		CHAIN_MSG_MAP(CCustomDraw<CProcessesView>)
@@ -63,7 +68,7 @@ private:
 	LRESULT OnFileSave(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/);
 	LRESULT OnCopyRow(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/);
 
-	void Refresh();
+	void Refresh(const WinSys::ProcessSnapshot* snapshot = nullptr);
 	void UpdateUI();
 	void ShowProperties(int row);
 	ProcessInfoEx& GetProcessInfoEx(WinSys::ProcessInfo* pi) const;
@@ -73,10 +78,13 @@ private:
 	std::vector<std::shared_ptr<WinSys::ProcessInfo>> m_Processes;
 	mutable std::unordered_map<WinSys::ProcessInfo*, ProcessInfoEx> m_ProcessesEx;
 	WinSys::ProcessManager m_ProcMgr;
+	SnapshotSubscription m_Snapshots;
 	HFONT m_hFont;
 	CListViewCtrl m_List;
 	CComPtr<IListView> m_spList;
 	int m_SelectedHeader;
 	bool m_LastTimeCPU{ false };
+	// changes with every snapshot, for the column text cache
+	uint32_t m_Generation{ 0 };
 };
 
@@ -0,0 +1,139 @@
+#include "pch.h"
+#include "ProfilerView.h"
+#include "SortHelper.h"
+
+using namespace WinSys;
+
+CString CProfilerView::GetColumnText(HWND, int row, int col) const {
+	auto& s = m_Sites[row];
+	CString text;
+
+	switch (col) {
+		case 0: return CString(s.Category.c_str());
+		case 1: return CString(s.Name.c_str());
+		case 2: text.Format(L"%llu", s.Calls); break;
+		case 3: text.Format(L"%.1f", s.TotalTime / 10000.0); break;
+		case 4:
+			if (s.Calls)
+				text.Format(L"%.1f", s.TotalTime / 10.0 / s.Calls);
+			break;
+		case 5: text.Format(L"%.1f", s.P50 / 10.0); break;
+		case 6: text.Format(L"%.1f", s.P99 / 10.0); break;
+		case 7: text.Format(L"%.1f", s.MaxTime / 10.0); break;
+		case 8: text.Format(L"%llu", s.Allocations); break;
+		case 9:
+			if (s.Calls)
+				text.Format(L"%.1f", (double)s.Allocations / s.Calls);
+			break;
+		case 10:
+			if (m_EnabledTime > 0)
+				text.Format(L"%.1f", GetCallRate(s));
+			break;
+	}
+	return text;
+}
+
+void CProfilerView::DoSort(const SortInfo* si) {
+	if (si == nullptr)
+		return;
+
+	std::sort(m_Sites.begin(), m_Sites.end(), [&](const auto& s1, const auto& s2) {
+		switch (si->SortColumn) {
+			case 0: return SortHelper::SortStrings(s1.Category, s2.Category, si->SortAscending);
+			case 1: return SortHelper::SortStrings(s1.Name, s2.Name, si->SortAscending);
+			case 2: return SortHelper::SortNumbers(s1.Calls, s2.Calls, si->SortAscending);
+			case 3: return SortHelper::SortNumbers(s1.TotalTime, s2.TotalTime, si->SortAscending);
+			case 4: return SortHelper::SortNumbers(s1.Calls ? s1.TotalTime / s1.Calls : 0, s2.Calls ? s2.TotalTime / s2.Calls : 0, si->SortAscending);
+			case 5: return SortHelper::SortNumbers(s1.P50, s2.P50, si->SortAscending);
+			case 6: return SortHelper::SortNumbers(s1.P99, s2.P99, si->SortAscending);
+			case 7: return SortHelper::SortNumbers(s1.MaxTime, s2.MaxTime, si->SortAscending);
+			case 8: return SortHelper::SortNumbers(s1.Allocations, s2.Allocations, si->SortAscending);
+			case 9: return SortHelper::SortNumbers(s1.Calls ? (double)s1.Allocations / s1.Calls : 0, s2.Calls ? (double)s2.Allocations / s2.Calls : 0, si->SortAscending);
+			case 10: return SortHelper::SortNumbers(s1.Calls, s2.Calls, si->SortAscending);
+		}
+		return false;
+		});
+}
+
+bool CProfilerView::OnRightClickList(int, int, POINT& pt) {
+	CMenu menu;
+	menu.LoadMenu(IDR_CONTEXT);
+	auto sub = menu.GetSubMenu(12);
+	sub.CheckMenuItem(ID_PROFILER_RECORDTRACE, Profiler::Get().IsTracing() ? MF_CHECKED : MF_UNCHECKED);
+	sub.EnableMenuItem(ID_PROFILER_EXPORTTRACE, Profiler::Get().GetTraceEventCount() ? MF_ENABLED : MF_GRAYED);
+	Frame()->TrackPopupMenu(sub, *this, &pt);
+	return true;
+}
+
+double CProfilerView::GetCallRate(const ProfileSiteStats& s) const {
+	return m_EnabledTime > 0 ? s.Calls * 10000000.0 / m_EnabledTime : 0;
+}
+
+void CProfilerView::DoRefresh() {
+	m_Sites = Profiler::Get().GetStats();
+	m_EnabledTime = Profiler::Get().GetEnabledTime();
+	DoSort(GetSortInfo(m_List));
+	m_List.SetItemCountEx(static_cast<int>(m_Sites.size()), LVSICF_NOINVALIDATEALL | LVSICF_NOSCROLL);
+	auto top = m_List.GetTopIndex();
+	m_List.RedrawItems(top, top + m_List.GetCountPerPage());
+}
+
+void CProfilerView::OnUpdate() {
+	DoRefresh();
+}
+
+LRESULT CProfilerView::OnCreate(UINT, WPARAM, LPARAM, BOOL&) {
+	m_hWndClient = m_List.Create(*this, rcDefault, nullptr, ListViewDefaultStyle);
+	m_List.SetExtendedListViewStyle(LVS_EX_FULLROWSELECT | LVS_EX_DOUBLEBUFFER | LVS_EX_LABELTIP | LVS_EX_HEADERDRAGDROP);
+
+	auto cm = GetColumnManager(m_List);
+	cm->AddColumn(L"Category", LVCFMT_LEFT, 160, ColumnFlags::Visible | ColumnFlags::Const);
+	cm->AddColumn(L"Name", LVCFMT_LEFT, 180, ColumnFlags::Visible | ColumnFlags::Mandatory | ColumnFlags::Const);
+	cm->AddColumn(L"Calls", LVCFMT_RIGHT, 80, ColumnFlags::Visible | ColumnFlags::Numeric);
+	cm->AddColumn(L"Total (ms)", LVCFMT_RIGHT, 90, ColumnFlags::Visible | ColumnFlags::Numeric);
+	cm->AddColumn(L"Average (usec)", LVCFMT_RIGHT, 100, ColumnFlags::Visible | ColumnFlags::Numeric);
+	cm->AddColumn(L"P50 (usec)", LVCFMT_RIGHT, 90, ColumnFlags::Visible | ColumnFlags::Numeric);
+	cm->AddColumn(L"P99 (usec)", LVCFMT_RIGHT, 90, ColumnFlags::Visible | ColumnFlags::Numeric);
+	cm->AddColumn(L"Max (usec)", LVCFMT_RIGHT, 90, ColumnFlags::Visible | ColumnFlags::Numeric);
+	cm->AddColumn(L"Allocations", LVCFMT_RIGHT, 90, ColumnFlags::Visible | ColumnFlags::Numeric);
+	cm->AddColumn(L"Allocs/Call", LVCFMT_RIGHT, 80, ColumnFlags::Visible | ColumnFlags::Numeric);
+	cm->AddColumn(L"Calls/sec", LVCFMT_RIGHT, 80, ColumnFlags::Visible | ColumnFlags::Numeric);
+	cm->UpdateColumns();
+
+	if (s_Views++ == 0)
+		Profiler::Get().Enable(true);
+	DoRefresh();
+
+	return 0;
+}
+
+LRESULT CProfilerView::OnDestroy(UINT, WPARAM, LPARAM, BOOL& bHandled) {
+	if (--s_Views == 0) {
+		Profiler::Get().EnableTrace(false);
+		Profiler::Get().Enable(false);
+	}
+	bHandled = FALSE;
+	return 0;
+}
+
+LRESULT CProfilerView::OnRecordTrace(WORD, WORD, HWND, BOOL&) {
+	Profiler::Get().EnableTrace(!Profiler::Get().IsTracing());
+	return 0;
+}
+
+LRESULT CProfilerView::OnExportTrace(WORD, WORD, HWND, BOOL&) {
+	CSimpleFileDialog dlg(FALSE, L"json", nullptr, OFN_PATHMUSTEXIST | OFN_OVERWRITEPROMPT | OFN_EXPLORER | OFN_ENABLESIZING,
+		L"Chrome Trace Files (*.json)\0*.json\0All Files\0*.*\0", *this);
+	if (dlg.DoModal() == IDOK) {
+		CWaitCursor wait;
+		if (!Profiler::Get().ExportTrace(dlg.m_szFileName))
+			AtlMessageBox(*this, L"Failed to save trace", IDS_TITLE, MB_ICONERROR);
+	}
+	return 0;
+}
+
+LRESULT CProfilerView::OnReset(WORD, WORD, HWND, BOOL&) {
+	Profiler::Get().Reset();
+	DoRefresh();
+	return 0;
+}
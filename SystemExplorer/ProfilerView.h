@@ -0,0 +1,47 @@
+#pragma once
+
+#include "ViewBase.h"
+#include "VirtualListView.h"
+#include "resource.h"
+#include <Profiler.h>
+
+class CProfilerView :
+	public CVirtualListView<CProfilerView>,
+	public CViewBase<CProfilerView> {
+public:
+	CProfilerView(IMainFrame* frame) : CViewBase(frame) {}
+
+	BEGIN_MSG_MAP(CProfilerView)
+		MESSAGE_HANDLER(WM_CREATE, OnCreate)
+		MESSAGE_HANDLER(WM_DESTROY, OnDestroy)
+		COMMAND_ID_HANDLER(ID_PROFILER_RECORDTRACE, OnRecordTrace)
+		COMMAND_ID_HANDLER(ID_PROFILER_EXPORTTRACE, OnExportTrace)
+		COMMAND_ID_HANDLER(ID_PROFILER_RESET, OnReset)
+		CHAIN_MSG_MAP(CVirtualListView<CProfilerView>)
+		CHAIN_MSG_MAP(CViewBase<CProfilerView>)
+	END_MSG_MAP()
+
+	CString GetColumnText(HWND, int row, int col) const;
+	void DoSort(const SortInfo* si);
+	bool OnRightClickList(int row, int col, POINT& pt);
+
+	void DoRefresh();
+	void OnUpdate();
+
+private:
+	double GetCallRate(const WinSys::ProfileSiteStats& s) const;
+
+	LRESULT OnCreate(UINT /*uMsg*/, WPARAM /*wParam*/, LPARAM /*lParam*/, BOOL& /*bHandled*/);
+	LRESULT OnDestroy(UINT /*uMsg*/, WPARAM /*wParam*/, LPARAM /*lParam*/, BOOL& /*bHandled*/);
+	LRESULT OnRecordTrace(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/);
+	LRESULT OnExportTrace(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/);
+	LRESULT OnReset(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/);
+
+private:
+	CListViewCtrl m_List;
+	std::vector<WinSys::ProfileSiteStats> m_Sites;
+	// profiling time the call counts were accumulated over
+	int64_t m_EnabledTime{ 0 };
+	// profiling is enabled while any profiler view is open
+	inline static int s_Views;
+};
@@ -37,6 +37,10 @@ LRESULT CSearchBar::OnSearch(WORD, WORD, HWND, BOOL&) {
 LRESULT CSearchBar::OnCancel(WORD, WORD, HWND, BOOL&) {
     ATLASSERT(m_IsSearching);
 
+    // the notify target calls Reset when the search actually stops
+    if (m_pNotify && m_pNotify->CancelSearch())
+        GetDlgItem(IDC_CANCEL).EnableWindow(FALSE);
+
     return 0;
 }
 
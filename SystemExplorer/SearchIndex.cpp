@@ -0,0 +1,314 @@
+#include "pch.h"
+#include "SearchIndex.h"
+#include "SnapshotBus.h"
+#include <ProcessInfo.h>
+#include <Processes.h>
+#include <Profiler.h>
+
+using namespace WinSys;
+
+namespace {
+	struct WindowInfo {
+		HWND hWnd;
+		DWORD ProcessId;
+		CString Title;
+	};
+
+	BOOL CALLBACK EnumWindowsCallback(HWND hWnd, LPARAM lParam) {
+		if (!::IsWindowVisible(hWnd))
+			return TRUE;
+
+		auto len = ::GetWindowTextLength(hWnd);
+		if (len == 0)
+			return TRUE;
+
+		WindowInfo info{ hWnd };
+		::GetWindowText(hWnd, info.Title.GetBufferSetLength(len + 1), len + 1);
+		info.Title.ReleaseBuffer();
+		::GetWindowThreadProcessId(hWnd, &info.ProcessId);
+		reinterpret_cast<std::vector<WindowInfo>*>(lParam)->push_back(std::move(info));
+		return TRUE;
+	}
+}
+
+SearchIndex& SearchIndex::Get() {
+	static SearchIndex index;
+	return index;
+}
+
+SearchIndex::SearchIndex() = default;
+SearchIndex::~SearchIndex() = default;
+
+void SearchIndex::Start() {
+	if (_users++ > 0)
+		return;
+
+	_generation++;
+	// the first update runs right away
+	if (_provider == 0)
+		_provider = _scheduler.AddProvider([this] { Update(); }, UpdateInterval);
+	else
+		_scheduler.Pause(_provider, false);
+}
+
+void SearchIndex::Stop() {
+	if (_users == 0 || --_users > 0)
+		return;
+
+	// the index goes stale while paused, so searches enumerate until it's updated again.
+	// an update still running sees the generation change and doesn't mark the index ready
+	_generation++;
+	_scheduler.Pause(_provider, true);
+	_ready = false;
+}
+
+bool SearchIndex::IsReady() const {
+	return _ready;
+}
+
+std::vector<SearchResultItem> SearchIndex::Find(const CString& text, ObjectSearchType types, size_t maxResults) const {
+	std::vector<SearchResultItem> items;
+	auto lock = _lock.lock_shared();
+	// types are filtered after the lookup, so all matches are needed
+	for (auto id : _index.Find(std::wstring_view(text, text.GetLength()))) {
+		auto& entry = _entries[id];
+		if ((entry.Kind & types) == ObjectSearchType::Default)
+			continue;
+
+		items.push_back(entry.Item);
+		if (maxResults && items.size() >= maxResults)
+			break;
+	}
+	return items;
+}
+
+SearchIndexStats SearchIndex::GetStats() const {
+	auto lock = _lock.lock_shared();
+	return SearchIndexStats{ _index.GetStats(), _updates, _lastUpdateTime };
+}
+
+std::vector<SearchIndex::DocId> SearchIndex::Apply(const std::vector<DocId>& removed, std::vector<Entry>& added) {
+	std::vector<DocId> ids;
+	if (removed.empty() && added.empty())
+		return ids;
+
+	ids.reserve(added.size());
+	auto lock = _lock.lock_exclusive();
+	for (auto id : removed) {
+		_index.Remove(id);
+		_entries[id] = Entry();
+	}
+	for (auto& entry : added) {
+		// DLLs by module name, like the enumerating search
+		auto& text = entry.Item.Name;
+		auto id = _index.Add(std::wstring_view(text, text.GetLength()));
+		if (id >= _entries.size())
+			_entries.resize(id + 1);
+		_entries[id] = std::move(entry);
+		ids.push_back(id);
+	}
+	added.clear();
+	return ids;
+}
+
+void SearchIndex::Update() {
+	// nothing is visible to search from
+	if (SnapshotBus::Get().IsSuspended())
+		return;
+
+	PROFILE_SCOPE("SearchIndex", "Update");
+	auto generation = _generation.load();
+	auto start = ::GetTickCount64();
+
+	UpdateProcesses();
+	UpdateHandles();
+	UpdateWindows();
+
+	{
+		auto lock = _lock.lock_exclusive();
+		_updates++;
+		_lastUpdateTime = static_cast<uint32_t>(::GetTickCount64() - start);
+	}
+	// stopped while updating: the index may have missed changes; a restart runs another update that marks it
+	if (_generation == generation)
+		_ready = true;
+}
+
+void SearchIndex::UpdateProcesses() {
+	if (!SnapshotBus::Get().UpdateProcesses(_processes, false, 0, UpdateInterval / 2))
+		return;
+
+	std::vector<DocId> removed;
+	std::vector<Entry> added;
+	for (auto& pi : _processes.GetTerminatedProcesses()) {
+		auto it = _processEntries.find(pi.get());
+		if (it == _processEntries.end())
+			continue;
+
+		auto& process = it->second;
+		if (process.CommandLine != TrigramIndex::InvalidDoc)
+			removed.push_back(process.CommandLine);
+		for (auto& [mi, id] : process.ModuleDocs)
+			removed.push_back(id);
+		_processEntries.erase(it);
+	}
+
+	// the first update reports all processes as new
+	std::vector<ProcessEntry*> owners;
+	for (auto& pi : _processes.GetNewProcesses()) {
+		auto& process = _processEntries[pi.get()];
+		process.Id = pi->Id;
+		process.Name = pi->GetImageName();
+		if (pi->Id == 0)
+			continue;
+
+		process.Modules = std::make_unique<ProcessModuleTracker>(pi->Id);
+		auto p = Process::OpenById(pi->Id);
+		if (p == nullptr)
+			continue;
+
+		auto commandLine = p->GetCommandLine();
+		if (commandLine.empty())
+			continue;
+
+		Entry entry;
+		entry.Kind = ObjectSearchType::CommandLines;
+		entry.Item.Name = commandLine.c_str();
+		entry.Item.Type = L"Process";
+		entry.Item.Details = process.Name.c_str();
+		entry.Item.Id = pi->Id;
+		entry.Item.ProcessId = pi->Id;
+		added.push_back(std::move(entry));
+		owners.push_back(&process);
+	}
+
+	auto ids = Apply(removed, added);
+	for (size_t i = 0; i < ids.size(); i++)
+		owners[i]->CommandLine = ids[i];
+
+	for (auto& [pi, process] : _processEntries)
+		if (process.Modules)
+			UpdateModules(process);
+}
+
+void SearchIndex::UpdateModules(ProcessEntry& process) {
+	auto& tracker = *process.Modules;
+	bool first = tracker.GetModules().empty();
+	if (tracker.EnumModules() == 0 && first) {
+		// no access; don't try again
+		process.Modules.reset();
+		return;
+	}
+
+	std::vector<DocId> removed;
+	for (auto& mi : tracker.GetUnloadedModules()) {
+		if (auto it = process.ModuleDocs.find(mi.get()); it != process.ModuleDocs.end()) {
+			removed.push_back(it->second);
+			process.ModuleDocs.erase(it);
+		}
+	}
+
+	// the first enumeration reports no new modules
+	auto& modules = first ? tracker.GetModules() : tracker.GetNewModules();
+	std::vector<Entry> added;
+	std::vector<ModuleInfo*> owners;
+	for (auto& mi : modules) {
+		// mapped data files aren't DLLs
+		if (mi->Type != MapType::Image || mi->Path.empty())
+			continue;
+
+		Entry entry;
+		entry.Kind = ObjectSearchType::DLLs;
+		entry.Item.Name = mi->Name.c_str();
+		entry.Item.Type = L"DLL";
+		entry.Item.Details = mi->Path.c_str();
+		entry.Item.Id = (DWORD64)mi->Base;
+		entry.Item.ProcessId = process.Id;
+		added.push_back(std::move(entry));
+		owners.push_back(mi.get());
+	}
+
+	auto ids = Apply(removed, added);
+	for (size_t i = 0; i < ids.size(); i++)
+		process.ModuleDocs.insert({ owners[i], ids[i] });
+}
+
+void SearchIndex::UpdateHandles() {
+	if (!_objects.UpdateHandles(nullptr, 0, true))
+		return;
+
+	std::vector<DocId> removed;
+	for (auto& hi : _objects.GetClosedHandles()) {
+		if (auto it = _handleDocs.find(hi.get()); it != _handleDocs.end()) {
+			removed.push_back(it->second);
+			_handleDocs.erase(it);
+		}
+	}
+
+	// the first update reports no new handles
+	auto& handles = _handlesEnumerated ? _objects.GetNewHandles() : _objects.GetHandles();
+	_handlesEnumerated = true;
+
+	std::vector<Entry> added;
+	std::vector<HandleInfo*> owners;
+	added.reserve(handles.size());
+	owners.reserve(handles.size());
+	for (auto& hi : handles) {
+		Entry entry;
+		entry.Kind = ObjectSearchType::Handles;
+		entry.Item.Name = hi->Name;
+		entry.Item.Type = ObjectManager::GetType(hi->ObjectTypeIndex)->TypeName;
+		entry.Item.Details = _processes.GetProcessNameById(hi->ProcessId).c_str();
+		entry.Item.Id = hi->HandleValue;
+		entry.Item.ProcessId = hi->ProcessId;
+		added.push_back(std::move(entry));
+		owners.push_back(hi.get());
+	}
+
+	auto ids = Apply(removed, added);
+	for (size_t i = 0; i < ids.size(); i++)
+		_handleDocs.insert({ owners[i], ids[i] });
+}
+
+void SearchIndex::UpdateWindows() {
+	std::vector<WindowInfo> windows;
+	windows.reserve(256);
+	::EnumWindows(EnumWindowsCallback, reinterpret_cast<LPARAM>(&windows));
+
+	std::vector<DocId> removed;
+	std::vector<Entry> added;
+	std::vector<HWND> owners;
+	std::unordered_map<HWND, WindowEntry> current;
+	current.reserve(windows.size());
+	for (auto& wi : windows) {
+		if (auto it = _windows.find(wi.hWnd); it != _windows.end()) {
+			if (it->second.Title == wi.Title) {
+				current.insert(_windows.extract(it));
+				continue;
+			}
+			// re-added with the new title
+			removed.push_back(it->second.Doc);
+			_windows.erase(it);
+		}
+
+		Entry entry;
+		entry.Kind = ObjectSearchType::WindowTitles;
+		entry.Item.Name = wi.Title;
+		entry.Item.Type = L"Window";
+		entry.Item.Details = _processes.GetProcessNameById(wi.ProcessId).c_str();
+		entry.Item.Id = (DWORD64)wi.hWnd;
+		entry.Item.ProcessId = wi.ProcessId;
+		added.push_back(std::move(entry));
+		owners.push_back(wi.hWnd);
+		current.insert({ wi.hWnd, WindowEntry{ TrigramIndex::InvalidDoc, wi.Title } });
+	}
+
+	// whatever is left is gone
+	for (auto& [hWnd, window] : _windows)
+		removed.push_back(window.Doc);
+
+	auto ids = Apply(removed, added);
+	for (size_t i = 0; i < ids.size(); i++)
+		current[owners[i]].Doc = ids[i];
+	_windows = std::move(current);
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <SamplingScheduler.h>
+#include <TrigramIndex.h>
+#include <ProcessManager.h>
+#include <ProcessModuleTracker.h>
+#include "ObjectManager.h"
+#include "ObjectSearcher.h"
+
+struct SearchIndexStats {
+	WinSys::TrigramIndexStats Index;
+	uint64_t Updates;
+	// duration of the last update, in msec
+	uint32_t LastUpdateTime;
+};
+
+//
+// background maintained index over handle (object) names, DLL names, process command lines and window titles,
+// so a search is a lookup rather than a system wide enumeration.
+// handles, processes and modules are updated from their trackers' deltas; windows are compared by title.
+// updates run while the index is started (e.g. a search view is open) and the snapshot bus isn't suspended
+//
+
+class SearchIndex final {
+public:
+	static SearchIndex& Get();
+
+	static const uint32_t UpdateInterval = 10000;
+
+	// reference counted
+	void Start();
+	void Stop();
+	// true once an update completed since the index was started
+	[[nodiscard]] bool IsReady() const;
+
+	// entries of the given types containing text (case insensitive), up to maxResults (0 for all)
+	std::vector<SearchResultItem> Find(const CString& text, ObjectSearchType types, size_t maxResults = 0) const;
+	SearchIndexStats GetStats() const;
+
+private:
+	SearchIndex();
+	~SearchIndex();
+	SearchIndex(const SearchIndex&) = delete;
+	SearchIndex& operator=(const SearchIndex&) = delete;
+
+	using DocId = WinSys::TrigramIndex::DocId;
+
+	struct Entry {
+		ObjectSearchType Kind;
+		SearchResultItem Item;
+	};
+
+	struct ProcessEntry {
+		DWORD Id;
+		std::wstring Name;
+		DocId CommandLine{ WinSys::TrigramIndex::InvalidDoc };
+		std::unique_ptr<WinSys::ProcessModuleTracker> Modules;
+		std::unordered_map<WinSys::ModuleInfo*, DocId> ModuleDocs;
+	};
+
+	struct WindowEntry {
+		DocId Doc;
+		CString Title;
+	};
+
+	void Update();
+	void UpdateProcesses();
+	void UpdateModules(ProcessEntry& process);
+	void UpdateHandles();
+	void UpdateWindows();
+	// removes and adds entries under the lock, returns the ids of the added ones in order
+	std::vector<DocId> Apply(const std::vector<DocId>& removed, std::vector<Entry>& added);
+
+private:
+	mutable wil::srwlock _lock;
+	WinSys::TrigramIndex _index;
+	std::vector<Entry> _entries;
+	uint64_t _updates{ 0 };
+	uint32_t _lastUpdateTime{ 0 };
+
+	// used by the sampling thread only
+	ObjectManager _objects;
+	WinSys::ProcessManager _processes;
+	std::unordered_map<HandleInfo*, DocId> _handleDocs;
+	std::unordered_map<WinSys::ProcessInfo*, ProcessEntry> _processEntries;
+	std::unordered_map<HWND, WindowEntry> _windows;
+	bool _handlesEnumerated{ false };
+
+	std::atomic<bool> _ready{ false };
+	// changed by Start and Stop, so an update overlapping either doesn't publish readiness
+	std::atomic<uint32_t> _generation{ 0 };
+	int _users{ 0 };
+	uint32_t _provider{ 0 };
+	// last, so it's destroyed (waiting for a running update) first
+	WinSys::SamplingScheduler _scheduler;
+};
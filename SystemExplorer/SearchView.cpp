@@ -1,6 +1,7 @@
 #include "pch.h"
 #include "SearchView.h"
 #include "SortHelper.h"
+#include "SearchIndex.h"
 
 CSearchView::CSearchView(IMainFrame* frame) : CViewBase(frame), m_SearchBar(this) {
 }
@@ -18,7 +19,7 @@ CString CSearchView::GetColumnText(HWND, int row, int col) const {
 	switch (col) {
 		case 0: return item.Type;
 		case 1: 
-			if (item.Type == L"DLL")
+			if (item.Type == L"DLL" || item.Type == L"Window")
 				text.Format(L"0x%llX", item.Id);
 			else
 				text.Format(L"%llu (0x%llX)", item.Id, item.Id); 
@@ -60,7 +61,7 @@ void CSearchView::DoSort(const SortInfo* si) {
 
 void CSearchView::UpdateResults() {
 	auto count = m_Items.size();
-	m_Items = m_Searcher->GetResults();
+	m_Searcher->GetResults(m_Items, count);
 	if (count != m_Items.size()) {
 		m_List.SetItemCountEx((int)m_Items.size(), LVSICF_NOINVALIDATEALL | LVSICF_NOSCROLL);
 		Sort(m_List, true);
@@ -79,11 +80,16 @@ void CSearchView::StartSearch(PCWSTR text) {
 
 	m_Searcher.reset(new ObjectSearcher(*this));
 	m_Searcher->SearchAsync(text);
-	SetTimer(1, 1000, nullptr);
+	// results stream in while searching
+	SetTimer(1, 250, nullptr);
 }
 
 bool CSearchView::CancelSearch() {
-	UpdateResults();
+	if (m_Searcher == nullptr || !m_Searcher->IsRunning())
+		return false;
+
+	// completes with SearchDoneMessage
+	m_Searcher->Cancel();
 	return true;
 }
 
@@ -111,10 +117,23 @@ LRESULT CSearchView::OnCreate(UINT, WPARAM, LPARAM, BOOL&) {
 
 	m_List.SetImageList(images, LVSIL_SMALL);
 
+	// kept up to date while any search view is open
+	SearchIndex::Get().Start();
+
+	return 0;
+}
+
+LRESULT CSearchView::OnDestroy(UINT, WPARAM, LPARAM, BOOL& bHandled) {
+	SearchIndex::Get().Stop();
+	bHandled = FALSE;
 	return 0;
 }
 
 LRESULT CSearchView::OnSearchDone(UINT, WPARAM, LPARAM, BOOL&) {
+	// may be left over from a search replaced by a new one
+	if (m_Searcher == nullptr || m_Searcher->IsRunning())
+		return 0;
+
 	KillTimer(1);
 	UpdateResults();
 	m_SearchBar.Reset();
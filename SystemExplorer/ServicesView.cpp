@@ -7,6 +7,7 @@
 #include "SelectColumnsDlg.h"
 #include "ProcessPropertiesDlg.h"
 #include "ProcessInfoEx.h"
+#include "SnapshotBus.h"
 
 using namespace WinSys;
 
@@ -556,7 +557,8 @@ HWND CServicesView::InitToolBar() {
 }
 
 void CServicesView::Refresh() {
-	m_ProcMgr.EnumProcesses();
+	PROFILE_SCOPE("CServicesView", "Refresh");
+	SnapshotBus::Get().UpdateProcesses(m_ProcMgr);
 	m_ServicesEx.clear();
 	m_Services = WinSys::ServiceManager::EnumServices(m_ViewServices ? ServiceEnumType::AllServices : ServiceEnumType::AllDrivers);
 	m_ServicesEx.reserve(m_Services.size());
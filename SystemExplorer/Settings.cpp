@@ -68,6 +68,7 @@ bool Settings::Save(PCWSTR filename) const {
 	file.WriteBool(L"Options", L"SingleInstance", SingleInstanceOnly);
 	file.WriteBool(L"Options", L"MinimizeToTray", MinimizeToTray);
 	file.WriteInt(L"ProcessOptions", L"Interval", Processes.UpdateInterval);
+	file.WriteBool(L"ProcessOptions", L"CycleBasedCpu", Processes.CycleBasedCpu);
 	
 	return SaveColors(filename, L"ProcessColors", Processes.Colors, _countof(Processes.Colors));
 }
@@ -81,6 +82,7 @@ bool Settings::Load(PCWSTR filename) {
 	SingleInstanceOnly = file.ReadBool(L"Options", L"SingleInstance");
 	MinimizeToTray = file.ReadBool(L"Options", L"MinimizeToTray");
 	Processes.UpdateInterval = file.ReadInt(L"ProcessOptions", L"Interval", Processes.UpdateInterval);
+	Processes.CycleBasedCpu = file.ReadBool(L"ProcessOptions", L"CycleBasedCpu");
 
 	return LoadColors(filename, L"ProcessColors", Processes.Colors, _countof(Processes.Colors));
 }
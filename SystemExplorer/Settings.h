@@ -38,6 +38,8 @@ public:
 			HighlightColor(L"Wow64", StandardColors::DarkBlue, StandardColors::White, false),
 		};
 		int UpdateInterval{ 1000 };
+		// CPU usage from cycle time deltas rather than CPU time deltas
+		bool CycleBasedCpu{ false };
 	} Processes;
 
 	struct {
@@ -0,0 +1,389 @@
+#include "pch.h"
+#include "SnapshotBus.h"
+#include <ProcessManager.h>
+
+bool PerformanceSnapshot::Capture() {
+	Info.cb = sizeof(Info);
+	InfoValid = ::GetPerformanceInfo(&Info, sizeof(Info));
+	StatsValid = ObjectManager::GetStats(Stats);
+	return InfoValid || StatsValid;
+}
+
+struct SnapshotBus::Group {
+	SnapshotKind Kind;
+	uint32_t Interval;
+	uint32_t ProviderId{ 0 };
+	int Subscribers{ 0 };
+	int Active{ 0 };
+	WinSys::SnapshotSlot<void> Slot;
+	// used by the sampling thread only, so process snapshot buffers can be reused
+	std::shared_ptr<WinSys::ProcessSnapshot> Current, Spare;
+	// the snapshot the group published last (sampling thread only); compared, never dereferenced
+	const void* LastPublished{ nullptr };
+	// the previous sample, for the change detection (sampling thread only)
+	bool HasLast{ false };
+	WinSys::ProcessSnapshotSummary LastSummary;
+	int64_t LastTimestamp;
+	double LastBusy{ 0 };
+	PERFORMANCE_INFORMATION LastInfo;
+};
+
+namespace {
+	// relative change in percent
+	double Change(uint64_t before, uint64_t after) {
+		if (before == 0)
+			return after ? 100 : 0;
+		auto diff = before > after ? before - after : after - before;
+		return diff * 100.0 / before;
+	}
+
+	uint32_t ProcessCountChange(uint32_t before, uint32_t after) {
+		return before > after ? before - after : after - before;
+	}
+}
+
+SnapshotBus& SnapshotBus::Get() {
+	static SnapshotBus bus;
+	return bus;
+}
+
+SnapshotBus::SnapshotBus() {
+	_groups.reserve(4);
+}
+
+SnapshotBus::~SnapshotBus() {
+	for (auto& g : _groups)
+		_scheduler.RemoveProvider(g->ProviderId);
+}
+
+uint32_t SnapshotBus::Subscribe(SnapshotKind kind, uint32_t interval, bool paused) {
+	auto lock = _lock.lock_exclusive();
+	auto group = Join(kind, interval, paused);
+	if (group == nullptr)
+		return 0;
+
+	auto id = _nextId++;
+	_subscribers.insert({ id, Subscriber{ group, 0, paused } });
+	return id;
+}
+
+void SnapshotBus::Unsubscribe(uint32_t id) {
+	auto lock = _lock.lock_exclusive();
+	auto it = _subscribers.find(id);
+	if (it == _subscribers.end())
+		return;
+
+	Leave(it->second.Source, it->second.Paused);
+	_subscribers.erase(it);
+}
+
+void SnapshotBus::Pause(uint32_t id, bool pause) {
+	auto lock = _lock.lock_exclusive();
+	auto it = _subscribers.find(id);
+	if (it == _subscribers.end() || it->second.Paused == pause)
+		return;
+
+	auto& sub = it->second;
+	sub.Paused = pause;
+	auto group = sub.Source;
+	if (pause) {
+		if (--group->Active == 0)
+			_scheduler.Pause(group->ProviderId, true);
+	}
+	else {
+		if (group->Active++ == 0)
+			_scheduler.Pause(group->ProviderId, false);
+	}
+}
+
+void SnapshotBus::SetInterval(uint32_t id, uint32_t interval) {
+	auto lock = _lock.lock_exclusive();
+	auto it = _subscribers.find(id);
+	if (it == _subscribers.end() || it->second.Source->Interval == interval)
+		return;
+
+	auto& sub = it->second;
+	auto group = Join(sub.Source->Kind, interval, sub.Paused);
+	if (group == nullptr)
+		return;
+
+	Leave(sub.Source, sub.Paused);
+	sub.Source = group;
+	sub.Version = 0;
+}
+
+std::shared_ptr<const void> SnapshotBus::GetNewSnapshot(uint32_t id) {
+	auto lock = _lock.lock_exclusive();
+	auto it = _subscribers.find(id);
+	if (it == _subscribers.end())
+		return nullptr;
+
+	auto snapshot = it->second.Source->Slot.AcquireIfNewer(it->second.Version);
+	if (snapshot)
+		_deliveries++;
+	return snapshot;
+}
+
+std::shared_ptr<const WinSys::ProcessSnapshot> SnapshotBus::GetProcessSnapshot(uint32_t maxAge) {
+	auto snapshot = GetRecent(SnapshotKind::Processes, maxAge);
+	if (snapshot == nullptr) {
+		auto lock = _captureLock.lock_exclusive();
+		// another caller may have captured one while we waited
+		snapshot = GetRecent(SnapshotKind::Processes, maxAge);
+		if (snapshot == nullptr) {
+			auto ps = std::make_shared<WinSys::ProcessSnapshot>();
+			if (!ps->Capture())
+				return nullptr;
+
+			_captures++;
+			SetRecent(SnapshotKind::Processes, ps);
+			snapshot = std::move(ps);
+		}
+	}
+	_deliveries++;
+	return std::static_pointer_cast<const WinSys::ProcessSnapshot>(snapshot);
+}
+
+bool SnapshotBus::UpdateProcesses(WinSys::ProcessManager& pm, bool includeThreads, uint32_t pid, uint32_t maxAge) {
+	auto snapshot = GetProcessSnapshot(maxAge);
+	if (snapshot == nullptr)
+		return false;
+
+	pm.Update(*snapshot, includeThreads, pid);
+	return true;
+}
+
+void SnapshotBus::Suspend(bool suspend) {
+	_scheduler.Suspend(suspend);
+}
+
+bool SnapshotBus::IsSuspended() const {
+	return _scheduler.IsSuspended();
+}
+
+SnapshotBusStats SnapshotBus::GetStats() const {
+	auto lock = _lock.lock_shared();
+	auto cpuTime = _retiredCpuTime;
+	WinSys::SamplerStats stats;
+	for (auto& g : _groups)
+		if (_scheduler.GetStats(g->ProviderId, stats))
+			cpuTime += stats.CpuTime;
+	return SnapshotBusStats{ _captures, _deliveries, cpuTime };
+}
+
+std::vector<SnapshotProviderStats> SnapshotBus::GetProviderStats() const {
+	std::vector<SnapshotProviderStats> providers;
+	auto lock = _lock.lock_shared();
+	providers.reserve(_groups.size());
+	for (auto& g : _groups) {
+		SnapshotProviderStats stats{ g->Kind, g->Subscribers };
+		if (_scheduler.GetStats(g->ProviderId, stats.Sampler))
+			providers.push_back(stats);
+	}
+	return providers;
+}
+
+SnapshotBus::Group* SnapshotBus::Join(SnapshotKind kind, uint32_t interval, bool paused) {
+	// lock held
+	Group* group = nullptr;
+	for (auto& g : _groups) {
+		if (g->Kind == kind && g->Interval == interval) {
+			group = g.get();
+			break;
+		}
+	}
+
+	if (group == nullptr) {
+		auto g = std::make_unique<Group>();
+		g->Kind = kind;
+		g->Interval = interval;
+		g->ProviderId = _scheduler.AddAdaptiveProvider([this, p = g.get()]() { return Sample(p); }, interval, interval * MaxBackoff, true);
+		if (g->ProviderId == 0)
+			return nullptr;
+
+		group = g.get();
+		_groups.push_back(std::move(g));
+	}
+
+	group->Subscribers++;
+	if (!paused && group->Active++ == 0)
+		_scheduler.Pause(group->ProviderId, false);
+	return group;
+}
+
+void SnapshotBus::Leave(Group* group, bool paused) {
+	// lock held
+	if (!paused && --group->Active == 0)
+		_scheduler.Pause(group->ProviderId, true);
+
+	if (--group->Subscribers > 0)
+		return;
+
+	WinSys::SamplerStats stats;
+	if (_scheduler.GetStats(group->ProviderId, stats))
+		_retiredCpuTime += stats.CpuTime;
+	// waits for a running sample, which never takes _lock
+	_scheduler.RemoveProvider(group->ProviderId);
+	auto it = std::find_if(_groups.begin(), _groups.end(), [=](auto& g) { return g.get() == group; });
+	ATLASSERT(it != _groups.end());
+	_groups.erase(it);
+}
+
+WinSys::SampleActivity SnapshotBus::Sample(Group* group) {
+	// sampling thread
+
+	// a group of the same kind with a different interval may have just sampled.
+	// the recent snapshot may also be the one this group published itself, which is no new sample
+	auto recent = GetRecent(group->Kind, group->Interval / 2);
+	if (recent && recent.get() != group->LastPublished) {
+		group->LastPublished = recent.get();
+		group->Slot.Publish(std::move(recent));
+		return WinSys::SampleActivity::Changed;
+	}
+
+	auto activity = WinSys::SampleActivity::Changed;
+
+	std::shared_ptr<const void> snapshot;
+	switch (group->Kind) {
+		case SnapshotKind::Processes:
+		{
+			// reuse the buffer of the snapshot before the current one if no one holds it anymore
+			std::shared_ptr<WinSys::ProcessSnapshot> ps;
+			if (group->Spare && group->Spare.use_count() == 1)
+				ps = std::move(group->Spare);
+			else
+				ps = std::make_shared<WinSys::ProcessSnapshot>();
+
+			if (!ps->Capture()) {
+				group->Spare = std::move(ps);
+				return WinSys::SampleActivity::Changed;
+			}
+			activity = Compare(group, *ps);
+			group->Spare = std::move(group->Current);
+			group->Current = ps;
+			snapshot = std::move(ps);
+			break;
+		}
+
+		case SnapshotKind::Performance:
+		{
+			auto perf = std::make_shared<PerformanceSnapshot>();
+			if (!perf->Capture())
+				return WinSys::SampleActivity::Changed;
+			activity = Compare(group, *perf);
+			snapshot = std::move(perf);
+			break;
+		}
+	}
+
+	_captures++;
+	SetRecent(group->Kind, snapshot);
+	group->LastPublished = snapshot.get();
+	group->Slot.Publish(std::move(snapshot));
+	return activity;
+}
+
+WinSys::SampleActivity SnapshotBus::Compare(Group* group, const WinSys::ProcessSnapshot& snapshot) {
+	static const auto processors = ::GetActiveProcessorCount(ALL_PROCESSOR_GROUPS);
+
+	auto& summary = snapshot.GetSummary();
+	auto& last = group->LastSummary;
+	auto hadLast = group->HasLast;
+	auto interval = snapshot.GetTimestamp() - group->LastTimestamp;
+	// percent of all processors busy since the last sample
+	auto busy = hadLast && interval > 0 ? (summary.BusyTime - last.BusyTime) * 100.0 / interval / processors : 0;
+	auto lastBusy = group->LastBusy;
+
+	group->HasLast = true;
+	group->LastSummary = summary;
+	group->LastTimestamp = snapshot.GetTimestamp();
+	group->LastBusy = busy;
+
+	if (!hadLast)
+		return WinSys::SampleActivity::Changed;
+	if (busy - lastBusy > 25 || ProcessCountChange(last.Processes, summary.Processes) >= 5)
+		return WinSys::SampleActivity::Spike;
+	if (last.Processes == summary.Processes && last.Threads == summary.Threads &&
+		Change(last.Handles, summary.Handles) < 1 && busy - lastBusy < 2 && lastBusy - busy < 2)
+		return WinSys::SampleActivity::Unchanged;
+	return WinSys::SampleActivity::Changed;
+}
+
+WinSys::SampleActivity SnapshotBus::Compare(Group* group, const PerformanceSnapshot& snapshot) {
+	if (!snapshot.InfoValid)
+		return WinSys::SampleActivity::Changed;
+
+	auto& info = snapshot.Info;
+	auto last = group->LastInfo;
+	auto hadLast = group->HasLast;
+	group->HasLast = true;
+	group->LastInfo = info;
+
+	if (!hadLast)
+		return WinSys::SampleActivity::Changed;
+	if (Change(last.CommitTotal, info.CommitTotal) > 10 || ProcessCountChange(last.ProcessCount, info.ProcessCount) >= 5)
+		return WinSys::SampleActivity::Spike;
+	if (last.ProcessCount == info.ProcessCount && last.ThreadCount == info.ThreadCount &&
+		Change(last.HandleCount, info.HandleCount) < 1 && Change(last.CommitTotal, info.CommitTotal) < 1 &&
+		Change(last.PhysicalAvailable, info.PhysicalAvailable) < 1)
+		return WinSys::SampleActivity::Unchanged;
+	return WinSys::SampleActivity::Changed;
+}
+
+std::shared_ptr<const void> SnapshotBus::GetRecent(SnapshotKind kind, uint32_t maxAge) const {
+	auto lock = _recentLock.lock_shared();
+	auto& recent = _recent[(int)kind];
+	if (recent.Snapshot == nullptr || ::GetTickCount64() - recent.Tick > maxAge)
+		return nullptr;
+	return recent.Snapshot;
+}
+
+void SnapshotBus::SetRecent(SnapshotKind kind, std::shared_ptr<const void> snapshot) {
+	auto tick = ::GetTickCount64();
+	auto lock = _recentLock.lock_exclusive();
+	auto& recent = _recent[(int)kind];
+	recent.Snapshot = std::move(snapshot);
+	recent.Tick = tick;
+}
+
+SnapshotSubscription::~SnapshotSubscription() {
+	Unsubscribe();
+}
+
+bool SnapshotSubscription::Subscribe(SnapshotKind kind, uint32_t interval, bool paused) {
+	Unsubscribe();
+	_kind = kind;
+	_id = SnapshotBus::Get().Subscribe(kind, interval, paused);
+	return _id != 0;
+}
+
+void SnapshotSubscription::Unsubscribe() {
+	if (_id) {
+		SnapshotBus::Get().Unsubscribe(_id);
+		_id = 0;
+	}
+}
+
+void SnapshotSubscription::Pause(bool pause) {
+	if (_id)
+		SnapshotBus::Get().Pause(_id, pause);
+}
+
+void SnapshotSubscription::SetInterval(uint32_t interval) {
+	if (_id)
+		SnapshotBus::Get().SetInterval(_id, interval);
+}
+
+std::shared_ptr<const WinSys::ProcessSnapshot> SnapshotSubscription::GetNewProcessSnapshot() {
+	ATLASSERT(_kind == SnapshotKind::Processes);
+	if (_id == 0)
+		return nullptr;
+	return std::static_pointer_cast<const WinSys::ProcessSnapshot>(SnapshotBus::Get().GetNewSnapshot(_id));
+}
+
+std::shared_ptr<const PerformanceSnapshot> SnapshotSubscription::GetNewPerformanceSnapshot() {
+	ATLASSERT(_kind == SnapshotKind::Performance);
+	if (_id == 0)
+		return nullptr;
+	return std::static_pointer_cast<const PerformanceSnapshot>(SnapshotBus::Get().GetNewSnapshot(_id));
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <SamplingScheduler.h>
+#include <SnapshotSlot.h>
+#include <ProcessSnapshot.h>
+#include "ObjectManager.h"
+
+namespace WinSys {
+	class ProcessManager;
+}
+
+//
+// shares periodic snapshots between all views and frames.
+// subscribers with the same kind and interval share one sampling provider (one enumeration per tick);
+// on demand consumers reuse the latest snapshot of a kind if it's recent enough.
+// providers back off while consecutive snapshots show no change, sample faster for a while after a spike
+// and stop altogether while suspended (no frame visible)
+//
+
+enum class SnapshotKind {
+	Processes,
+	Performance,
+	COUNT
+};
+
+struct PerformanceSnapshot {
+	PERFORMANCE_INFORMATION Info;
+	ObjectAndHandleStats Stats;
+	bool InfoValid, StatsValid;
+
+	bool Capture();
+};
+
+struct SnapshotBusStats {
+	// actual enumerations performed
+	uint64_t Captures;
+	// snapshots handed to consumers, each of which would have enumerated on its own
+	uint64_t Deliveries;
+	// CPU time spent sampling, in 100 nsec units
+	uint64_t CpuTime;
+
+	uint64_t GetAvoided() const {
+		return Deliveries > Captures ? Deliveries - Captures : 0;
+	}
+};
+
+struct SnapshotProviderStats {
+	SnapshotKind Kind;
+	int Subscribers;
+	WinSys::SamplerStats Sampler;
+};
+
+class SnapshotBus final {
+public:
+	static SnapshotBus& Get();
+
+	// the longest an idle provider backs off to, relative to its interval
+	static const uint32_t MaxBackoff = 8;
+	// how often views should poll for new snapshots, so they see the faster samples after a spike
+	static const uint32_t PollInterval = 250;
+
+	// returns a subscription id, 0 on failure
+	uint32_t Subscribe(SnapshotKind kind, uint32_t interval, bool paused = false);
+	void Unsubscribe(uint32_t id);
+	void Pause(uint32_t id, bool pause);
+	void SetInterval(uint32_t id, uint32_t interval);
+
+	// returns the latest snapshot if newer than the last one returned to this subscriber, nullptr otherwise
+	std::shared_ptr<const void> GetNewSnapshot(uint32_t id);
+
+	// returns a process snapshot taken at most maxAge msec ago, capturing one if needed
+	std::shared_ptr<const WinSys::ProcessSnapshot> GetProcessSnapshot(uint32_t maxAge = 1000);
+	// feeds such a snapshot to the process manager instead of having it enumerate on its own
+	bool UpdateProcesses(WinSys::ProcessManager& pm, bool includeThreads = false, uint32_t pid = 0, uint32_t maxAge = 1000);
+
+	void Suspend(bool suspend);
+	[[nodiscard]] bool IsSuspended() const;
+
+	SnapshotBusStats GetStats() const;
+	std::vector<SnapshotProviderStats> GetProviderStats() const;
+
+private:
+	SnapshotBus();
+	~SnapshotBus();
+	SnapshotBus(const SnapshotBus&) = delete;
+	SnapshotBus& operator=(const SnapshotBus&) = delete;
+
+	struct Group;
+	struct Subscriber {
+		Group* Source;
+		uint32_t Version{ 0 };
+		bool Paused;
+	};
+
+	Group* Join(SnapshotKind kind, uint32_t interval, bool paused);
+	void Leave(Group* group, bool paused);
+	WinSys::SampleActivity Sample(Group* group);
+	static WinSys::SampleActivity Compare(Group* group, const WinSys::ProcessSnapshot& snapshot);
+	static WinSys::SampleActivity Compare(Group* group, const PerformanceSnapshot& snapshot);
+	std::shared_ptr<const void> GetRecent(SnapshotKind kind, uint32_t maxAge) const;
+	void SetRecent(SnapshotKind kind, std::shared_ptr<const void> snapshot);
+
+private:
+	WinSys::SamplingScheduler _scheduler;
+	mutable wil::srwlock _lock;
+	std::vector<std::unique_ptr<Group>> _groups;
+	std::unordered_map<uint32_t, Subscriber> _subscribers;
+	uint32_t _nextId{ 1 };
+
+	struct Recent {
+		std::shared_ptr<const void> Snapshot;
+		ULONGLONG Tick{ 0 };
+	};
+	mutable wil::srwlock _recentLock;
+	Recent _recent[(int)SnapshotKind::COUNT];
+	// serializes on demand captures so concurrent callers share one
+	wil::srwlock _captureLock;
+
+	std::atomic<uint64_t> _captures{ 0 }, _deliveries{ 0 };
+	// sampling CPU time of removed providers
+	uint64_t _retiredCpuTime{ 0 };
+};
+
+//
+// a single subscription, released on destruction
+//
+
+class SnapshotSubscription {
+public:
+	SnapshotSubscription() = default;
+	~SnapshotSubscription();
+	SnapshotSubscription(const SnapshotSubscription&) = delete;
+	SnapshotSubscription& operator=(const SnapshotSubscription&) = delete;
+
+	bool Subscribe(SnapshotKind kind, uint32_t interval, bool paused = false);
+	void Unsubscribe();
+	void Pause(bool pause);
+	void SetInterval(uint32_t interval);
+
+	std::shared_ptr<const WinSys::ProcessSnapshot> GetNewProcessSnapshot();
+	std::shared_ptr<const PerformanceSnapshot> GetNewPerformanceSnapshot();
+
+private:
+	uint32_t _id{ 0 };
+	SnapshotKind _kind;
+};
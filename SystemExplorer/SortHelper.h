@@ -1,5 +1,7 @@
 #pragma once
 
+#include <type_traits>
+
 struct SortHelper final abstract {
 	static bool SortStrings(const ATL::CString& s1, const ATL::CString& s2, bool ascending);
 	static bool SortStrings(const std::string& s1, const std::string& s2, bool ascending);
@@ -11,4 +13,66 @@ struct SortHelper final abstract {
 	static bool SortNumbers(const Number& n1, const Number& n2, bool ascending) {
 		return ascending ? n2 > n1 : n2 < n1;
 	}
+
+	//
+	// packs a number into an unsigned key whose natural order is the requested sort order,
+	// so sorting needs a single integer compare
+	//
+	template<typename Number>
+	static uint64_t PackKey(Number n, bool ascending) {
+		if constexpr (std::is_enum_v<Number>) {
+			return PackKey(static_cast<std::underlying_type_t<Number>>(n), ascending);
+		}
+		else {
+			uint64_t key;
+			if constexpr (std::is_signed_v<Number>)
+				key = static_cast<uint64_t>(static_cast<int64_t>(n)) ^ (1ULL << 63);
+			else
+				key = static_cast<uint64_t>(n);
+			return ascending ? key : ~key;
+		}
+	}
+
+	//
+	// sorts items by packed keys extracted once per item rather than once per comparison.
+	// ties keep their current relative order
+	//
+	template<typename T, typename KeyFn>
+	static void SortByKey(std::vector<T>& items, KeyFn&& getKey) {
+		std::vector<std::pair<uint64_t, uint32_t>> keys;
+		keys.reserve(items.size());
+		for (uint32_t i = 0; i < (uint32_t)items.size(); i++)
+			keys.push_back({ getKey(items[i]), i });
+		std::sort(keys.begin(), keys.end());
+		ApplyOrder(items, keys);
+	}
+
+	//
+	// same as above for keys that are not numbers (e.g. strings)
+	//
+	template<typename T, typename KeyFn, typename Compare>
+	static void SortByKey(std::vector<T>& items, KeyFn&& getKey, Compare&& compare) {
+		using Key = std::decay_t<decltype(getKey(items[0]))>;
+		std::vector<std::pair<Key, uint32_t>> keys;
+		keys.reserve(items.size());
+		for (uint32_t i = 0; i < (uint32_t)items.size(); i++)
+			keys.push_back({ getKey(items[i]), i });
+		std::sort(keys.begin(), keys.end(), [&](const auto& k1, const auto& k2) {
+			if (compare(k1.first, k2.first))
+				return true;
+			if (compare(k2.first, k1.first))
+				return false;
+			return k1.second < k2.second;
+			});
+		ApplyOrder(items, keys);
+	}
+
+	template<typename T, typename Key>
+	static void ApplyOrder(std::vector<T>& items, const std::vector<std::pair<Key, uint32_t>>& keys) {
+		std::vector<T> sorted;
+		sorted.reserve(items.size());
+		for (const auto& key : keys)
+			sorted.push_back(std::move(items[key.second]));
+		items.swap(sorted);
+	}
 };
@@ -133,6 +133,7 @@ bool CSysInfoView::IsSortable(int row) const {
 }
 
 void CSysInfoView::Refresh() {
+	PROFILE_SCOPE("CSysInfoView", "Refresh");
 	m_OldSysPerfInfo = m_SysPerfInfo;
 	m_OldPerfInfo = m_PerfInfo;
 	::GetPerformanceInfo(&m_PerfInfo, sizeof(m_PerfInfo));
@@ -3,9 +3,30 @@
 #include "resource.h"
 #include "MainFrm.h"
 #include "DriverHelper.h"
+#include <Profiler.h>
+#include <new.h>
+#include <new>
 
 CAppModule _Module;
 
+//
+// counts allocations for the self profiler (per thread, a single increment)
+//
+
+void* operator new(size_t size) {
+	WinSys::Profiler::CountAllocation();
+	for (;;) {
+		if (auto p = ::malloc(size ? size : 1))
+			return p;
+		if (::_callnewh(size) == 0)
+			throw std::bad_alloc();
+	}
+}
+
+void operator delete(void* p) noexcept {
+	::free(p);
+}
+
 int Run(LPTSTR /*lpstrCmdLine*/ = nullptr, int nCmdShow = SW_SHOWDEFAULT) {
 	CMessageLoop theLoop;
 	_Module.AddMessageLoop(&theLoop);
@@ -41,6 +41,8 @@ void CSystemModulesView::DoSort(const SortInfo* si) {
 }
 
 void CSystemModulesView::DoRefresh() {
+	PROFILE_SCOPE("CSystemModulesView", "Refresh");
+	m_ModulesEx.clear();
 	auto count = m_Tracker.EnumModules();
 	m_Modules = m_Tracker.GetModules();
 	DoSort(GetSortInfo(m_List));
@@ -49,6 +51,57 @@ void CSystemModulesView::DoRefresh() {
 	m_List.RedrawItems(top, top + m_List.GetCountPerPage());
 }
 
+void CSystemModulesView::OnUpdate() {
+	m_Tracker.EnumModules();
+	auto& newModules = m_Tracker.GetNewModules();
+	auto& unloadedModules = m_Tracker.GetUnloadedModules();
+	auto tick = ::GetTickCount64();
+
+	// unloaded modules stay for a while, marked
+	bool changed = false;
+	for (auto it = m_ModulesEx.begin(); it != m_ModulesEx.end(); ) {
+		auto& mx = it->second;
+		if (tick < mx.TargetTime) {
+			++it;
+			continue;
+		}
+		if (mx.IsUnloaded) {
+			auto module = it->first;
+			m_Modules.erase(std::find_if(m_Modules.begin(), m_Modules.end(), [=](auto& m) { return m.get() == module; }));
+		}
+		it = m_ModulesEx.erase(it);
+		changed = true;
+	}
+
+	for (auto& m : newModules) {
+		m_Modules.push_back(m);
+		m_ModulesEx[m.get()] = ModuleInfoEx{ tick + 2000, true, false };
+	}
+	for (auto& m : unloadedModules)
+		m_ModulesEx[m.get()] = ModuleInfoEx{ tick + 2000, false, true };
+
+	if (!changed && newModules.empty() && unloadedModules.empty())
+		return;
+
+	DoSort(GetSortInfo(m_List));
+	m_List.SetItemCountEx(static_cast<int>(m_Modules.size()), LVSICF_NOINVALIDATEALL | LVSICF_NOSCROLL);
+	auto top = m_List.GetTopIndex();
+	m_List.RedrawItems(top, top + m_List.GetCountPerPage());
+}
+
+DWORD CSystemModulesView::OnPrePaint(int, LPNMCUSTOMDRAW) {
+	return CDRF_NOTIFYITEMDRAW;
+}
+
+DWORD CSystemModulesView::OnItemPrePaint(int, LPNMCUSTOMDRAW cd) {
+	auto lcd = (LPNMLVCUSTOMDRAW)cd;
+	lcd->clrTextBk = CLR_INVALID;
+	if (auto it = m_ModulesEx.find(m_Modules[cd->dwItemSpec].get()); it != m_ModulesEx.end())
+		lcd->clrTextBk = it->second.IsUnloaded ? RGB(255, 0, 0) : RGB(0, 255, 0);
+
+	return CDRF_DODEFAULT;
+}
+
 LRESULT CSystemModulesView::OnCreate(UINT, WPARAM, LPARAM, BOOL&) {
 	m_hWndClient = m_List.Create(m_hWnd, rcDefault, nullptr, ListViewDefaultStyle & ~LVS_SHAREIMAGELISTS);
 	m_List.SetExtendedListViewStyle(LVS_EX_FULLROWSELECT | LVS_EX_DOUBLEBUFFER | LVS_EX_LABELTIP | LVS_EX_HEADERDRAGDROP);
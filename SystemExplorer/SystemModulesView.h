@@ -18,11 +18,12 @@ public:
 	CString GetColumnText(HWND, int row, int col) const;
 	int GetRowImage(HWND, int row) const;
 	void DoSort(const SortInfo* si);
-	bool IsUpdating() const {
-		return false;
-	}
+
+	DWORD OnPrePaint(int /*idCtrl*/, LPNMCUSTOMDRAW /*lpNMCustomDraw*/);
+	DWORD OnItemPrePaint(int /*idCtrl*/, LPNMCUSTOMDRAW /*lpNMCustomDraw*/);
 
 	void DoRefresh();
+	void OnUpdate();
 
 	BEGIN_MSG_MAP(CSystemModulesView)
 		MESSAGE_HANDLER(WM_CREATE, OnCreate)
@@ -34,8 +35,15 @@ public:
 private:
 	LRESULT OnCreate(UINT /*uMsg*/, WPARAM /*wParam*/, LPARAM /*lParam*/, BOOL& /*bHandled*/);
 
+	struct ModuleInfoEx {
+		DWORD64 TargetTime = 0;
+		bool IsNew{ false };
+		bool IsUnloaded{ false };
+	};
+
 	CListViewCtrl m_List;
 	std::vector<std::shared_ptr<WinSys::KernelModuleInfo>> m_Modules;
+	std::unordered_map<WinSys::KernelModuleInfo*, ModuleInfoEx> m_ModulesEx;
 	WinSys::KernelModuleTracker m_Tracker;
 };
 
@@ -14,11 +14,41 @@ CString CThreadsView::GetColumnText(HWND, int row, int col) {
 	if (tx.IsTerminated) {
 		m_ThreadsEx.erase(t.get());
 		m_Threads.erase(m_Threads.begin() + row);
+		if (row < (int)m_SortKeys.size())
+			m_SortKeys.erase(m_SortKeys.begin() + row);
+		if (row < (int)m_SortedCount)
+			m_SortedCount--;
 		m_List.SetItemCountEx((int)m_Threads.size(), LVSICF_NOINVALIDATEALL | LVSICF_NOSCROLL);
 		m_List.RedrawItems(row, row);
 		return L"";
 	}
 
+	return FormatColumnText(row, col);
+}
+
+bool CThreadsView::GetFindKey(HWND, int row, int col, std::wstring_view& key, FindKeyBuffer& buffer) {
+	// never falls back to GetColumnText: terminated threads are only removed while drawing, not in the middle of a find
+	const auto& t = m_Threads[row];
+	switch (static_cast<ThreadColumn>(col)) {
+		case ThreadColumn::State: key = ThreadStateToString(t->ThreadState); return true;
+		case ThreadColumn::ProcessName: key = t->GetProcessImageName(); return true;
+		case ThreadColumn::WaitReason: key = t->ThreadState == WinSys::ThreadState::Waiting ? WaitReasonToString(t->WaitReason) : L""; return true;
+		case ThreadColumn::Id: ::StringCchPrintf(buffer, _countof(buffer), L"%d (0x%05X)", t->Id, t->Id); break;
+		case ThreadColumn::ProcessId: ::StringCchPrintf(buffer, _countof(buffer), L"%d (0x%05X)", t->ProcessId, t->ProcessId); break;
+		case ThreadColumn::Priority: ::StringCchPrintf(buffer, _countof(buffer), L"%d ", t->Priority); break;
+		case ThreadColumn::BasePriority: ::StringCchPrintf(buffer, _countof(buffer), L"%d ", t->BasePriority); break;
+		default:
+			// rarely the first column
+			::StringCchCopy(buffer, _countof(buffer), FormatColumnText(row, col));
+			break;
+	}
+	key = buffer;
+	return true;
+}
+
+CString CThreadsView::FormatColumnText(int row, int col) const {
+	const auto& t = m_Threads[row];
+	const auto& tx = GetThreadInfoEx(t.get());
 	CString text;
 
 	switch (static_cast<ThreadColumn>(col)) {
@@ -86,42 +116,115 @@ int CThreadsView::GetRowImage(HWND, int row) const {
 }
 
 void CThreadsView::DoSort(const SortInfo* si) {
+	// explicit sort request - don't trust the previous order
+	m_SortedColumn = -1;
+	UpdateSort(si);
+}
+
+bool CThreadsView::GetSortKey(WinSys::ThreadInfo* t, ThreadColumn col, bool asc, uint64_t& key) const {
+	switch (col) {
+		case ThreadColumn::State: key = SortHelper::PackKey(t->ThreadState, asc); break;
+		case ThreadColumn::Id: key = SortHelper::PackKey(t->Id, asc); break;
+		case ThreadColumn::ProcessId: key = SortHelper::PackKey(t->ProcessId, asc); break;
+		case ThreadColumn::CPU: key = SortHelper::PackKey(t->CPU, asc); break;
+		case ThreadColumn::CreateTime: key = SortHelper::PackKey(t->CreateTime, asc); break;
+		case ThreadColumn::Priority: key = SortHelper::PackKey(t->Priority, asc); break;
+		case ThreadColumn::BasePriority: key = SortHelper::PackKey(t->BasePriority, asc); break;
+		case ThreadColumn::CPUTime: key = SortHelper::PackKey(t->KernelTime + t->UserTime, asc); break;
+		case ThreadColumn::UserTime: key = SortHelper::PackKey(t->UserTime, asc); break;
+		case ThreadColumn::KernelTime: key = SortHelper::PackKey(t->KernelTime, asc); break;
+		case ThreadColumn::Teb: key = SortHelper::PackKey((ULONG_PTR)t->TebBase, asc); break;
+		case ThreadColumn::WaitReason: key = SortHelper::PackKey(t->WaitReason, asc); break;
+		case ThreadColumn::StartAddress: key = SortHelper::PackKey((ULONG_PTR)t->StartAddress, asc); break;
+		case ThreadColumn::Win32StartAddress: key = SortHelper::PackKey((ULONG_PTR)t->Win32StartAddress, asc); break;
+		case ThreadColumn::StackBase: key = SortHelper::PackKey((ULONG_PTR)t->StackBase, asc); break;
+		case ThreadColumn::StackLimit: key = SortHelper::PackKey((ULONG_PTR)t->StackLimit, asc); break;
+		case ThreadColumn::ContextSwitches: key = SortHelper::PackKey(t->ContextSwitches, asc); break;
+		case ThreadColumn::WaitTime: key = SortHelper::PackKey(t->WaitTime, asc); break;
+		case ThreadColumn::MemoryPriority: key = SortHelper::PackKey(GetThreadInfoEx(t).GetMemoryPriority(), asc); break;
+		case ThreadColumn::IoPriority: key = SortHelper::PackKey(GetThreadInfoEx(t).GetIoPriority(), asc); break;
+		case ThreadColumn::ComFlags: key = SortHelper::PackKey(GetThreadInfoEx(t).GetComFlags(), asc); break;
+		default:
+			return false;
+	}
+	return true;
+}
+
+void CThreadsView::UpdateSort(const SortInfo* si) {
 	if (si == nullptr)
 		return;
 
-	auto col = si->SortColumn;
+	auto col = static_cast<ThreadColumn>(si->SortColumn);
 	auto asc = si->SortAscending;
+	uint64_t key;
+
+	if (m_Threads.empty() || !GetSortKey(m_Threads[0].get(), col, asc, key)) {
+		// string columns
+		m_SortKeys.clear();
+		m_SortedCount = 0;
+		m_SortedColumn = -1;
+		if (col == ThreadColumn::ProcessName)
+			SortHelper::SortByKey(m_Threads, [](const auto& t) { return t->GetProcessImageName().c_str(); },
+				[&](auto s1, auto s2) { return SortHelper::SortStrings(s1, s2, asc); });
+		else if (col == ThreadColumn::ComApartment)
+			SortHelper::SortByKey(m_Threads, [&](const auto& t) { return FormatHelper::ComApartmentToString(GetThreadInfoEx(t.get()).GetComFlags()); },
+				[&](auto s1, auto s2) { return SortHelper::SortStrings(s1, s2, asc); });
+		ResetFind(m_List);
+		return;
+	}
 
-	std::sort(m_Threads.begin(), m_Threads.end(), [&](const auto& t1, const auto& t2) {
-		switch (static_cast<ThreadColumn>(col)) {
-			case ThreadColumn::State: return SortHelper::SortNumbers(t1->ThreadState, t2->ThreadState, asc);
-			case ThreadColumn::Id: return SortHelper::SortNumbers(t1->Id, t2->Id, asc);
-			case ThreadColumn::ProcessId: return SortHelper::SortNumbers(t1->ProcessId, t2->ProcessId, asc);
-			case ThreadColumn::ProcessName: return SortHelper::SortStrings(t1->GetProcessImageName(), t2->GetProcessImageName(), asc);
-			case ThreadColumn::CPU: return SortHelper::SortNumbers(t1->CPU, t2->CPU, asc);
-			case ThreadColumn::CreateTime: return SortHelper::SortNumbers(t1->CreateTime, t2->CreateTime, asc);
-			case ThreadColumn::Priority: return SortHelper::SortNumbers(t1->Priority, t2->Priority, asc);
-			case ThreadColumn::BasePriority: return SortHelper::SortNumbers(t1->BasePriority, t2->BasePriority, asc);
-			case ThreadColumn::CPUTime: return SortHelper::SortNumbers(t1->KernelTime + t1->UserTime, t2->KernelTime + t2->UserTime, asc);
-			case ThreadColumn::UserTime: return SortHelper::SortNumbers(t1->UserTime, t2->UserTime, asc);
-			case ThreadColumn::KernelTime: return SortHelper::SortNumbers(t1->KernelTime, t2->KernelTime, asc);
-			case ThreadColumn::Teb: return SortHelper::SortNumbers(t1->TebBase, t2->TebBase, asc);
-			case ThreadColumn::WaitReason: return SortHelper::SortNumbers(t1->WaitReason, t2->WaitReason, asc);
-			case ThreadColumn::StartAddress: return SortHelper::SortNumbers(t1->StartAddress, t2->StartAddress, asc);
-			case ThreadColumn::Win32StartAddress: return SortHelper::SortNumbers(t1->Win32StartAddress, t2->Win32StartAddress, asc);
-			case ThreadColumn::StackBase: return SortHelper::SortNumbers(t1->StackBase, t2->StackBase, asc);
-			case ThreadColumn::StackLimit: return SortHelper::SortNumbers(t1->StackLimit, t2->StackLimit, asc);
-			case ThreadColumn::ContextSwitches: return SortHelper::SortNumbers(t1->ContextSwitches, t2->ContextSwitches, asc);
-			case ThreadColumn::WaitTime: return SortHelper::SortNumbers(t1->WaitTime, t2->WaitTime, asc);
-			case ThreadColumn::MemoryPriority: return SortHelper::SortNumbers(GetThreadInfoEx(t1.get()).GetMemoryPriority(), GetThreadInfoEx(t2.get()).GetMemoryPriority(), asc);
-			case ThreadColumn::IoPriority: return SortHelper::SortNumbers(GetThreadInfoEx(t1.get()).GetIoPriority(), GetThreadInfoEx(t2.get()).GetIoPriority(), asc);
-			case ThreadColumn::ComFlags: return SortHelper::SortNumbers(GetThreadInfoEx(t1.get()).GetComFlags(), GetThreadInfoEx(t2.get()).GetComFlags(), asc);
-			case ThreadColumn::ComApartment: return SortHelper::SortStrings(
-				FormatHelper::ComApartmentToString(GetThreadInfoEx(t1.get()).GetComFlags()),
-				FormatHelper::ComApartmentToString(GetThreadInfoEx(t2.get()).GetComFlags()), asc);
+	if (si->SortColumn != m_SortedColumn || asc != m_SortedAscending)
+		m_SortedCount = 0;
+
+	//
+	// keys are computed once per tick. rows whose key did not change since the last sort
+	// are still in order, so only new and changed rows need sorting, followed by a merge
+	//
+	auto count = m_Threads.size();
+	m_SortKeys.resize(count);
+	std::vector<std::pair<uint64_t, std::shared_ptr<WinSys::ThreadInfo>>> changed;
+	size_t kept = 0;
+	for (size_t i = 0; i < count; i++) {
+		GetSortKey(m_Threads[i].get(), col, asc, key);
+		if (i < m_SortedCount && key == m_SortKeys[i]) {
+			if (kept != i)
+				m_Threads[kept] = std::move(m_Threads[i]);
+			m_SortKeys[kept++] = key;
 		}
-		return false;
-		});
+		else {
+			changed.push_back({ key, std::move(m_Threads[i]) });
+		}
+	}
+
+	m_SortedCount = count;
+	m_SortedColumn = si->SortColumn;
+	m_SortedAscending = asc;
+
+	// no row moved
+	if (changed.empty())
+		return;
+
+	std::sort(changed.begin(), changed.end(), [](const auto& c1, const auto& c2) { return c1.first < c2.first; });
+
+	std::vector<std::shared_ptr<WinSys::ThreadInfo>> threads;
+	std::vector<uint64_t> keys;
+	threads.reserve(count);
+	keys.reserve(count);
+	size_t i = 0, j = 0;
+	while (i < kept || j < changed.size()) {
+		if (j == changed.size() || (i < kept && m_SortKeys[i] <= changed[j].first)) {
+			threads.push_back(std::move(m_Threads[i]));
+			keys.push_back(m_SortKeys[i++]);
+		}
+		else {
+			threads.push_back(std::move(changed[j].second));
+			keys.push_back(changed[j++].first);
+		}
+	}
+	m_Threads.swap(threads);
+	m_SortKeys.swap(keys);
+	// a find in progress would resume at a row that now holds another thread
+	ResetFind(m_List);
 }
 
 DWORD CThreadsView::OnPrePaint(int, LPNMCUSTOMDRAW cd) {
@@ -168,13 +271,21 @@ DWORD CThreadsView::OnSubItemPrePaint(int, LPNMCUSTOMDRAW cd) {
 	return CDRF_NEWFONT;
 }
 
-void CThreadsView::Refresh() {
+void CThreadsView::Refresh(const WinSys::ProcessSnapshot* snapshot) {
+	PROFILE_SCOPE("CThreadsView", "Refresh");
 	auto first = m_Threads.empty();
-	m_ProcMgr.EnumProcessesAndThreads(m_Pid);
+	m_ProcMgr.SetCpuAccounting(Settings::Get().Processes.CycleBasedCpu ? WinSys::CpuAccounting::Cycles : WinSys::CpuAccounting::Time);
+	if (snapshot == nullptr)
+		m_ProcMgr.EnumProcessesAndThreads(m_Pid);
+	else if (!m_ProcMgr.Update(*snapshot, true, m_Pid))
+		return;
+
 	auto count = (int)m_ProcMgr.GetThreadCount();
 
 	if (first) {
 		m_Threads = m_ProcMgr.GetThreads();
+		m_SortKeys.clear();
+		m_SortedCount = 0;
 		m_List.SetItemCount(count);
 		m_TermThreads.reserve(32);
 		m_NewThreads.reserve(32);
@@ -226,7 +337,7 @@ void CThreadsView::Refresh() {
 	}
 
 
-	DoSort(GetSortInfo(m_List));
+	UpdateSort(GetSortInfo(m_List));
 	count = (int)m_Threads.size();
 	m_List.SetItemCountEx(count, LVSICF_NOSCROLL | LVSICF_NOINVALIDATEALL);
 	auto top = m_List.GetTopIndex();
@@ -285,18 +396,31 @@ LRESULT CThreadsView::OnCreate(UINT, WPARAM, LPARAM, BOOL&) {
 
 	Refresh();
 	Pause(false);
+	m_Snapshots.Subscribe(SnapshotKind::Processes, GetUpdateInterval());
 
 	return 0;
 }
 
 void CThreadsView::OnUpdate() {
-	Refresh();
+	auto snapshot = m_Snapshots.GetNewProcessSnapshot();
+	if (snapshot)
+		Refresh(snapshot.get());
 }
 
 void CThreadsView::OnActivate(bool activate) {
+	m_Snapshots.Pause(!activate || IsPaused());
 	UpdateUI();
 }
 
+void CThreadsView::OnUpdateIntervalChanged(int interval) {
+	m_Snapshots.SetInterval(interval);
+}
+
+int CThreadsView::GetTimerInterval() const {
+	// the snapshot provider samples faster after a spike
+	return SnapshotBus::PollInterval;
+}
+
 LRESULT CThreadsView::OnRefresh(WORD, WORD, HWND, BOOL&) {
 	Refresh();
 
@@ -369,6 +493,7 @@ LRESULT CThreadsView::OnListRightClick(int, LPNMHDR hdr, BOOL&) {
 }
 
 void CThreadsView::OnPauseResume(bool paused) {
+	m_Snapshots.Pause(paused);
 	UpdateUI();
 }
 
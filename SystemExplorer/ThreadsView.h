@@ -6,6 +6,7 @@
 #include "ViewBase.h"
 #include "ThreadInfoEx.h"
 #include "ProcessManager.h"
+#include "SnapshotBus.h"
 
 class CThreadsView :
 	public CVirtualListView<CThreadsView>,
@@ -15,12 +16,15 @@ public:
 	CThreadsView(IMainFrame* frame, DWORD pid = 0);
 
 	CString GetColumnText(HWND, int row, int col);
+	bool GetFindKey(HWND, int row, int col, std::wstring_view& key, FindKeyBuffer& buffer);
 	int GetRowImage(HWND, int row) const;
 	void DoSort(const SortInfo* si);
 
 	void OnActivate(bool);
 	void OnUpdate();
 	void OnPauseResume(bool paused);
+	void OnUpdateIntervalChanged(int interval);
+	int GetTimerInterval() const;
 
 	DWORD OnPrePaint(int /*idCtrl*/, LPNMCUSTOMDRAW /*lpNMCustomDraw*/);
 	DWORD OnItemPrePaint(int /*idCtrl*/, LPNMCUSTOMDRAW /*lpNMCustomDraw*/);
@@ -47,7 +51,7 @@ private:
 	LRESULT OnListRightClick(int, LPNMHDR hdr, BOOL&);
 
 private:
-	void Refresh();
+	void Refresh(const WinSys::ProcessSnapshot* snapshot = nullptr);
 	void UpdateUI();
 	static PCWSTR ThreadStateToString(WinSys::ThreadState state);
 	static PCWSTR WaitReasonToString(WinSys::WaitReason reason);
@@ -59,15 +63,25 @@ private:
 		WaitTime, COUNT
 	};
 
+	bool GetSortKey(WinSys::ThreadInfo* t, ThreadColumn col, bool asc, uint64_t& key) const;
+	void UpdateSort(const SortInfo* si);
+
 	ThreadInfoEx& GetThreadInfoEx(WinSys::ThreadInfo* ti) const;
+	CString FormatColumnText(int row, int col) const;
 
 private:
 	CListViewCtrl m_List;
 	WinSys::ProcessManager m_ProcMgr;
+	SnapshotSubscription m_Snapshots;
 	std::vector<std::shared_ptr<WinSys::ThreadInfo>> m_Threads;
 	std::vector<std::shared_ptr<WinSys::ThreadInfo>> m_NewThreads;
 	std::vector<std::shared_ptr<WinSys::ThreadInfo>> m_TermThreads;
 	mutable std::unordered_map<WinSys::ThreadInfo*, ThreadInfoEx> m_ThreadsEx;
+	// packed sort keys parallel to m_Threads; the first m_SortedCount rows are in key order
+	std::vector<uint64_t> m_SortKeys;
+	size_t m_SortedCount{ 0 };
+	int m_SortedColumn{ -1 };
+	bool m_SortedAscending{ true };
 	HFONT m_hFont;
 	DWORD m_Pid;
 	int m_SelectedHeader;
@@ -2,6 +2,8 @@
 
 #include "Interfaces.h"
 #include "resource.h"
+#include "SnapshotBus.h"
+#include <Profiler.h>
 
 template<typename T>
 struct PauseResumeUpdates {
@@ -70,7 +72,7 @@ protected:
 				ui->UISetCheck(ID_VIEW_PAUSE, m_Paused);
 				ui->UIEnable(ID_VIEW_PAUSE, TRUE);
 
-				pT->SetTimer(1, GetUpdateInterval(), nullptr);
+				pT->SetTimer(1, pT->GetTimerInterval(), nullptr);
 			}
 			else {
 				pT->KillTimer(1);
@@ -95,6 +97,12 @@ protected:
 			bHandled = FALSE;
 			return 0;
 		}
+		// nothing is visible while sampling is suspended
+		if (SnapshotBus::Get().IsSuspended())
+			return 0;
+
+		static const auto site = WinSys::Profiler::Get().Register(WinSys::GetProfileTypeName<T>(), "Update");
+		WinSys::ProfileScope scope(site);
 		static_cast<T*>(this)->OnUpdate();
 		return 0;
 	}
@@ -111,7 +119,7 @@ protected:
 		if (m_Paused)
 			pT->KillTimer(1);
 		else
-			pT->SetTimer(1, GetUpdateInterval(), nullptr);
+			pT->SetTimer(1, pT->GetTimerInterval(), nullptr);
 	}
 
 	LRESULT OnUpdateInterval(WORD, WORD id, HWND, BOOL&) {
@@ -122,7 +130,7 @@ protected:
 		m_UpdateInterval = intervals[index];
 		auto pT = static_cast<T*>(this);
 		if (!m_Paused) {
-			pT->SetTimer(1, m_UpdateInterval, nullptr);
+			pT->SetTimer(1, pT->GetTimerInterval(), nullptr);
 		}
 		pT->OnUpdateIntervalChanged(m_UpdateInterval);
 		Frame()->GetUpdateUI()->UISetRadioMenuItem(m_CurrentUpdateId = id, ID_UPDATEINTERVAL_1SECOND, ID_UPDATEINTERVAL_10SECONDS);
@@ -132,6 +140,10 @@ protected:
 	void OnPauseResume(bool paused) {}
 	void OnUpdateIntervalChanged(int interval) {}
 	void OnUpdate() {}
+	// views fed by the snapshot bus may poll faster than the update interval
+	int GetTimerInterval() const {
+		return GetUpdateInterval();
+	}
 	void OnActivate(bool) {}
 	void DoRefresh() {}
 
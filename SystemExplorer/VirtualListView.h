@@ -2,6 +2,8 @@
 
 #include "ColumnManager.h"
 #include "ListViewHelper.h"
+#include <Profiler.h>
+#include <TextMatcher.h>
 
 enum class ListViewRowCheck {
 	None,
@@ -157,8 +159,11 @@ protected:
 		auto& item = lv->item;
 		auto col = GetRealColumn(hdr->hwndFrom, item.iSubItem);
 		auto p = static_cast<T*>(this);
-		if (item.mask & LVIF_TEXT)
+		if (item.mask & LVIF_TEXT) {
+			static const auto site = WinSys::Profiler::Get().Register(WinSys::GetProfileTypeName<T>(), "GetColumnText");
+			WinSys::ProfileScope scope(site);
 			::StringCchCopy(item.pszText, item.cchTextMax, p->GetColumnText(hdr->hwndFrom, item.iItem, col));
+		}
 		if (item.mask & LVIF_IMAGE) {
 			item.iImage = p->GetRowImage(hdr->hwndFrom, item.iItem);
 		}
@@ -189,30 +194,66 @@ protected:
 
 	LRESULT OnFindItem(int /*idCtrl*/, LPNMHDR hdr, BOOL& /*bHandled*/) {
 		auto fi = (NMLVFINDITEM*)hdr;
-		auto text = fi->lvfi.psz;
-		auto len = ::wcslen(text);
-		auto list = fi->hdr.hwndFrom;
-
-		int selected = fi->iStart;
-		int start = selected + 1;
-		int count = ListView_GetItemCount(list);
-		WCHAR name[128]{};
-		if (len >= _countof(name))
-			len = _countof(name) - 1;
-		int end = (fi->lvfi.flags & LVFI_WRAP) ? (count + start) : count;
-		bool partial = fi->lvfi.flags & (LVFI_PARTIAL | LVFI_SUBSTRING);
-		for (int i = start; i < end; i++) {
-			ListView_GetItemText(list, i % count, 0, name, _countof(name));
-			if (partial) {
-				if (::_wcsnicmp(name, text, len) == 0)
-					return i % count;
+		if ((fi->lvfi.flags & (LVFI_STRING | LVFI_PARTIAL | LVFI_SUBSTRING)) == 0 || fi->lvfi.psz == nullptr)
+			return -1;
+
+		return FindRow(fi->hdr.hwndFrom, fi->lvfi.psz, fi->iStart,
+			(fi->lvfi.flags & (LVFI_PARTIAL | LVFI_SUBSTRING)) != 0, (fi->lvfi.flags & LVFI_WRAP) != 0);
+	}
+
+	//
+	// searches the first column's text (case insensitive) from the row after start, without going through the list view.
+	// keys are matched in place, straight from the view's data where the view provides them (GetFindKey), so nothing is
+	// taken or formatted up front and the scan stops at the first match. typing more of the same text resumes at the
+	// previous match, unless the rows were sorted, added or removed since
+	//
+	int FindRow(HWND hWnd, PCWSTR text, int start, bool partial, bool wrap) {
+		static const auto site = WinSys::Profiler::Get().Register(WinSys::GetProfileTypeName<T>(), "FindRow");
+		WinSys::ProfileScope scope(site);
+
+		auto count = ListView_GetItemCount(hWnd);
+		if (count == 0)
+			return -1;
+
+		auto& state = GetFindState(hWnd);
+		WinSys::TextMatcher matcher(text);
+		auto& pattern = matcher.GetPattern();
+		auto now = ::GetTickCount64();
+		if (partial && state.LastMatch >= 0 && state.Count == count && now - state.LastFind <= TypeAheadTimeout
+			&& pattern.size() > state.LastText.size() && pattern.compare(0, state.LastText.size(), state.LastText) == 0)
+			start = state.LastMatch - 1;
+
+		auto p = static_cast<T*>(this);
+		auto column = GetRealColumn(hWnd, 0);
+		FindKeyBuffer buffer;
+		CString columnText;
+		int found = -1;
+		int first = start + 1;
+		int end = wrap ? count + first : count;
+		for (int i = first; i < end; i++) {
+			auto row = i % count;
+			std::wstring_view key;
+			if (!p->GetFindKey(hWnd, row, column, key, buffer)) {
+				columnText = p->GetColumnText(hWnd, row, column);
+				key = std::wstring_view(columnText, columnText.GetLength());
 			}
-			else {
-				if (::_wcsicmp(name, text) == 0)
-					return i % count;
+			if (partial ? matcher.StartsWith(key) : matcher.Equals(key)) {
+				found = row;
+				break;
 			}
 		}
-		return -1;
+		state.LastText = pattern;
+		state.LastMatch = found;
+		state.Count = count;
+		state.LastFind = now;
+		return found;
+	}
+
+	// the next find doesn't resume at the previous match (called after sorting)
+	void ResetFind(HWND hWnd = nullptr) {
+		for (auto& state : m_FindStates)
+			if (hWnd == nullptr || state.hWnd == hWnd)
+				state.LastMatch = -1;
 	}
 
 	void Sort(SortInfo const* si, bool ensureVisible = false) {
@@ -234,7 +275,12 @@ protected:
 				selectedText.push_back(text);
 			}
 		}
-		static_cast<T*>(this)->DoSort(si);
+		{
+			static const auto site = WinSys::Profiler::Get().Register(WinSys::GetProfileTypeName<T>(), "DoSort");
+			WinSys::ProfileScope scope(site);
+			static_cast<T*>(this)->DoSort(si);
+		}
+		ResetFind(si->hWnd);
 		if (selected >= 0) {
 			selected = -1;
 			int start = -1, i, n;
@@ -354,6 +400,15 @@ protected:
 		return L"";
 	}
 
+	// for find keys a view formats (e.g. numbers) or copies
+	using FindKeyBuffer = WCHAR[MAX_PATH];
+
+	// the text find matches for a row's column, straight from the view's data: a string the data holds, a static
+	// string or text formatted into buffer. false to match the column text instead
+	bool GetFindKey(HWND hWnd, int row, int column, std::wstring_view& key, FindKeyBuffer& buffer) {
+		return false;
+	}
+
 	int GetRowImage(HWND hWnd, int row) const {
 		return -1;
 	}
@@ -385,6 +440,29 @@ private:
 		return nullptr;
 	}
 
+	struct FindState {
+		HWND hWnd;
+		std::wstring LastText;
+		int LastMatch{ -1 };
+		// row count when LastMatch was found
+		int Count{ 0 };
+		ULONGLONG LastFind{ 0 };
+	};
+
+	// a type-ahead sequence ends after this long without typing
+	static const ULONGLONG TypeAheadTimeout = 1000;
+
+	FindState& GetFindState(HWND hWnd) {
+		auto it = std::find_if(m_FindStates.begin(), m_FindStates.end(), [=](auto& state) {
+			return state.hWnd == hWnd;
+			});
+		if (it != m_FindStates.end())
+			return *it;
+		m_FindStates.push_back(FindState{ hWnd });
+		return m_FindStates.back();
+	}
+
 	mutable std::vector<SortInfo> m_Controls;
+	std::vector<FindState> m_FindStates;
 	mutable std::vector<std::unique_ptr<ColumnManager>> m_Columns;
 };
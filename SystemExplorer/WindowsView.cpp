@@ -2,6 +2,7 @@
 #include "WindowsView.h"
 #include "WindowHelper.h"
 #include "resource.h"
+#include "SnapshotBus.h"
 
 static PCWSTR properties[] = {
 	L"Handle", L"Owner Thread", L"Owner Process", L"Style", L"Extended Style", L"Class Name", L"Rectangle"
@@ -178,7 +179,7 @@ void CWindowsView::InitTree() {
 		images.Remove(images.GetImageCount() - 1);
 
 	m_Tree.DeleteAllItems();
-	m_ProcMgr.EnumProcesses();
+	SnapshotBus::Get().UpdateProcesses(m_ProcMgr);
 
 	if (m_DefaultDesktopOnly) {
 		auto root = m_Tree.InsertItem(L"Default", 0, 0, TVI_ROOT, TVI_LAST);
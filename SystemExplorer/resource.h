@@ -308,13 +308,18 @@
 #define ID_SYSTEM_SCHEDULEDTASKS        32902
 #define ID_SYSTEM_WMINAMESPACE          32903
 #define ID_SYSTEM_WMI                   32904
+#define ID_OPTIONS_CYCLEBASEDCPU        32905
+#define ID_VIEW_PROFILER                32906
+#define ID_PROFILER_RECORDTRACE         32907
+#define ID_PROFILER_EXPORTTRACE         32908
+#define ID_PROFILER_RESET               32909
 
 // Next default values for new objects
 // 
 #ifdef APSTUDIO_INVOKED
 #ifndef APSTUDIO_READONLY_SYMBOLS
 #define _APS_NEXT_RESOURCE_VALUE        332
-#define _APS_NEXT_COMMAND_VALUE         32905
+#define _APS_NEXT_COMMAND_VALUE         32910
 #define _APS_NEXT_CONTROL_VALUE         1069
 #define _APS_NEXT_SYMED_VALUE           101
 #endif